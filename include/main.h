@@ -1,4 +1,17 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wake the UI loop early (it otherwise sleeps until the next LVGL timer is due).
+// Use after posting anything loop() must handle: motor events, input, etc.
+void ui_loop_wake(void);
+void ui_loop_wake_from_isr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
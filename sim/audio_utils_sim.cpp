@@ -0,0 +1,59 @@
+// audio_utils.h on the native environment: no DAC output, just the engine's timeline.
+// Each step is handed to the world when it would start sounding (the dog hears cue
+// tones, the scenarios count jam alarms); audio_stop() drops what has not started.
+
+#include "audio_utils.h"
+#include "sim.h"
+#include <Arduino.h>
+
+#define DEFAULT_FREQ_HZ 400
+#define DEFAULT_AMP     200
+
+static uint64_t g_busy_until_us = 0;
+
+static void enqueue(const audio_step_t& s) {
+    const uint64_t now = sim_now_us();
+    const uint64_t start = g_busy_until_us > now ? g_busy_until_us : now;
+    const uint32_t repeat = s.repeat ? s.repeat : 1;
+    const uint64_t len_ms = (uint64_t)repeat * s.on_ms + (uint64_t)(repeat - 1) * s.off_ms;
+    sim_world_tone(start, s.freq_hz, (uint8_t)repeat);
+    g_busy_until_us = start + len_ms * 1000ULL;
+}
+
+void audio_init(void) {
+}
+
+void audio_play_tone(uint16_t frequency_hz, uint8_t amplitude, uint32_t duration_ms) {
+    audio_stop();
+    if (duration_ms == 0 || frequency_hz == 0 || amplitude == 0) return;
+    if (duration_ms > 0xFFFFUL) duration_ms = 0xFFFFUL;
+    const audio_step_t step = { frequency_hz, amplitude, 1, (uint16_t)duration_ms, 0 };
+    enqueue(step);
+}
+
+void audio_play_tone_1s(void) {
+    audio_play_tone(DEFAULT_FREQ_HZ, DEFAULT_AMP, 1000);
+}
+
+bool audio_play_pattern(const audio_step_t* steps, size_t count) {
+    if (!steps) return true;
+    for (size_t i = 0; i < count; i++) enqueue(steps[i]);
+    return true;
+}
+
+// No SD card: every WAV falls back to its tone step
+bool audio_play_wav(const char* path, const audio_step_t* fallback) {
+    if (!path) return false;
+    if (fallback) enqueue(*fallback);
+    return true;
+}
+
+bool audio_is_playing(void) {
+    return sim_now_us() < g_busy_until_us;
+}
+
+void audio_stop(void) {
+    const uint64_t now = sim_now_us();
+    sim_world_cancel_tones(now);
+    g_busy_until_us = now;
+}
@@ -0,0 +1,168 @@
+// current_sense.h on the native environment.
+//
+// Same ring, resume and window semantics as current_sense.cpp, but the "DMA" is the
+// world pushing one conversion per sample period: samples collect in a staging buffer
+// and reach the ring a whole CURRENT_SENSE_DMA_BUF_LEN at a time, as i2s_read() hands
+// them to the reader task. The first-buffer wait in current_sense_window() therefore
+// blocks the caller for a few virtual ms after a resume, exactly like the firmware.
+
+#include "current_sense.h"
+#include "sim.h"
+#include <Arduino.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef CURRENT_SENSOR_PIN
+#define CURRENT_SENSOR_PIN 35
+#endif
+
+#ifndef CURRENT_SENSE_SAMPLE_RATE_HZ
+#define CURRENT_SENSE_SAMPLE_RATE_HZ 8000U
+#endif
+
+#ifndef CURRENT_SENSE_DMA_BUF_LEN
+#define CURRENT_SENSE_DMA_BUF_LEN 64
+#endif
+
+#ifndef CURRENT_SENSE_RING_SIZE
+#define CURRENT_SENSE_RING_SIZE 1024
+#endif
+
+#ifndef CURRENT_SENSE_FIRST_BUF_WAIT_TICKS
+#define CURRENT_SENSE_FIRST_BUF_WAIT_TICKS 20
+#endif
+
+static_assert((CURRENT_SENSE_RING_SIZE & (CURRENT_SENSE_RING_SIZE - 1)) == 0,
+              "CURRENT_SENSE_RING_SIZE must be a power of two");
+
+static const uint32_t MAX_WINDOW = CURRENT_SENSE_RING_SIZE - CURRENT_SENSE_DMA_BUF_LEN;
+
+static uint16_t g_ring[CURRENT_SENSE_RING_SIZE];
+static uint32_t g_write_idx = 0;
+static uint32_t g_valid_from = 0;
+static uint16_t g_dma[CURRENT_SENSE_DMA_BUF_LEN];
+static uint16_t g_dma_fill = 0;
+static bool g_streaming = false;
+static bool g_active = false;
+
+// -----------------------------
+// World side
+// -----------------------------
+bool current_sense_sim_wants_samples(void) {
+    return g_streaming && g_active;
+}
+
+void current_sense_sim_push(uint16_t counts) {
+    if (!current_sense_sim_wants_samples()) return;
+    g_dma[g_dma_fill++] = counts & 0x0FFF;
+    if (g_dma_fill < CURRENT_SENSE_DMA_BUF_LEN) return;
+    for (uint16_t i = 0; i < CURRENT_SENSE_DMA_BUF_LEN; i++) {
+        g_ring[g_write_idx & (CURRENT_SENSE_RING_SIZE - 1)] = g_dma[i];
+        g_write_idx++;
+    }
+    g_dma_fill = 0;
+}
+
+uint32_t current_sense_sim_rate_hz(void) {
+    return CURRENT_SENSE_SAMPLE_RATE_HZ;
+}
+
+// -----------------------------
+// current_sense.h
+// -----------------------------
+bool current_sense_begin(void) {
+    if (g_streaming) return true;
+    g_streaming = true;
+    g_active = true;
+    Serial.printf("Current sense: DMA ADC on GPIO%d @ %u Hz, ring=%d samples\r\n",
+                  (int)CURRENT_SENSOR_PIN,
+                  (unsigned)CURRENT_SENSE_SAMPLE_RATE_HZ,
+                  (int)CURRENT_SENSE_RING_SIZE);
+    return true;
+}
+
+bool current_sense_is_streaming(void) {
+    return g_streaming;
+}
+
+void current_sense_set_active(bool active) {
+    if (!g_streaming || active == g_active) return;
+    if (active) {
+        g_valid_from = g_write_idx;
+    } else {
+        g_dma_fill = 0;   // i2s_stop() discards the half-filled DMA buffer
+    }
+    g_active = active;
+}
+
+bool current_sense_window(uint16_t samples, uint16_t zero_counts, current_window_t* out) {
+    if (!out) return false;
+    if (samples == 0) samples = 1;
+
+    const uint32_t end = g_write_idx;
+    uint32_t fresh = end - g_valid_from;
+    if (fresh == 0 && !g_active) fresh = end;
+
+    uint32_t n = samples;
+    if (n > MAX_WINDOW) n = MAX_WINDOW;
+    if (n > fresh) n = fresh;
+    if (n == 0) {
+        *out = current_window_t{};
+        return false;
+    }
+
+    uint32_t sum = 0;
+    uint64_t sum_sq = 0;
+    uint16_t lo = 0xFFFF;
+    uint16_t hi = 0;
+    for (uint32_t i = end - n; i != end; i++) {
+        const uint16_t s = g_ring[i & (CURRENT_SENSE_RING_SIZE - 1)];
+        const int32_t d = (int32_t)s - (int32_t)zero_counts;
+        sum += s;
+        sum_sq += (uint64_t)(d * d);
+        if (s < lo) lo = s;
+        if (s > hi) hi = s;
+    }
+
+    out->mean  = (uint16_t)(sum / n);
+    out->min   = lo;
+    out->peak  = hi;
+    out->rms   = (uint16_t)sqrtf((float)sum_sq / (float)n);
+    out->count = (uint16_t)n;
+    return true;
+}
+
+int current_sense_read_adc(uint16_t samples) {
+    current_window_t w;
+    for (int tries = 0; !current_sense_window(samples, 0, &w); tries++) {
+        if (tries >= CURRENT_SENSE_FIRST_BUF_WAIT_TICKS) break;
+        vTaskDelay(1);
+    }
+    return w.mean;
+}
+
+uint16_t current_sense_read_since(uint32_t* cursor, uint16_t* out, uint16_t max) {
+    if (!g_streaming || !cursor || !out) return 0;
+
+    const uint32_t end = g_write_idx;
+    uint32_t start = *cursor;
+    if ((int32_t)(start - g_valid_from) < 0) start = g_valid_from;
+    if ((uint32_t)(end - start) > MAX_WINDOW) start = end - MAX_WINDOW;
+
+    uint16_t n = 0;
+    while (start != end && n < max) {
+        out[n++] = g_ring[start & (CURRENT_SENSE_RING_SIZE - 1)];
+        start++;
+    }
+    *cursor = start;
+    return n;
+}
+
+uint32_t current_sense_sample_rate_hz(void) {
+    return g_streaming ? CURRENT_SENSE_SAMPLE_RATE_HZ : 0;
+}
+
+uint32_t current_sense_total_samples(void) {
+    return g_write_idx;
+}
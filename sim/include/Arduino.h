@@ -0,0 +1,65 @@
+#pragma once
+// Native-env stand-in for the Arduino core (see sim_hal.h): only what the
+// simulated firmware sources use.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sim_hal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW  0
+#define DEC 10
+#define HEX 16
+
+// 32-bit like the ESP32 core. unsigned long is 64-bit on the host, so differences
+// across a wrap would not match the device; a simulation never runs for 49 days.
+static inline unsigned long millis(void) { return (uint32_t)(sim_now_us() / 1000ULL); }
+static inline unsigned long micros(void) { return (uint32_t)sim_now_us(); }
+static inline uint32_t esp_random(void) { return sim_random32(); }
+static inline void delay(uint32_t ms) { vTaskDelay(ms); }
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+
+    size_t write(const uint8_t* buf, size_t n) {
+        sim_serial_write((const char*)buf, n);
+        return n;
+    }
+
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(char c) { return write((const uint8_t*)&c, 1); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC) {
+        return base == DEC ? printf("%ld", v) : print((unsigned long)v, base);
+    }
+    size_t print(unsigned long v, int base = DEC) {
+        return printf(base == HEX ? "%lX" : "%lu", v);
+    }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+
+    size_t println() { return print("\r\n"); }
+    template <typename T> size_t println(T v) { return print(v) + println(); }
+    template <typename T> size_t println(T v, int arg) { return print(v, arg) + println(); }
+
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        if (n < 0) return 0;
+        if ((size_t)n >= sizeof(buf)) n = sizeof(buf) - 1;
+        return write((const uint8_t*)buf, (size_t)n);
+    }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "sim_hal.h"
+
+// I2C master on the simulated bus (sim_i2c_*). Same transaction shape as the
+// Arduino TwoWire: buffer writes until endTransmission(), read what requestFrom() got.
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t freq = 0) {
+        (void)sda; (void)scl;
+        if (freq) clock_hz_ = freq;
+        return true;
+    }
+    void setClock(uint32_t hz) { clock_hz_ = hz; }
+    uint32_t getClock() const { return clock_hz_; }
+
+    void beginTransmission(uint8_t addr) {
+        addr_ = addr;
+        tx_len_ = 0;
+    }
+    size_t write(uint8_t b) {
+        if (tx_len_ >= sizeof(tx_)) return 0;
+        tx_[tx_len_++] = b;
+        return 1;
+    }
+    // 0 = ACK, 2 = address NACK
+    uint8_t endTransmission(bool stop = true) {
+        (void)stop;
+        return sim_i2c_write(addr_, tx_, tx_len_) ? 0 : 2;
+    }
+
+    uint8_t requestFrom(uint8_t addr, uint8_t n) {
+        if (n > sizeof(rx_)) n = sizeof(rx_);
+        rx_len_ = sim_i2c_read(addr, rx_, n);
+        rx_pos_ = 0;
+        return (uint8_t)rx_len_;
+    }
+    int available() const { return (int)(rx_len_ - rx_pos_); }
+    int read() { return rx_pos_ < rx_len_ ? rx_[rx_pos_++] : -1; }
+
+private:
+    uint32_t clock_hz_ = 100000;
+    uint8_t addr_ = 0;
+    uint8_t tx_[32];
+    size_t tx_len_ = 0;
+    uint8_t rx_[32];
+    size_t rx_len_ = 0;
+    size_t rx_pos_ = 0;
+};
+
+extern TwoWire Wire;
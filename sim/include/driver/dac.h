@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+#include "sim_hal.h"
+
+#ifndef ESP_OK
+typedef int esp_err_t;
+#define ESP_OK 0
+#endif
+
+typedef enum {
+    DAC_CHANNEL_1 = 0,   // GPIO25
+    DAC_CHANNEL_2,       // GPIO26
+    DAC_CHANNEL_MAX
+} dac_channel_t;
+
+static inline esp_err_t dac_output_enable(dac_channel_t ch) { sim_dac_enable((int)ch, true); return ESP_OK; }
+static inline esp_err_t dac_output_disable(dac_channel_t ch) { sim_dac_enable((int)ch, false); return ESP_OK; }
+static inline esp_err_t dac_output_voltage(dac_channel_t ch, uint8_t value) { sim_dac_write((int)ch, value); return ESP_OK; }
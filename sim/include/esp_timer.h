@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+#include "sim_hal.h"
+
+static inline int64_t esp_timer_get_time(void) { return (int64_t)sim_now_us(); }
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// FreeRTOS types for the cooperative scheduler in sim/sim_kernel.cpp.
+// One tick is one millisecond of virtual time, as on the device.
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// No interrupts on the native environment: everything runs in task context
+static inline BaseType_t xPortInIsrContext(void) { return pdFALSE; }
+#define portYIELD_FROM_ISR() ((void)0)
@@ -0,0 +1,20 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Recursive mutexes only. A cooperative task is never switched out while holding
+// one unless it blocks, so a take by another task means a lock held across a
+// blocking call: the simulator reports that and aborts instead of deadlocking.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sim_mutex* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex);
+
+#ifdef __cplusplus
+}
+#endif
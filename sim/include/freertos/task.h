@@ -0,0 +1,41 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Tasks are cooperative coroutines on the virtual clock: one runs at a time, from
+// where it last blocked until it blocks again, and takes no virtual time doing so.
+// Core affinity is accepted and ignored; priority orders tasks that are ready at
+// the same instant.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sim_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes,
+                                   void* param, UBaseType_t priority, TaskHandle_t* out,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);   // NULL = calling task
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* prev_wake, TickType_t period);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);   // NULL outside a task
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdFALSE;
+}
+
+static inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_bytes,
+                                     void* param, UBaseType_t priority, TaskHandle_t* out) {
+    return xTaskCreatePinnedToCore(fn, name, stack_bytes, param, priority, out, tskNO_AFFINITY);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+#ifndef NEWPUP_SIM_LV_CONF_H
+#define NEWPUP_SIM_LV_CONF_H
+
+// The firmware's LVGL configuration, minus what a headless host build can't have:
+// no TFT_eSPI display driver, and the built-in Montserrat 14 as LV_FONT_DEFAULT
+// instead of the subsets tools/font_subset.py generates (no screens are built).
+#include "../../include/lv_conf.h"
+
+#undef LV_USE_TFT_ESPI
+#define LV_USE_TFT_ESPI 0
+
+#undef LV_USE_LOG
+#define LV_USE_LOG 0
+
+#undef LV_FONT_MONTSERRAT_14
+#define LV_FONT_MONTSERRAT_14 1
+
+#undef LV_FONT_CUSTOM_DECLARE
+#define LV_FONT_CUSTOM_DECLARE
+
+#endif // NEWPUP_SIM_LV_CONF_H
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Host HAL for the native (simulator) environment.
+//
+// The firmware touches hardware through a few seams. In [env:native] each of them
+// resolves to the simulator instead of the ESP32 core:
+//   clock   millis(), micros(), esp_timer_get_time(), FreeRTOS ticks, lv_tick
+//           -> one virtual clock that only moves when everything is idle
+//   I2C     Wire -> a simulated PCF8574 wired to the motor, cam, beam, foot switch
+//           and remote models (pcf8574_control.cpp itself is the real driver)
+//   ADC     current_sense.h -> sim/current_sense_sim.cpp, fed by the motor model
+//   DAC     driver/dac.h and audio_utils.h -> sim/audio_utils_sim.cpp
+//   timers  LVGL timers (real LVGL on the virtual tick); FreeRTOS tasks run
+//           cooperatively on the virtual clock (sim/sim_kernel.cpp)
+// The headers next to this one stand in for the Arduino/IDF ones the firmware
+// includes; they carry only what the simulated sources use.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t sim_now_us(void);
+uint32_t sim_random32(void);
+void sim_serial_write(const char* s, size_t n);
+
+// I2C transactions; false / 0 = no device acknowledged addr
+bool sim_i2c_write(uint8_t addr, const uint8_t* data, size_t n);
+size_t sim_i2c_read(uint8_t addr, uint8_t* data, size_t n);
+
+void sim_dac_enable(int channel, bool on);
+void sim_dac_write(int channel, uint8_t value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,566 @@
+// Native simulator: the firmware's control code (actions.cpp, pcf8574_control.cpp, the
+// schedule and the jam detector) against device models on a virtual clock.
+//
+// The clock only moves when every task and the UI loop are blocked, straight to the
+// next deadline, so an hour of schedule takes seconds. Each scenario is run many times
+// with its own seed; every run is checked against what the devices saw, and the host
+// cost of each motor tick and UI loop pass is reported as a benchmark.
+//
+// Each UI loop pass costs --frame-ms of virtual time (an LVGL render and flush), and
+// motor events wait until the pass in progress ends, as they do on the device.
+//
+// Build and run (PlatformIO native env, see platformio.ini):
+//   pio run -e native && .pio/build/native/program all --runs 2000
+//   .pio/build/native/program jam --runs 500 --seed 7 -v     # firmware log on stdout
+//   .pio/build/native/program schedule --treats 12 --hours 2 --frame-ms 30
+// The env itself has not been through PlatformIO yet (the +<../sim/> source filter
+// is unconfirmed); so far the sim has only been built with g++ directly against a
+// minimal LVGL timer/subject stand-in. Check that before wiring it into CI.
+// Exit status is 1 if any run failed a check.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lvgl.h>
+#include "sim.h"
+#include "ui.h"
+#include "main.h"
+#include "actions.h"
+#include "pcf8574_control.h"
+#include "current_sense.h"
+#include "schedule_state.h"
+#include "run_log.h"
+#include "jam_detect.h"
+#include "log.h"
+#include "frame_sched.h"
+
+#ifndef UI_LOOP_MAX_SLEEP_MS
+#define UI_LOOP_MAX_SLEEP_MS 500U
+#endif
+
+#define PCF8574_ADDRESS 0x20
+#define PCF8574_SAFE_PORT ((uint8_t)((1u << 4) | (1u << 5) | (1u << 7)))
+
+// Same values as actions.cpp (MotorStopReason, MOTOR_MAX_UNJAM_RETRIES)
+enum { R_TIMEOUT = 0, R_TREAT_NEXT_HIGH, R_NO_TREAT_3, R_JAM, R_EXTERNAL, R_COUNT };
+static const char* const REASONS[R_COUNT] = {
+    "timeout", "treat_next_high", "no_treat_3_transitions", "jam", "external_request",
+};
+#define SIM_MAX_UNJAM_RETRIES 3
+
+// Schedule scenario defaults (the firmware's own are a UI choice, not a test load)
+#define SIM_SCHEDULE_TREATS 4
+#define SIM_SCHEDULE_HOURS  1
+
+// Settling time after a job: the manual LED minimum on-time plus margin
+#define SIM_SETTLE_US (6500ULL * 1000ULL)
+
+// Modelled virtual cost of one UI loop pass; main.cpp's LVGL slice budget (a full-screen flush)
+#ifndef SIM_UI_FRAME_MS
+#define SIM_UI_FRAME_MS 12U
+#endif
+
+// Firmware decided to stop -> H-bridge off. The motor task coasts the motor on the
+// tick that decides, so anything past one tick means the stop waited on the UI loop.
+#ifndef SIM_MAX_STOP_US
+#define SIM_MAX_STOP_US 5000ULL
+#endif
+
+// What main.cpp defines for the firmware
+float ZERO_CURRENT_VOLTAGE = 2.50f;
+objects_t objects;
+
+static bool g_ui_woken = false;
+extern "C" void ui_loop_wake(void) { g_ui_woken = true; }
+extern "C" void ui_loop_wake_from_isr(void) { g_ui_woken = true; }
+
+static uint32_t lv_tick_from_sim(void) {
+    return (uint32_t)(sim_now_us() / 1000ULL);
+}
+
+// -----------------------------
+// UI loop (loop() in main.cpp) interleaved with the tasks
+// -----------------------------
+static SimCost g_ui_cost;
+static uint64_t g_ui_next_us = 0;
+static uint64_t g_ui_frame_us = SIM_UI_FRAME_MS * 1000ULL;
+static uint64_t g_ui_busy_until_us = 0;  // end of the pass in progress
+
+// main.cpp's events and LVGL slices; the sim has no flow or screens to tick
+static uint32_t slice_events(uint32_t budget_us) {
+    (void)budget_us;
+    actions_poll_events();
+    return FRAME_SCHED_IDLE;
+}
+
+static uint32_t slice_lvgl(uint32_t budget_us) {
+    (void)budget_us;
+    const uint32_t wait_ms = lv_timer_handler();
+    return wait_ms == LV_NO_TIMER_READY ? FRAME_SCHED_IDLE : wait_ms;
+}
+
+static void ui_pass() {
+    const uint64_t t0 = sim_host_ns();
+    uint32_t wait_ms = frame_sched_run();
+    g_ui_cost.add(sim_host_ns() - t0);
+
+    // The pass holds the loop for a frame; tasks keep running meanwhile. LVGL timers
+    // are anchored at their last run, so the wait counts from the start of the pass.
+    if (wait_ms > UI_LOOP_MAX_SLEEP_MS) wait_ms = UI_LOOP_MAX_SLEEP_MS;
+    g_ui_busy_until_us = sim_now_us() + g_ui_frame_us;
+    g_ui_next_us = sim_now_us() + (uint64_t)wait_ms * 1000ULL;
+    if (g_ui_next_us < g_ui_busy_until_us) g_ui_next_us = g_ui_busy_until_us;
+}
+
+// One virtual instant, then advance to the next thing due (never past limit_us)
+static void sim_step(uint64_t limit_us) {
+    for (int n = 0; ; n++) {
+        sim_run_tasks();
+        if (sim_now_us() < g_ui_busy_until_us) break;
+        if (!g_ui_woken && sim_now_us() < g_ui_next_us) break;
+        if (n > 10000) {
+            fprintf(stderr, "sim: UI loop never sleeps (t=%.3f s)\n", (double)sim_now_us() / 1e6);
+            exit(3);
+        }
+        g_ui_woken = false;
+        ui_pass();
+    }
+
+    uint64_t next = g_ui_woken ? g_ui_busy_until_us : g_ui_next_us;
+    const uint64_t task_wake = sim_tasks_next_wake_us();
+    if (task_wake < next) next = task_wake;
+    if (limit_us < next) next = limit_us;
+    if (next > sim_now_us()) sim_world_advance_to(next);
+}
+
+static void run_for(uint64_t us) {
+    const uint64_t end = sim_now_us() + us;
+    while (sim_now_us() < end) sim_step(end);
+}
+
+template <typename Pred>
+static bool run_until(Pred done, uint64_t max_us) {
+    const uint64_t end = sim_now_us() + max_us;
+    while (!done()) {
+        if (sim_now_us() >= end) return false;
+        sim_step(end);
+    }
+    return true;
+}
+
+// Firmware bring-up in main.cpp's order, minus display and SD
+static void sim_setup() {
+    log_init();
+    Wire.begin();
+    Wire.beginTransmission(PCF8574_ADDRESS);
+    Wire.write(PCF8574_SAFE_PORT);
+    Wire.endTransmission();
+
+    init_audio();
+    initPCF8574Pins();
+    beginPCF8574Outputs();
+    setPCF8574Pin(0, false);
+    setPCF8574Pin(1, false);
+    setPCF8574Pin(4, true);
+    setPCF8574Pin(5, true);
+    setPCF8574Pin(7, false);
+    commitPCF8574Outputs();
+
+    lv_init();
+    lv_tick_set_cb(lv_tick_from_sim);
+    frame_sched_add("events", slice_events, 0, 1000, 0);
+    frame_sched_add("lvgl", slice_lvgl, 10, 12000, 0);
+    schedule_state_init();
+    actions_init();
+
+    float sum = 0;
+    for (int i = 0; i < 10; i++) {
+        const int a = current_sense_read_adc(64);
+        sum += (a / 4095.0f) * 3.3f;
+        delay(20);
+    }
+    ZERO_CURRENT_VOLTAGE = sum / 10.0f;
+    Serial.printf("Calibrated ZERO_CURRENT_VOLTAGE = %.4f V\n", ZERO_CURRENT_VOLTAGE);
+    run_log_init(ZERO_CURRENT_VOLTAGE);
+    current_sense_set_active(false);
+}
+
+// -----------------------------
+// Checks and tallies
+// -----------------------------
+struct Tally {
+    const char* name;
+    int runs = 0;
+    int failed = 0;
+    int reasons[R_COUNT] = {};
+    int double_drops = 0;
+    SimCost detect;   // jam reached -> first reverse, virtual ns
+    SimCost stop;     // firmware decided -> H-bridge off, virtual ns
+    int notes = 0;    // tolerated but worth a look (printed with -v)
+};
+
+static bool g_verbose = false;
+
+static void fail(Tally& t, int run, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+static void fail(Tally& t, int run, const char* fmt, ...) {
+    t.failed++;
+    if (t.failed > 20 && !g_verbose) return;
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "FAIL %s #%d (t=%.3f s): ", t.name, run, (double)sim_now_us() / 1e6);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+static bool job_settled(size_t run_index) {
+    const std::vector<SimRun>& runs = sim_world_runs();
+    return runs.size() > run_index && runs[run_index].finished && runs[run_index].stopped_us &&
+           sim_world_motor_idle();
+}
+
+// Checks every run shares; returns false if the run failed one
+static bool check_run(Tally& t, int run, const SimRun& r) {
+    const int reason = r.rec.reason < R_COUNT ? (int)r.rec.reason : (int)R_TIMEOUT;
+    t.reasons[reason]++;
+    if (r.stopped_us >= r.finish_us) t.stop.add((r.stopped_us - r.finish_us) * 1000ULL);
+    if (r.jam_hit && r.first_reverse_us) t.detect.add((r.first_reverse_us - r.jam_hit_us) * 1000ULL);
+
+    if (r.stopped_us > r.finish_us + SIM_MAX_STOP_US) {
+        fail(t, run, "motor ran %.1f ms past the stop decision",
+             (double)(r.stopped_us - r.finish_us) / 1e3);
+        return false;
+    }
+
+    const bool treat_flag = (r.rec.flags & RUN_LOG_FLAG_TREAT) != 0;
+    if (r.dropped > 1) {
+        t.double_drops++;
+        fail(t, run, "%d treats fell in one run", r.dropped);
+        return false;
+    }
+    if (treat_flag != (r.dropped == 1)) {
+        fail(t, run, "firmware treat=%d, treats fell=%d", treat_flag, r.dropped);
+        return false;
+    }
+    if ((reason == R_TREAT_NEXT_HIGH || reason == R_NO_TREAT_3) && !r.parked_high) {
+        fail(t, run, "stopped (%s) with the rotary LOW", REASONS[reason]);
+        return false;
+    }
+    return true;
+}
+
+static bool check_idle(Tally& t, int run) {
+    if (!sim_world_motor_idle() || sim_world_led_on() || sim_world_ir_on()) {
+        fail(t, run, "not idle after settling: motor=%s led=%d ir=%d",
+             sim_world_motor_idle() ? "off" : "on", sim_world_led_on(), sim_world_ir_on());
+        return false;
+    }
+    return true;
+}
+
+static uint64_t run_seed(uint64_t seed, const char* scenario, int run) {
+    uint64_t h = seed ^ 0xCBF29CE484222325ULL;
+    for (const char* p = scenario; *p; p++) h = (h ^ (uint8_t)*p) * 0x100000001B3ULL;
+    return h ^ ((uint64_t)run * 0x9E3779B97F4A7C15ULL);
+}
+
+// -----------------------------
+// Scenarios
+// -----------------------------
+// Manual dispense: one treat, or none if three pockets came up empty; wheel parks HIGH
+static void scenario_dispense(Tally& t, int runs, uint64_t seed) {
+    for (int i = 0; i < runs; i++) {
+        sim_world_reseed(run_seed(seed, t.name, i));
+        const size_t idx = sim_world_runs().size();
+        action_manual_dispense_treat(nullptr);
+        t.runs++;
+        if (!run_until([idx] { return job_settled(idx); }, 30ULL * 1000000ULL)) {
+            fail(t, i, "job did not finish");
+            continue;
+        }
+        run_for(SIM_SETTLE_US);
+        const SimRun& r = sim_world_runs()[idx];
+        bool ok = check_run(t, i, r);
+        if (ok && r.rec.reason != R_TREAT_NEXT_HIGH && r.rec.reason != R_NO_TREAT_3) {
+            fail(t, i, "clean run stopped as %s", REASONS[r.rec.reason % R_COUNT]);
+            ok = false;
+        }
+        if (ok) check_idle(t, i);
+    }
+}
+
+// Jam ahead of the first drop; clears after 1..3 reverses or never
+static void scenario_jam(Tally& t, int runs, uint64_t seed) {
+    uint32_t alarms_before = sim_world_stats().alarms;
+    for (int i = 0; i < runs; i++) {
+        const uint64_t s = run_seed(seed, t.name, i);
+        sim_world_reseed(s);
+        const int needed_choices[] = {1, 2, 3, -1};
+        const int needed = needed_choices[(s >> 8) % 4];
+        const SimJamKind kind = ((s >> 16) % 10) < 7 ? SIM_JAM_STALL : SIM_JAM_SLIP;
+        const double at = 0.2 + 0.7 * (double)((s >> 24) % 1000) / 1000.0;
+        sim_world_set_jam(at, kind, needed);
+
+        const size_t idx = sim_world_runs().size();
+        action_manual_dispense_treat(nullptr);
+        t.runs++;
+        const bool finished = run_until([idx] { return job_settled(idx); }, 60ULL * 1000000ULL);
+        sim_world_clear_jam();
+        if (!finished) {
+            fail(t, i, "job did not finish (jam %s, clears after %d)",
+                 kind == SIM_JAM_STALL ? "stall" : "slip", needed);
+            continue;
+        }
+        run_for(SIM_SETTLE_US);
+
+        const SimRun& r = sim_world_runs()[idx];
+        bool ok = check_run(t, i, r);
+        const uint32_t alarms = sim_world_stats().alarms - alarms_before;
+        alarms_before = sim_world_stats().alarms;
+        const char* kind_name = kind == SIM_JAM_STALL ? "stall" : "slip";
+
+        if (ok && !r.jam_hit) {
+            fail(t, i, "wheel never reached the obstruction (%s)", REASONS[r.rec.reason % R_COUNT]);
+            ok = false;
+        }
+        if (ok && (r.rec.reason == R_JAM) != (alarms > 0)) {
+            fail(t, i, "reason %s but %u alarm(s)", REASONS[r.rec.reason % R_COUNT], alarms);
+            ok = false;
+        }
+        if (ok && needed < 0) {
+            // Never clears: no treat, and the job must give up with STOP_JAM after the last retry
+            if (r.rec.reason == R_TIMEOUT || r.dropped) {
+                fail(t, i, "permanent %s jam ended as %s, retries %u, dropped %d",
+                     kind_name, REASONS[r.rec.reason % R_COUNT], r.rec.retries, r.dropped);
+                ok = false;
+            } else if (r.rec.reason == R_JAM && r.rec.retries != SIM_MAX_UNJAM_RETRIES + 1) {
+                fail(t, i, "STOP_JAM after %u retries", r.rec.retries);
+                ok = false;
+            } else if (r.rec.reason != R_JAM) {
+                // Cam edges replayed after a reverse must not end it as an unalarmed "no treat"
+                fail(t, i, "permanent %s jam ended as %s after %u retries, not STOP_JAM",
+                     kind_name, REASONS[r.rec.reason % R_COUNT], r.rec.retries);
+                ok = false;
+            }
+        } else if (ok) {
+            if (r.rec.reason == R_JAM) {
+                fail(t, i, "%s jam clearing after %d reverse(s) ended as STOP_JAM", kind_name, needed);
+                ok = false;
+            } else if (r.rec.retries > needed) {
+                fail(t, i, "%s jam clearing after %d reverse(s) took %u", kind_name, needed, r.rec.retries);
+                ok = false;
+            } else if (r.rec.reason == R_TIMEOUT) {
+                t.notes++;
+                if (g_verbose) printf("note: jam #%d (%s, %d) timed out after %u retries\n",
+                                      i, kind_name, needed, r.rec.retries);
+            }
+        }
+        if (ok) check_idle(t, i);
+    }
+}
+
+// Full schedule run: the dog answers some cue tones; the counter matches the jobs
+static void scenario_schedule(Tally& t, int runs, uint64_t seed, int treats, int hours) {
+    for (int i = 0; i < runs; i++) {
+        sim_world_reseed(run_seed(seed, t.name, i));
+        schedule_set_selected_treats(treats);
+        schedule_set_selected_hours(hours);
+        const size_t first = sim_world_runs().size();
+        const size_t presses_before = sim_world_foot_press_times().size();
+        const uint64_t start = sim_now_us();
+
+        action_scheduletreatdispensestart(nullptr);
+        t.runs++;
+        const uint64_t span = (uint64_t)hours * 3600ULL * 1000000ULL;
+        if (!run_until([] { return !schedule_running(); }, span + 120ULL * 1000000ULL)) {
+            fail(t, i, "schedule still running %.0f s after its end", 120.0);
+            action_scheduletreatdispensestop(nullptr);
+            run_for(SIM_SETTLE_US);
+            continue;
+        }
+        run_until([] { return sim_world_motor_idle(); }, 30ULL * 1000000ULL);
+        run_for(SIM_SETTLE_US);
+
+        const std::vector<SimRun>& all = sim_world_runs();
+        const std::vector<uint64_t>& presses = sim_world_foot_press_times();
+        int jobs = 0;
+        bool ok = true;
+        for (size_t k = first; k < all.size(); k++) {
+            const SimRun& r = all[k];
+            if (!r.finished) {
+                fail(t, i, "job %zu never finished", k - first);
+                ok = false;
+                continue;
+            }
+            if (r.rec.reason != R_EXTERNAL) jobs++;
+            ok = check_run(t, i, r) && ok;
+            if (k == first) continue;
+            // Every job after treat #1 answers a foot-switch press
+            bool answered = false;
+            for (size_t p = presses_before; p < presses.size(); p++) {
+                if (presses[p] <= r.start_us && r.start_us - presses[p] < 400000ULL) answered = true;
+            }
+            if (!answered) {
+                fail(t, i, "job at %.3f s without a foot-switch press", (double)(r.start_us - start) / 1e6);
+                ok = false;
+            }
+        }
+        if (ok && schedule_treats_dispensed() != jobs) {
+            fail(t, i, "treats_dispensed=%d, jobs=%d", schedule_treats_dispensed(), jobs);
+            ok = false;
+        }
+        if (ok) check_idle(t, i);
+    }
+}
+
+// Remote (P7) opens a 20 s foot-switch window; a job runs iff the dog pressed in it
+static void scenario_remote(Tally& t, int runs, uint64_t seed) {
+    const uint64_t window_us = 20000ULL * 1000ULL;
+    const uint64_t slack_us = 200ULL * 1000ULL;   // debounce + poll period either side
+    for (int i = 0; i < runs; i++) {
+        sim_world_reseed(run_seed(seed, t.name, i));
+        const size_t first = sim_world_runs().size();
+        const size_t presses_before = sim_world_foot_press_times().size();
+        const uint64_t at = sim_now_us() + 100000ULL;
+        sim_world_press_remote(at, 200);
+        t.runs++;
+
+        run_for(window_us + 2 * slack_us + 100000ULL);
+        run_until([] { return sim_world_motor_idle(); }, 30ULL * 1000000ULL);
+        run_for(SIM_SETTLE_US);
+
+        bool sure_press = false, maybe_press = false;
+        const std::vector<uint64_t>& presses = sim_world_foot_press_times();
+        for (size_t p = presses_before; p < presses.size(); p++) {
+            if (presses[p] < at) continue;
+            if (presses[p] >= at + slack_us && presses[p] + slack_us < at + window_us) sure_press = true;
+            if (presses[p] < at + window_us + slack_us) maybe_press = true;
+        }
+        const size_t jobs = sim_world_runs().size() - first;
+        bool ok = true;
+        if (jobs > 1) {
+            fail(t, i, "%zu jobs from one remote press", jobs);
+            ok = false;
+        } else if (sure_press && jobs == 0) {
+            fail(t, i, "dog pressed inside the window but nothing was dispensed");
+            ok = false;
+        } else if (!maybe_press && jobs == 1) {
+            fail(t, i, "dispensed without a press in the window");
+            ok = false;
+        }
+        if (ok && jobs == 1) ok = check_run(t, i, sim_world_runs()[first]);
+        if (ok) check_idle(t, i);
+    }
+}
+
+// -----------------------------
+// Report
+// -----------------------------
+static void print_tally(const Tally& t) {
+    if (!t.runs) return;
+    printf("%-9s %6d runs, %d failed", t.name, t.runs, t.failed);
+    if (t.double_drops) printf(", %d double drops", t.double_drops);
+    if (t.notes) printf(", %d notes", t.notes);
+    printf("\n         ");
+    for (int r = 0; r < R_COUNT; r++) {
+        if (t.reasons[r]) printf(" %s=%d", REASONS[r], t.reasons[r]);
+    }
+    printf("\n");
+    if (t.detect.count) {
+        printf("          jam -> reverse   mean %6.1f ms  p99 %6.1f ms  max %6.1f ms\n",
+               t.detect.mean_ns() / 1e6, t.detect.percentile(0.99) / 1e6, t.detect.max_ns / 1e6);
+    }
+    if (t.stop.count) {
+        printf("          finish -> off    mean %6.1f ms  p99 %6.1f ms  max %6.1f ms\n",
+               t.stop.mean_ns() / 1e6, t.stop.percentile(0.99) / 1e6, t.stop.max_ns / 1e6);
+    }
+}
+
+static void print_cost(const char* name, const SimCost& c) {
+    if (!c.count) return;
+    printf("  %-14s %10llu wakes  mean %7.2f us  p50 %7.2f us  p99 %7.2f us  max %8.2f us\n",
+           name, (unsigned long long)c.count, c.mean_ns() / 1e3, c.percentile(0.50) / 1e3,
+           c.percentile(0.99) / 1e3, c.max_ns / 1e3);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [dispense|jam|schedule|remote|all] [--runs N] [--seed S]\n"
+            "          [--treats N] [--hours H] [--frame-ms F] [-v]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    const char* which = "all";
+    int runs = 200;
+    uint64_t seed = 1;
+    int treats = SIM_SCHEDULE_TREATS;
+    int hours = SIM_SCHEDULE_HOURS;
+
+    for (int i = 1; i < argc; i++) {
+        const bool has_arg = i + 1 < argc;
+        if (!strcmp(argv[i], "--runs") && has_arg) runs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && has_arg) seed = strtoull(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--treats") && has_arg) treats = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--hours") && has_arg) hours = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--frame-ms") && has_arg) g_ui_frame_us = strtoull(argv[++i], nullptr, 0) * 1000ULL;
+        else if (!strcmp(argv[i], "-v")) g_verbose = true;
+        else if (argv[i][0] != '-') which = argv[i];
+        else usage(argv[0]);
+    }
+    const bool all = !strcmp(which, "all");
+    if (!all && strcmp(which, "dispense") && strcmp(which, "jam") && strcmp(which, "schedule") &&
+        strcmp(which, "remote")) {
+        usage(argv[0]);
+    }
+
+    sim_kernel_init(seed, g_verbose);
+    sim_world_init(SimWorldConfig(), seed);
+    sim_setup();
+
+    const uint64_t host0 = sim_host_ns();
+    const uint64_t virt0 = sim_now_us();
+
+    Tally dispense, jam, schedule, remote;
+    dispense.name = "dispense";
+    jam.name = "jam";
+    schedule.name = "schedule";
+    remote.name = "remote";
+
+    if (all || !strcmp(which, "dispense")) scenario_dispense(dispense, runs, seed);
+    if (all || !strcmp(which, "jam")) scenario_jam(jam, runs, seed);
+    if (all || !strcmp(which, "remote")) scenario_remote(remote, runs, seed);
+    // An hour of schedule is ~100 jobs; a tenth as many runs covers as much motor time
+    if (all || !strcmp(which, "schedule")) {
+        scenario_schedule(schedule, all ? (runs + 9) / 10 : runs, seed, treats, hours);
+    }
+
+    const double host_s = (sim_host_ns() - host0) / 1e9;
+    const double virt_s = (sim_now_us() - virt0) / 1e6;
+    const SimWorldStats& ws = sim_world_stats();
+
+    printf("\n");
+    print_tally(dispense);
+    print_tally(jam);
+    print_tally(remote);
+    print_tally(schedule);
+
+    printf("\nHost cost per wake:\n");
+    SimTaskInfo tasks[8];
+    const size_t n = sim_task_info(tasks, 8);
+    for (size_t i = 0; i < n; i++) print_cost(tasks[i].name, *tasks[i].cost);
+    print_cost("ui loop", g_ui_cost);
+    printf("\nI2C: %llu reads, %llu writes, %llu bytes (%.1f reads/s virtual); interlock violations %u\n",
+           (unsigned long long)ws.i2c_reads, (unsigned long long)ws.i2c_writes,
+           (unsigned long long)ws.i2c_bytes, virt_s > 0 ? ws.i2c_reads / virt_s : 0.0,
+           ws.interlock_violations);
+    printf("Virtual %.1f s in %.2f s host (%.0fx real time)\n", virt_s, host_s,
+           host_s > 0 ? virt_s / host_s : 0.0);
+
+    const int failed = dispense.failed + jam.failed + schedule.failed + remote.failed +
+                       (ws.interlock_violations ? 1 : 0);
+    if (ws.interlock_violations) fprintf(stderr, "FAIL: IN1+IN2 both HIGH on the bus\n");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+// run_log.h on the native environment: records go straight to the world, which
+// scores each run against what the devices actually did.
+
+#include "run_log.h"
+#include "sim.h"
+
+static uint32_t g_seq = 0;
+
+void run_log_init(float zero_current_volts) {
+    (void)zero_current_volts;
+    g_seq = 0;
+}
+
+bool run_log_append(const run_log_record_t* rec) {
+    if (!rec) return false;
+    run_log_record_t r = *rec;
+    r.magic = RUN_LOG_RECORD_MAGIC;
+    r.seq = g_seq++;
+    sim_world_run_logged(&r);
+    return true;
+}
+
+uint32_t run_log_dropped(void) {
+    return 0;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "sim_hal.h"
+#include "run_log.h"
+
+// Simulator internals shared by the kernel, the device models and the scenarios.
+// Firmware sources never include this; they see the sim only through sim_hal.h.
+
+// -----------------------------
+// Host-time cost of one unit of simulated work (a task wake, a UI loop pass)
+// -----------------------------
+struct SimCost {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint32_t hist[384] = {};   // eighth-octave buckets of ns
+
+    void add(uint64_t ns);
+    uint64_t percentile(double p) const;   // bucket upper bound
+    uint64_t mean_ns() const { return count ? total_ns / count : 0; }
+};
+
+uint64_t sim_host_ns(void);
+
+// -----------------------------
+// Kernel (sim_kernel.cpp): virtual clock, Serial sink, cooperative tasks
+// -----------------------------
+void sim_kernel_init(uint64_t seed, bool echo_serial);
+void sim_clock_set(uint64_t now_us);        // world only: moves forward after devices did
+void sim_run_tasks(void);                   // every task that is ready now, until all block
+uint64_t sim_tasks_next_wake_us(void);      // UINT64_MAX if all wait on notifications
+
+struct SimTaskInfo {
+    const char* name;
+    const SimCost* cost;
+};
+size_t sim_task_info(SimTaskInfo* out, size_t max);
+
+// -----------------------------
+// Devices (sim_world.cpp)
+// -----------------------------
+enum SimJamKind {
+    SIM_JAM_STALL = 0,   // wheel blocked: motor stalls, current goes to stall level
+    SIM_JAM_SLIP         // wheel blocked, motor keeps turning (slipping coupling): current normal
+};
+
+struct SimWorldConfig {
+    // Wheel: forward time per pocket at nominal load; per-run speed spread
+    double pocket_s = 0.60;
+    double speed_spread = 0.08;
+    // Pocket phase (0..1) where the rotary switch reads HIGH, and where a treat drops
+    double cam_high = 0.30;
+    double drop_at = 0.60;
+    double p_loaded = 0.95;         // chance each pocket carries a treat
+    uint32_t fall_ms = 60;          // drop to beam
+    uint32_t beam_ms = 20;          // beam blocked while the treat passes
+    // Motor seen by the ACS712: running / stall current, mechanical time constant
+    float i_run = 0.35f;
+    float i_stall = 1.30f;
+    double tau_ms = 30.0;
+    float zero_volts = 2.50f;
+    float noise_counts = 3.0f;      // ADC noise, 1 sigma
+    float spike_p = 0.0005f;        // chance per sample of a +/-300 count spike
+    // Reverse time against an obstruction that counts as one unjam attempt
+    uint32_t unjam_reverse_ms = 150;
+    // Dog on the foot switch: chance to press per cue tone, reaction, hold
+    double p_press = 0.5;
+    uint32_t react_min_ms = 300;
+    uint32_t react_max_ms = 6000;
+    uint32_t hold_ms = 250;
+};
+
+// One motor run as the devices saw it (start: H-bridge forward from off)
+struct SimRun {
+    uint64_t start_us = 0;
+    uint64_t finish_us = 0;      // run_log record arrived (firmware decided to stop)
+    uint64_t stopped_us = 0;     // H-bridge back off
+    bool finished = false;
+    run_log_record_t rec = {};
+    int dropped = 0;             // treats that actually fell
+    bool jam_hit = false;
+    uint64_t jam_hit_us = 0;
+    uint64_t first_reverse_us = 0;   // after jam_hit
+    bool parked_high = false;        // rotary HIGH once the wheel stopped
+};
+
+struct SimWorldStats {
+    uint64_t i2c_reads = 0;
+    uint64_t i2c_writes = 0;
+    uint64_t i2c_bytes = 0;
+    uint32_t interlock_violations = 0;   // IN1+IN2 both HIGH on the bus
+    uint32_t cue_tones = 0;
+    uint32_t alarms = 0;                 // terminal jam patterns
+    uint32_t foot_presses = 0;
+};
+
+void sim_world_init(const SimWorldConfig& cfg, uint64_t seed);
+SimWorldConfig& sim_world_config(void);
+void sim_world_reseed(uint64_t seed);       // new hopper and speed draw for the next run
+void sim_world_advance_to(uint64_t t_us);   // step the devices, then the clock
+
+// Scenario inputs
+void sim_world_set_jam(double at_fraction, SimJamKind kind, int reverses_to_clear);   // -1 = never clears
+void sim_world_clear_jam(void);
+void sim_world_press_remote(uint64_t at_us, uint32_t hold_ms);
+void sim_world_press_foot(uint64_t at_us, uint32_t hold_ms);
+
+// Observations
+const std::vector<SimRun>& sim_world_runs(void);
+bool sim_world_motor_idle(void);            // H-bridge off and wheel at rest
+bool sim_world_led_on(void);
+bool sim_world_ir_on(void);
+const std::vector<uint64_t>& sim_world_foot_press_times(void);
+const SimWorldStats& sim_world_stats(void);
+
+// Hooks from the HAL implementations
+void sim_world_tone(uint64_t start_us, uint16_t freq_hz, uint8_t repeat);
+void sim_world_cancel_tones(uint64_t after_us);
+void sim_world_run_logged(const run_log_record_t* rec);
+
+// current_sense_sim.cpp: one ADC conversion every 1/CURRENT_SENSE_SAMPLE_RATE_HZ
+bool current_sense_sim_wants_samples(void);
+void current_sense_sim_push(uint16_t counts);
+uint32_t current_sense_sim_rate_hz(void);
@@ -0,0 +1,305 @@
+// Virtual clock, Serial sink and a cooperative FreeRTOS for the native environment.
+//
+// Each task is a ucontext coroutine with its own stack. sim_run_tasks() resumes
+// every task that is ready at the current virtual instant, highest priority first,
+// until all of them block again (delay, notify-take, delay-until); only then may the
+// world move the clock. Host time spent inside each wake is recorded per task, which
+// is the tick cost the benchmark reports.
+
+#include "sim.h"
+#include <Arduino.h>
+#include <ucontext.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// Host stacks: vsnprintf and friends need far more than the ESP32 stack sizes
+#define SIM_TASK_STACK_BYTES (256u * 1024u)
+#define SIM_MAX_TASKS 8
+#define SIM_MAX_RESUMES_PER_INSTANT 100000
+
+HardwareSerial Serial;
+
+static uint64_t g_now_us = 0;
+static uint64_t g_rng = 0;
+static bool g_echo_serial = false;
+static bool g_line_start = true;
+
+// -----------------------------
+// Host timing
+// -----------------------------
+uint64_t sim_host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned cost_bucket(uint64_t ns) {
+    if (ns == 0) return 0;
+    // floor(8 * log2(ns)) without libm: octave from the top bit, eighth from the next 3
+    unsigned octave = 63 - (unsigned)__builtin_clzll(ns);
+    unsigned eighth = octave >= 3 ? (unsigned)((ns >> (octave - 3)) & 7) : (unsigned)((ns << (3 - octave)) & 7);
+    unsigned b = octave * 8 + eighth;
+    return b < 384 ? b : 383;
+}
+
+void SimCost::add(uint64_t ns) {
+    count++;
+    total_ns += ns;
+    if (ns > max_ns) max_ns = ns;
+    hist[cost_bucket(ns)]++;
+}
+
+uint64_t SimCost::percentile(double p) const {
+    if (!count) return 0;
+    const uint64_t want = (uint64_t)(p * (double)count + 0.5);
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < 384; b++) {
+        seen += hist[b];
+        if (seen >= want && hist[b]) {
+            const unsigned octave = (b + 1) / 8, eighth = (b + 1) % 8;
+            const uint64_t upper = (8ULL + eighth) << octave >> 3;
+            return upper < max_ns ? upper : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+// -----------------------------
+// Clock, RNG, Serial
+// -----------------------------
+uint64_t sim_now_us(void) { return g_now_us; }
+
+void sim_clock_set(uint64_t now_us) {
+    if (now_us > g_now_us) g_now_us = now_us;
+}
+
+// splitmix64: every run is a pure function of the seed
+uint32_t sim_random32(void) {
+    uint64_t z = (g_rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+void sim_serial_write(const char* s, size_t n) {
+    if (!g_echo_serial) return;
+    for (size_t i = 0; i < n; i++) {
+        if (g_line_start && s[i] != '\r' && s[i] != '\n') {
+            printf("[%10.3f] ", (double)g_now_us / 1e6);
+            g_line_start = false;
+        }
+        if (s[i] == '\r') continue;
+        putchar(s[i]);
+        if (s[i] == '\n') g_line_start = true;
+    }
+}
+
+void sim_kernel_init(uint64_t seed, bool echo_serial) {
+    g_rng = seed;
+    g_echo_serial = echo_serial;
+}
+
+// -----------------------------
+// Tasks
+// -----------------------------
+struct sim_task {
+    const char* name;
+    TaskFunction_t fn;
+    void* param;
+    UBaseType_t priority;
+    ucontext_t ctx;
+    char* stack;
+    bool started;
+    bool dead;
+    uint32_t notify;
+    bool waiting_notify;
+    uint64_t wake_us;     // UINT64_MAX = no timeout
+    SimCost cost;
+};
+
+static sim_task g_tasks[SIM_MAX_TASKS];
+static size_t g_task_count = 0;
+static sim_task* g_current = nullptr;
+static ucontext_t g_sched_ctx;
+
+static void sim_fatal(const char* what) {
+    fprintf(stderr, "sim: %s (t=%.3f s, task=%s)\n", what, (double)g_now_us / 1e6,
+            g_current ? g_current->name : "main");
+    exit(3);
+}
+
+static void task_entry(void) {
+    sim_task* t = g_current;
+    t->fn(t->param);
+    // FreeRTOS tasks never return; treat it like vTaskDelete(NULL)
+    t->dead = true;
+    swapcontext(&t->ctx, &g_sched_ctx);
+}
+
+static bool task_ready(const sim_task* t) {
+    if (t->dead) return false;
+    if (!t->started) return true;
+    if (t->waiting_notify && t->notify) return true;
+    return g_now_us >= t->wake_us;
+}
+
+// Back to the scheduler until the wake condition holds
+static void task_block(uint64_t wake_us, bool on_notify) {
+    sim_task* t = g_current;
+    t->wake_us = wake_us;
+    t->waiting_notify = on_notify;
+    swapcontext(&t->ctx, &g_sched_ctx);
+    t->waiting_notify = false;
+    t->wake_us = UINT64_MAX;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes,
+                                   void* param, UBaseType_t priority, TaskHandle_t* out,
+                                   BaseType_t core) {
+    (void)stack_bytes;
+    (void)core;
+    if (g_task_count >= SIM_MAX_TASKS) return pdFAIL;
+    sim_task* t = &g_tasks[g_task_count++];
+    t->name = name;
+    t->fn = fn;
+    t->param = param;
+    t->priority = priority;
+    t->stack = (char*)malloc(SIM_TASK_STACK_BYTES);
+    t->started = false;
+    t->dead = false;
+    t->notify = 0;
+    t->waiting_notify = false;
+    t->wake_us = UINT64_MAX;
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = SIM_TASK_STACK_BYTES;
+    t->ctx.uc_link = &g_sched_ctx;
+    makecontext(&t->ctx, task_entry, 0);
+    if (out) *out = t;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    sim_task* t = task ? task : g_current;
+    if (!t) return;
+    t->dead = true;
+    if (t == g_current) swapcontext(&t->ctx, &g_sched_ctx);
+}
+
+void sim_run_tasks(void) {
+    for (int n = 0; n < SIM_MAX_RESUMES_PER_INSTANT; n++) {
+        sim_task* next = nullptr;
+        for (size_t i = 0; i < g_task_count; i++) {
+            sim_task* t = &g_tasks[i];
+            if (task_ready(t) && (!next || t->priority > next->priority)) next = t;
+        }
+        if (!next) return;
+
+        next->started = true;
+        g_current = next;
+        const uint64_t t0 = sim_host_ns();
+        swapcontext(&g_sched_ctx, &next->ctx);
+        next->cost.add(sim_host_ns() - t0);
+        g_current = nullptr;
+    }
+    sim_fatal("tasks never block");
+}
+
+uint64_t sim_tasks_next_wake_us(void) {
+    uint64_t next = UINT64_MAX;
+    for (size_t i = 0; i < g_task_count; i++) {
+        const sim_task* t = &g_tasks[i];
+        if (t->dead) continue;
+        if (task_ready(t)) return g_now_us;
+        if (t->wake_us < next) next = t->wake_us;
+    }
+    return next;
+}
+
+size_t sim_task_info(SimTaskInfo* out, size_t max) {
+    size_t n = 0;
+    for (size_t i = 0; i < g_task_count && n < max; i++) {
+        out[n].name = g_tasks[i].name;
+        out[n].cost = &g_tasks[i].cost;
+        n++;
+    }
+    return n;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(g_now_us / 1000ULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return g_current;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    const uint64_t wake = g_now_us + (uint64_t)ticks * 1000ULL;
+    if (!g_current) {
+        // setup() code outside any task: the world runs on while it waits
+        sim_world_advance_to(wake);
+        return;
+    }
+    task_block(wake, false);
+}
+
+void vTaskDelayUntil(TickType_t* prev_wake, TickType_t period) {
+    if (!g_current) sim_fatal("vTaskDelayUntil outside a task");
+    *prev_wake += period;
+    // Tick count is the low 32 bits of virtual ms; rebuild the full wake time
+    const uint64_t now_ms = g_now_us / 1000ULL;
+    const uint64_t wake_ms = now_ms + (uint64_t)(int32_t)(*prev_wake - (TickType_t)now_ms);
+    if (wake_ms > now_ms) task_block(wake_ms * 1000ULL, false);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return pdFAIL;
+    task->notify++;
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    sim_task* t = g_current;
+    if (!t) sim_fatal("ulTaskNotifyTake outside a task");
+    if (t->notify == 0 && ticks != 0) {
+        task_block(ticks == portMAX_DELAY ? UINT64_MAX : g_now_us + (uint64_t)ticks * 1000ULL, true);
+    }
+    const uint32_t v = t->notify;
+    if (v) t->notify = clear_on_exit ? 0 : v - 1;
+    return v;
+}
+
+// -----------------------------
+// Recursive mutex
+// -----------------------------
+struct sim_mutex {
+    sim_task* owner;
+    bool held;
+    uint32_t depth;
+};
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    sim_mutex* m = (sim_mutex*)calloc(1, sizeof(sim_mutex));
+    return m;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticks) {
+    (void)ticks;
+    if (!m) return pdFAIL;
+    if (m->held && m->owner != g_current) sim_fatal("mutex held across a blocking call");
+    m->held = true;
+    m->owner = g_current;
+    m->depth++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m) {
+    if (!m || !m->held || m->owner != g_current) return pdFAIL;
+    if (--m->depth == 0) m->held = false;
+    return pdTRUE;
+}
@@ -0,0 +1,392 @@
+// Device models for the native environment: everything on the far side of the
+// PCF8574 and the current sensor.
+//
+//   PCF8574    quasi-bidirectional port at 0x20: a pin reads LOW if its latch bit is
+//              0 or the device on it pulls it low
+//   Motor      H-bridge on P0/P1 driving the treat wheel. First-order DC motor: current
+//              is stall current times (drive - speed / free speed), so inrush, running
+//              current and a stall all fall out of one equation
+//   Cam        rotary switch on P2, HIGH for the first cam_high of every pocket
+//   Treats     each pocket is loaded with p_loaded; its treat falls as the pocket passes
+//              drop_at and blocks the beam on P6 (which reads LOW with the IR TX off, too)
+//   Jams       an obstruction at a set wheel position: the wheel stops there (stall: the
+//              motor too; slip: the motor keeps turning). Each reverse of at least
+//              unjam_reverse_ms from it counts as an attempt; it clears after N of them
+//   Foot switch P3, pressed by a "dog" that answers cue tones with probability p_press
+//   Remote     P7, pressed by the scenario
+//
+// The world only moves between firmware instants: sim_world_advance_to() steps the
+// physics on the ADC sample grid while the motor turns or the ADC is streaming, and
+// jumps straight to the target time when nothing moves.
+
+#include "sim.h"
+#include <Wire.h>
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include "pcf8574_control.h"
+#include "jam_detect.h"
+
+#define SIM_PCF8574_ADDRESS 0x20
+
+namespace {
+
+struct Rng {
+    uint64_t s = 0;
+    uint32_t next() {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+    double uniform() { return (next() + 0.5) / 4294967296.0; }
+    double range(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+    double normal() {
+        // Box-Muller; one value per call is plenty here
+        return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform());
+    }
+};
+
+struct Press {
+    uint64_t from_us;
+    uint64_t to_us;
+};
+
+struct Tone {
+    uint64_t at_us;
+    uint16_t freq_hz;
+    uint8_t repeat;
+};
+
+struct Jam {
+    bool active = false;
+    double at = 0.0;             // wheel position of the obstruction (pockets)
+    SimJamKind kind = SIM_JAM_STALL;
+    int needed = 0;              // reverses to clear; -1 = never
+    int done = 0;
+    bool reversing = false;      // current reverse started at the obstruction
+    bool counted = false;
+    uint64_t reverse_from_us = 0;
+};
+
+SimWorldConfig g_cfg;
+Rng g_rng;
+SimWorldStats g_stats;
+
+uint8_t g_latch = 0xFF;          // power-up: all released (IN1+IN2 HIGH = brake)
+double g_angle = 0.12;           // pockets; phase 0 = start of a HIGH cam window
+double g_omega = 0.0;            // motor shaft, pockets per second
+double g_omega_nom = 1.0;        // this run's loaded speed
+double g_current = 0.0;          // amps through the sensor (signed)
+int g_drive = 0;                 // -1 reverse, 0 off, 1 forward
+long g_drop_idx = 0;             // floor(angle - drop_at) last step
+
+std::unordered_map<long, bool> g_pockets;   // true = still holds a treat
+long g_first_pocket = 0;                    // pockets before this one were emptied earlier
+std::vector<Press> g_beam;                  // beam blocked by a falling treat
+std::vector<Press> g_foot;
+std::vector<Press> g_remote;
+std::vector<uint64_t> g_foot_starts;
+std::vector<Tone> g_tones;
+Jam g_jam;
+std::vector<SimRun> g_runs;
+
+uint8_t g_dac[2] = {0, 0};
+
+} // namespace
+
+TwoWire Wire;
+
+namespace {
+
+// -----------------------------
+// Inputs
+// -----------------------------
+inline double phase(double a) { return a - floor(a); }
+inline bool rotary_high() { return phase(g_angle) < g_cfg.cam_high; }
+inline bool ir_tx_on() { return (g_latch & (1 << PIN_IR_TX)) == 0; }   // active-low
+
+bool held(const std::vector<Press>& v, uint64_t t) {
+    for (const Press& p : v) {
+        if (t >= p.from_us && t < p.to_us) return true;
+    }
+    return false;
+}
+
+void prune(std::vector<Press>& v, uint64_t t) {
+    v.erase(std::remove_if(v.begin(), v.end(), [t](const Press& p) { return p.to_us <= t; }), v.end());
+}
+
+uint8_t port_levels() {
+    const uint64_t t = sim_now_us();
+    uint8_t ext = 0xFF;
+    if (!rotary_high()) ext &= (uint8_t)~(1 << PIN_ROT_DETECT);
+    if (held(g_foot, t)) ext &= (uint8_t)~(1 << PIN_BUTTON);
+    if (!ir_tx_on() || held(g_beam, t)) ext &= (uint8_t)~(1 << PIN_IR_RX);
+    if (held(g_remote, t)) ext &= (uint8_t)~(1 << PIN_REMOTE_RX);
+    return g_latch & ext;
+}
+
+int drive_from_latch(uint8_t latch) {
+    const bool in1 = latch & (1 << PIN_MOTOR_IN1);
+    const bool in2 = latch & (1 << PIN_MOTOR_IN2);
+    if (in1 && !in2) return 1;
+    if (in2 && !in1) return -1;
+    return 0;   // coast, or brake at power-up
+}
+
+// -----------------------------
+// Run bookkeeping
+// -----------------------------
+void on_drive_change(int from, int to) {
+    const uint64_t now = sim_now_us();
+    if (from == 0 && to == 1) {
+        SimRun r;
+        r.start_us = now;
+        g_runs.push_back(r);
+    }
+    if (g_runs.empty()) return;
+    SimRun& r = g_runs.back();
+    if (to == -1 && r.jam_hit && !r.first_reverse_us) r.first_reverse_us = now;
+    if (to == 0 && r.finished && !r.stopped_us) r.stopped_us = now;
+
+    // An unjam attempt starts when the wheel backs off the obstruction
+    if (g_jam.active && to == -1 && g_angle >= g_jam.at - 1e-6) {
+        g_jam.reversing = true;
+        g_jam.counted = false;
+        g_jam.reverse_from_us = now;
+    } else if (to != -1) {
+        g_jam.reversing = false;
+    }
+}
+
+void update_run_state() {
+    if (g_runs.empty()) return;
+    SimRun& r = g_runs.back();
+    if (r.stopped_us && g_drive == 0 && g_omega == 0.0) r.parked_high = rotary_high();
+}
+
+// -----------------------------
+// Physics
+// -----------------------------
+void drop_treats() {
+    const long idx = (long)floor(g_angle - g_cfg.drop_at);
+    for (long k = g_drop_idx + 1; k <= idx; k++) {
+        auto it = g_pockets.find(k);
+        if (it == g_pockets.end()) {
+            it = g_pockets.emplace(k, k >= g_first_pocket && g_rng.uniform() < g_cfg.p_loaded).first;
+        }
+        if (!it->second) continue;
+        it->second = false;
+        const uint64_t at = sim_now_us() + (uint64_t)g_cfg.fall_ms * 1000ULL;
+        g_beam.push_back({at, at + (uint64_t)g_cfg.beam_ms * 1000ULL});
+        if (!g_runs.empty()) g_runs.back().dropped++;
+    }
+    g_drop_idx = idx;
+}
+
+void step_physics(double dt) {
+    const double r = g_cfg.i_run / g_cfg.i_stall;
+    const double omega_free = g_omega_nom / (1.0 - r);
+    const double accel = omega_free / (g_cfg.tau_ms / 1000.0);   // per unit of stall current
+
+    g_current = g_drive ? g_cfg.i_stall * ((double)g_drive - g_omega / omega_free) : 0.0;
+
+    // Load torque opposes motion (or, at rest, whatever would start it)
+    double load_dir = g_omega > 0 ? 1.0 : g_omega < 0 ? -1.0 : (g_current > 0 ? 1.0 : g_current < 0 ? -1.0 : 0.0);
+    double domega = accel * (g_current / g_cfg.i_stall - r * load_dir) * dt;
+    if (g_omega != 0.0 && ((g_omega > 0) != (g_omega + domega > 0))) {
+        g_omega = 0.0;   // friction stops it; it does not reverse it
+    } else if (g_omega == 0.0 && fabs(g_current) <= g_cfg.i_run) {
+        g_omega = 0.0;   // stiction holds
+    } else {
+        g_omega += domega;
+    }
+
+    double next = g_angle + g_omega * dt;
+    if (g_jam.active && g_omega > 0 && next >= g_jam.at && g_angle <= g_jam.at + 1e-9) {
+        next = g_jam.at;
+        if (g_jam.kind == SIM_JAM_STALL) g_omega = 0.0;
+        if (!g_runs.empty() && !g_runs.back().jam_hit) {
+            g_runs.back().jam_hit = true;
+            g_runs.back().jam_hit_us = sim_now_us();
+        }
+    }
+    g_angle = next;
+    drop_treats();
+
+    if (g_jam.active && g_jam.reversing && !g_jam.counted &&
+        sim_now_us() - g_jam.reverse_from_us >= (uint64_t)g_cfg.unjam_reverse_ms * 1000ULL) {
+        g_jam.counted = true;
+        if (g_jam.needed >= 0 && ++g_jam.done >= g_jam.needed) g_jam.active = false;
+    }
+}
+
+uint16_t sample_counts() {
+    const double per_amp = SENSITIVITY * 4095.0 / CURRENT_SENSOR_ADC_FS_VOLTS;
+    double c = g_cfg.zero_volts / CURRENT_SENSOR_ADC_FS_VOLTS * 4095.0 + g_current * per_amp +
+               g_cfg.noise_counts * g_rng.normal();
+    if (g_rng.uniform() < g_cfg.spike_p) c += g_rng.uniform() < 0.5 ? -300.0 : 300.0;
+    if (c < 0.0) c = 0.0;
+    if (c > 4095.0) c = 4095.0;
+    return (uint16_t)(c + 0.5);
+}
+
+void process_tones(uint64_t now) {
+    size_t keep = 0;
+    for (size_t i = 0; i < g_tones.size(); i++) {
+        const Tone& t = g_tones[i];
+        if (t.at_us > now) {
+            g_tones[keep++] = t;
+            continue;
+        }
+        if (t.freq_hz >= 2000) {
+            g_stats.alarms++;
+            continue;
+        }
+        g_stats.cue_tones++;
+        // The dog answers a cue at most once, and not while a press is still coming
+        if (!g_foot.empty() && g_foot.back().to_us > t.at_us) continue;
+        if (g_rng.uniform() >= g_cfg.p_press) continue;
+        const uint64_t at = t.at_us + (uint64_t)(g_rng.range(g_cfg.react_min_ms, g_cfg.react_max_ms) * 1000.0);
+        sim_world_press_foot(at, g_cfg.hold_ms);
+    }
+    g_tones.resize(keep);
+}
+
+} // namespace
+
+// -----------------------------
+// World API
+// -----------------------------
+void sim_world_init(const SimWorldConfig& cfg, uint64_t seed) {
+    g_cfg = cfg;
+    g_latch = 0xFF;
+    g_angle = 0.12;
+    g_omega = 0.0;
+    g_drive = drive_from_latch(g_latch);
+    sim_world_reseed(seed);
+}
+
+SimWorldConfig& sim_world_config(void) { return g_cfg; }
+
+void sim_world_reseed(uint64_t seed) {
+    g_rng.s = seed;
+    g_pockets.clear();
+    g_drop_idx = (long)floor(g_angle - g_cfg.drop_at);
+    g_first_pocket = g_drop_idx + 1;   // a fresh hopper: whatever is past the drop is empty
+    g_omega_nom = (1.0 / g_cfg.pocket_s) * (1.0 + g_cfg.speed_spread * g_rng.range(-1.0, 1.0));
+}
+
+void sim_world_set_jam(double at_fraction, SimJamKind kind, int reverses_to_clear) {
+    const double next_drop = (double)((long)floor(g_angle - g_cfg.drop_at) + 1) + g_cfg.drop_at;
+    g_jam = Jam();
+    g_jam.active = true;
+    g_jam.at = g_angle + at_fraction * (next_drop - g_angle);
+    g_jam.kind = kind;
+    g_jam.needed = reverses_to_clear;
+}
+
+void sim_world_clear_jam(void) { g_jam = Jam(); }
+
+void sim_world_press_remote(uint64_t at_us, uint32_t hold_ms) {
+    g_remote.push_back({at_us, at_us + (uint64_t)hold_ms * 1000ULL});
+}
+
+void sim_world_press_foot(uint64_t at_us, uint32_t hold_ms) {
+    g_foot.push_back({at_us, at_us + (uint64_t)hold_ms * 1000ULL});
+    g_foot_starts.push_back(at_us);
+    g_stats.foot_presses++;
+}
+
+void sim_world_advance_to(uint64_t t_us) {
+    const uint64_t rate = current_sense_sim_rate_hz();
+    const uint64_t dt_us = 1000000ULL / (rate ? rate : 8000ULL);
+
+    uint64_t now = sim_now_us();
+    while (now < t_us) {
+        process_tones(now);
+        const bool moving = g_drive != 0 || g_omega != 0.0;
+        const bool sampling = current_sense_sim_wants_samples();
+        if (!moving && !sampling) {
+            now = t_us;
+            sim_clock_set(now);
+            break;
+        }
+        uint64_t next = (now / dt_us + 1) * dt_us;   // ADC sample grid
+        if (next > t_us) next = t_us;
+        step_physics((double)(next - now) / 1e6);
+        now = next;
+        sim_clock_set(now);
+        if (sampling && now % dt_us == 0) current_sense_sim_push(sample_counts());
+    }
+    process_tones(now);
+    prune(g_beam, now);
+    prune(g_remote, now);
+    prune(g_foot, now);
+    update_run_state();
+}
+
+const std::vector<SimRun>& sim_world_runs(void) { return g_runs; }
+bool sim_world_motor_idle(void) { return g_drive == 0 && g_omega == 0.0; }
+bool sim_world_led_on(void) { return (g_latch & (1 << PIN_LED)) == 0; }   // active-low
+bool sim_world_ir_on(void) { return ir_tx_on(); }
+const std::vector<uint64_t>& sim_world_foot_press_times(void) { return g_foot_starts; }
+const SimWorldStats& sim_world_stats(void) { return g_stats; }
+
+void sim_world_tone(uint64_t start_us, uint16_t freq_hz, uint8_t repeat) {
+    g_tones.push_back({start_us, freq_hz, repeat});
+}
+
+void sim_world_cancel_tones(uint64_t after_us) {
+    g_tones.erase(std::remove_if(g_tones.begin(), g_tones.end(),
+                                 [after_us](const Tone& t) { return t.at_us > after_us; }),
+                  g_tones.end());
+}
+
+void sim_world_run_logged(const run_log_record_t* rec) {
+    if (g_runs.empty()) return;
+    SimRun& r = g_runs.back();
+    r.finished = true;
+    r.finish_us = sim_now_us();
+    r.rec = *rec;
+    if (g_drive == 0) r.stopped_us = r.finish_us;
+}
+
+// -----------------------------
+// HAL: I2C and DAC
+// -----------------------------
+bool sim_i2c_write(uint8_t addr, const uint8_t* data, size_t n) {
+    if (addr != SIM_PCF8574_ADDRESS) return false;
+    g_stats.i2c_writes++;
+    g_stats.i2c_bytes += n + 1;
+    if (n == 0) return true;
+    const uint8_t latch = data[n - 1];
+    const uint8_t both = (1 << PIN_MOTOR_IN1) | (1 << PIN_MOTOR_IN2);
+    if ((latch & both) == both) g_stats.interlock_violations++;
+    g_latch = latch;
+    const int drive = drive_from_latch(latch);
+    if (drive != g_drive) {
+        const int from = g_drive;
+        g_drive = drive;
+        on_drive_change(from, drive);
+    }
+    update_run_state();
+    return true;
+}
+
+size_t sim_i2c_read(uint8_t addr, uint8_t* data, size_t n) {
+    if (addr != SIM_PCF8574_ADDRESS || n == 0) return 0;
+    g_stats.i2c_reads++;
+    g_stats.i2c_bytes += 2;
+    data[0] = port_levels();
+    return 1;
+}
+
+void sim_dac_enable(int channel, bool on) {
+    if (channel >= 0 && channel < 2 && !on) g_dac[channel] = 0;
+}
+
+void sim_dac_write(int channel, uint8_t value) {
+    if (channel >= 0 && channel < 2) g_dac[channel] = value;
+}
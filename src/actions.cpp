@@ -10,7 +10,7 @@
 // Behaviors included:
 // 1) Manual treat mode sequence (NON-BLOCKING):
 //      - LED ON (P4 active-low)
-//      - Beep 1s (assumes audio_play_tone_1s() is non-blocking)
+//      - Play WAV_FILE from SD (1s cue tone if missing), queued on audio_task, non-blocking
 //      - Dispense treat asynchronously
 //      - LED turns OFF after 5 seconds total-on-time (minimum)
 //
@@ -25,39 +25,63 @@
 // 3) Scheduled treat mode behavior (NON-BLOCKING):
 //      - Treat #1 follows the manual treat sequence
 //      - Treat #2..N require foot-switch activation (20s window). If not pressed -> skip treat.
+//      - Driven by one one-shot LVGL timer armed for the next treat / countdown minute,
+//        not by polling; pause/resume shift every deadline
 //
 // 4) IR remote trigger on PCF P7 (active-low):
 //      - Debounced edge on P7 starts the standalone foot-switch training window at ANY time
 //      - Implemented via LVGL timer polling P7
 //
-// 5) Jam detection uses TWO paths:
+// 5) Jam detection uses TWO paths (jam_detect.h, shared with tools/trace_replay.cpp):
 //      A) PRIMARY: rotary no-motion jam detection
 //      B) SECONDARY: elevated filtered current jam detection
 //      - Hard jam threshold path removed
+//      - Build with -D MOTOR_TRACE=1 to record each run's raw inputs (motor_trace.h)
 //
 // 6) Serial summary includes motion + current info to help tuning.
+//      - The same numbers go to a binary record per run on SD/LittleFS (run_log.h);
+//        tools/run_log_decode.py exports them as CSV
 //
 // 7) Terminal jam alert:
 //      - If motor cannot unjam after all retries, a high-pitched warning tone beeps 5 times.
+//      - Queued as an audio_utils pattern; never blocks the LVGL thread.
 //
 // 8) Timeout behavior:
 //      - Reverse/unjam time does NOT count toward motor timeout
 //      - Allows job to actually reach STOP_JAM after exhausting retries
 //
+// 9) Motor job runs in its own pinned FreeRTOS task (motor_task):
+//      - Periodic at MOTOR_JOB_TICK_MS via vTaskDelayUntil, independent of LVGL load
+//      - UI -> motor: start commands over a lock-free SPSC queue
+//      - motor -> UI: completion events over a second SPSC queue; the task wakes the
+//        UI loop, and MotorJobDoneCb is always invoked on the LVGL thread
+//        (actions_poll_events)
+//      - The current-sense ADC stream only runs during a job, so the idle system can
+//        light-sleep
+//
 
 #include <Arduino.h>
 #include <stdlib.h>
 #include <math.h>
+#include <esp_timer.h>
 #include "ui.h"
 #include "vars.h"
 #include "actions.h"
-#include <SD.h>
-#include <FS.h>
 #include "driver/dac.h"
 #include "pcf8574_control.h"
 #include <Wire.h>
-#include <IRremoteESP8266.h>
 #include "audio_utils.h"
+#include "current_sense.h"
+#include "dsp_pipeline.h"
+#include "jam_detect.h"
+#include "motor_trace.h"
+#include "spsc_queue.h"
+#include "main.h"
+#include "schedule_planner.h"
+#include "run_log.h"
+#include "log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 // -----------------------------
 // Fallback pin defines (safe)
@@ -127,6 +151,19 @@
 #define JAM_WARNING_DAC_AMPLITUDE 220U
 #endif
 
+// Cue tone for training windows and dispense start
+#ifndef CUE_TONE_FREQ_HZ
+#define CUE_TONE_FREQ_HZ 400U
+#endif
+
+#ifndef CUE_TONE_DAC_AMPLITUDE
+#define CUE_TONE_DAC_AMPLITUDE 200U
+#endif
+
+#ifndef CUE_TONE_MS
+#define CUE_TONE_MS 1000UL
+#endif
+
 // -----------------------------
 // Motor Current Sense
 // -----------------------------
@@ -134,15 +171,7 @@
 #define CURRENT_SENSOR_PIN 35
 #endif
 
-#ifndef CURRENT_SENSOR_ADC_FS_VOLTS
-#define CURRENT_SENSOR_ADC_FS_VOLTS 3.3f
-#endif
-
-// ACS712-30A = 66 mV/A
-#ifndef SENSITIVITY
-#define SENSITIVITY 0.066f
-#endif
-
+// Full-scale volts and sensitivity: see jam_detect.h
 #ifndef CURRENT_SENSOR_AVG_SAMPLES
 #define CURRENT_SENSOR_AVG_SAMPLES 4
 #endif
@@ -155,35 +184,33 @@
 #define MOTOR_MAX_UNJAM_RETRIES 3
 #endif
 
-#ifndef MOTOR_JAM_REARM_MS
-#define MOTOR_JAM_REARM_MS 150UL
-#endif
-
-#ifndef CURRENT_FILTER_ALPHA
-#define CURRENT_FILTER_ALPHA 0.20f
+// -----------------------------
+// Current DSP chain: thresholds, filters and blanking live in jam_detect.h
+// -----------------------------
+#ifndef JAM_DSP_MAX_BATCH
+#define JAM_DSP_MAX_BATCH 128   // samples copied per read_since() call
 #endif
 
 // -----------------------------
-// Primary jam detection: rotary no-motion
+// Schedule planning (see schedule_planner.h)
 // -----------------------------
-#ifndef JAM_NO_MOTION_STARTUP_MS
-#define JAM_NO_MOTION_STARTUP_MS 400UL
+#ifndef SCHEDULE_DISTRIBUTION
+#define SCHEDULE_DISTRIBUTION PLAN_DIST_MIXED
 #endif
 
-#ifndef JAM_NO_MOTION_TIMEOUT_MS
-#define JAM_NO_MOTION_TIMEOUT_MS 1500UL
+// Minimum spacing between planned treats
+#ifndef SCHEDULE_MIN_GAP_S
+#define SCHEDULE_MIN_GAP_S 60UL
 #endif
 
-// -----------------------------
-// Secondary jam detection: filtered current
-// Tuned conservatively to avoid normal-start false positives.
-// -----------------------------
-#ifndef JAM_FILTERED_THRESHOLD_AMPS
-#define JAM_FILTERED_THRESHOLD_AMPS 0.85f
+// Non-zero: every run replays the same plan (the seed is logged with each plan)
+#ifndef SCHEDULE_SEED
+#define SCHEDULE_SEED 0UL
 #endif
 
-#ifndef JAM_FILTERED_CONFIRM_MS
-#define JAM_FILTERED_CONFIRM_MS 250UL
+// Foot-switch poll rate while a scheduled treat waits for it (the only polled phase)
+#ifndef SCHEDULE_FOOTSWITCH_POLL_MS
+#define SCHEDULE_FOOTSWITCH_POLL_MS 100UL
 #endif
 
 // Must be defined in main.cpp and calibrated there.
@@ -197,6 +224,20 @@ extern float ZERO_CURRENT_VOLTAGE;
 #define MOTOR_JOB_TICK_MS 5
 #endif
 
+// Motor task: same core as loop() but higher priority, so a long LVGL render
+// is preempted instead of stretching the jam/stop sampling interval.
+#ifndef MOTOR_TASK_CORE
+#define MOTOR_TASK_CORE 1
+#endif
+
+#ifndef MOTOR_TASK_PRIORITY
+#define MOTOR_TASK_PRIORITY 5
+#endif
+
+#ifndef MOTOR_TASK_STACK
+#define MOTOR_TASK_STACK 4096
+#endif
+
 // -----------------------------
 // Remote Control Settings
 // -----------------------------
@@ -208,39 +249,39 @@ extern float ZERO_CURRENT_VOLTAGE;
 #define TRAINING_ARM_MS 50UL
 #endif
 
+// The remote poll runs at REMOTE_IDLE_POLL_MS while P7 sits still and drops to
+// REMOTE_POLL_INTERVAL_MS only while a change is being debounced. A remote press
+// holds P7 low far longer than the idle period, so no press is missed.
 #ifndef REMOTE_POLL_INTERVAL_MS
 #define REMOTE_POLL_INTERVAL_MS 5UL
 #endif
 
+#ifndef REMOTE_IDLE_POLL_MS
+#define REMOTE_IDLE_POLL_MS 40UL
+#endif
+
 #ifndef REMOTE_DEBOUNCE_MS
 #define REMOTE_DEBOUNCE_MS 10UL
 #endif
 
-// ---------------------------
-// Serial rate limiting helpers
-// ---------------------------
-static inline bool every_30s(unsigned long now_ms) {
-    static unsigned long last = 0;
-    if (now_ms - last >= 30000UL) {
-        last = now_ms;
-        return true;
-    }
-    return false;
-}
-
 // ---------------------------
 // Current sensor helpers
 // ---------------------------
-static inline int read_current_sensor_adc_avg() {
-    int sample_count = CURRENT_SENSOR_AVG_SAMPLES;
-    if (sample_count < 1) sample_count = 1;
-
-    long sum = 0;
-    for (int i = 0; i < sample_count; i++) {
-        sum += analogRead(CURRENT_SENSOR_PIN);
+// Window = one motor tick of DMA samples (non-blocking), or
+// CURRENT_SENSOR_AVG_SAMPLES blocking analogRead()s if DMA is unavailable.
+static inline current_window_t read_current_sensor_window() {
+    uint32_t samples = (current_sense_sample_rate_hz() * MOTOR_JOB_TICK_MS) / 1000UL;
+    if (samples == 0) samples = CURRENT_SENSOR_AVG_SAMPLES;
+    if (samples < 1) samples = 1;
+
+    const float zero_counts = (ZERO_CURRENT_VOLTAGE / CURRENT_SENSOR_ADC_FS_VOLTS) * 4095.0f;
+
+    current_window_t win;
+    if (!current_sense_window((uint16_t)samples, (uint16_t)zero_counts, &win)) {
+        // No samples yet: report 0 A rather than a bogus full-scale reading
+        win.mean = win.min = win.peak = (uint16_t)zero_counts;
     }
-
-    return (int)(sum / sample_count);
+    return win;
 }
 
 static inline float adc_to_voltage(int adcValue) {
@@ -282,22 +323,13 @@ static unsigned long schedule_last_tone_ms = 0;
 
 volatile bool schedule_stop_requested = false;
 
-int selected_treats_number = 1;
-int selected_hours_to_dispense = 2;
-
-int schedule_treats_dispensed = 0;
-int schedule_remaining_minutes = 0;
-bool schedule_is_running = false;
-bool schedule_is_paused = false;
-
+// Selections, counters and run/pause flags live in schedule_state (LVGL subjects)
 void* schedule_timer = NULL;
 static unsigned long schedule_start_time = 0;
 static unsigned long schedule_pause_time = 0;
-static int schedule_last_displayed_minutes = -9999;
 
-// Schedule timing arrays
-static int scheduled_times[96];
-static int total_scheduled_treats = 0;
+// Treat plan for the running schedule (seconds from start)
+static schedule_plan_t schedule_plan;
 static int current_treat_index = 0;
 
 // LED control
@@ -351,8 +383,11 @@ static inline void led_blink_tick(unsigned long now) {
 // ---------------------------
 // Debounced inputs
 // ---------------------------
+// These run from 50 ms LVGL timers: a snapshot that young is as good as a bus read
+#define INPUT_POLL_MAX_AGE_US (50UL * 1000UL)
+
 static inline bool footswitch_pressed_debounced(unsigned long now_ms) {
-    bool raw = !readPCF8574Pin(PIN_FOOTSWITCH); // active-low
+    bool raw = !(readPCF8574PortMaxAge(INPUT_POLL_MAX_AGE_US) & (1 << PIN_FOOTSWITCH)); // active-low
     static bool prev = false;
     static unsigned long t = 0;
     if (raw != prev) {
@@ -368,7 +403,6 @@ static inline bool footswitch_pressed_debounced(unsigned long now_ms) {
 extern "C" {
 void init_audio();
 void full_stop();
-void update_schedule_3_ui();
 void Motor_Start();
 void IR_Start();
 void IR_Stop();
@@ -379,9 +413,34 @@ void IR_Stop();
 // ---------------------------------------------
 typedef void (*MotorJobDoneCb)(MotorStopReason reason);
 
+// UI -> motor task
+struct MotorJobCmd {
+    unsigned long timeout_ms;
+    unsigned long led_on_start_ms;
+    unsigned long led_min_on_ms;
+    volatile bool* external_stop_flag;
+    MotorJobDoneCb done_cb;
+};
+
+// motor task -> UI
+struct MotorJobEvent {
+    MotorJobDoneCb done_cb;
+    MotorStopReason reason;
+};
+
+static SpscQueue<MotorJobCmd, 4>   g_motor_cmd_q;
+static SpscQueue<MotorJobEvent, 4> g_motor_event_q;
+static TaskHandle_t g_motor_task = NULL;
+
+// UI-side view: true from start request until its done event has been delivered.
+// Owned by the LVGL thread; the task owns g_motor_job.
+static bool g_motor_busy = false;
+static inline bool motor_job_busy() { return g_motor_busy; }
+
 struct AsyncMotorJob {
     bool active = false;
     bool ir_started = false;
+    bool motor_started = false;   // forward drive waits for the IR receiver to settle
 
     unsigned long start_ms = 0;
     unsigned long timeout_ms = 0;
@@ -391,16 +450,17 @@ struct AsyncMotorJob {
 
     // Reverse/unjam time accumulated here is excluded from timeout.
     unsigned long paused_for_reverse_ms = 0;
+    // Stuck time before each no-motion jam; excluded from timeout like reverse time.
+    unsigned long stalled_ms = 0;
 
     volatile bool* external_stop_flag = nullptr;
     MotorJobDoneCb done_cb = nullptr;
 
-    lv_timer_t* timer = NULL;
-
     // Treat logic state
     bool treatDispensed = false;
     bool lastRotary = false;
     int  lhTransitions = 0;
+    int  lhReplay = 0;          // LOW->HIGH edges backed over by unjam reverses, not yet re-crossed
     bool stopRequested_NoTreat = false;
     bool waitForNextHigh_AfterTreat = false;
     bool seenLowAfterTreat = false;
@@ -409,23 +469,19 @@ struct AsyncMotorJob {
     float inst_current_amps = 0.0f;
     float filtered_current_amps = 0.0f;
     float peak_current_amps = 0.0f;
+    float rms_current_amps = 0.0f;     // windowed RMS (DSP)
     float last_voltage = 0.0f;
     float last_delta_v = 0.0f;
     int   last_adc = 0;
 
-    // Motion / no-motion jam detection
-    unsigned long last_motion_ms = 0;
-    unsigned long motion_arm_after_ms = 0;
-    bool saw_motion_this_run = false;
-
-    // Filtered current jam detection
-    unsigned long filtered_jam_start_ms = 0;
+    // Jam paths A (no motion) and B (filtered current) with their DSP chain
+    JamDetector jam;
+    uint32_t dsp_cursor = 0;
 
     // Unjam / reverse state
     bool reverse_active = false;
     unsigned long reverse_start_ms = 0;
     int jam_retries = 0;
-    unsigned long jam_rearm_after_ms = 0;
 
     MotorStopReason final_reason = STOP_TIMEOUT;
 };
@@ -435,8 +491,10 @@ static AsyncMotorJob g_motor_job;
 // ---------------------------
 // Helper prototypes
 // ---------------------------
-static void motor_job_tick(lv_timer_t* timer);
+static void motor_job_tick();
+static void motor_job_begin(const MotorJobCmd& cmd);
 static void motor_job_finish(MotorStopReason reason);
+static void motor_task(void* param);
 static void start_async_motor_job(unsigned long timeout_ms,
                                   unsigned long led_on_start_ms,
                                   unsigned long led_min_on_ms,
@@ -449,17 +507,17 @@ static void ensure_remote_poll_timer_running();
 static void cancel_footswitch_training_window();
 static void start_footswitch_training_window();
 static void start_unjam_reverse(unsigned long now, const char* cause);
+static void play_cue_tone();
+static void play_dispense_sound();
 static void play_jam_warning_5x();
 static void play_jam_warning_if_needed(MotorStopReason reason);
-static void play_square_tone_blocking(uint16_t freq_hz,
-                                      uint8_t amplitude,
-                                      unsigned long duration_ms);
+static void schedule_rearm();
 
 // ---------------------------
 // Button helpers
 // ---------------------------
 static inline bool button_pressed_debounced(unsigned long now_ms) {
-    bool raw = !readPCF8574Pin(PIN_BUTTON);
+    bool raw = !(readPCF8574PortMaxAge(INPUT_POLL_MAX_AGE_US) & (1 << PIN_BUTTON));
     static bool prev = false;
     static unsigned long t = 0;
     if (raw != prev) {
@@ -470,7 +528,7 @@ static inline bool button_pressed_debounced(unsigned long now_ms) {
 }
 
 static inline bool button_edge_pressed() {
-    bool raw = !readPCF8574Pin(PIN_BUTTON);
+    bool raw = !(readPCF8574PortMaxAge(INPUT_POLL_MAX_AGE_US) & (1 << PIN_BUTTON));
     static bool last = false;
     bool edge = raw && !last;
     last = raw;
@@ -486,9 +544,11 @@ static void led_off_timer_cb(lv_timer_t* t) {
 }
 
 static inline void motor_ir_stop_only() {
+    beginPCF8574Outputs();
     setPCF8574Pin(PIN_MOTOR_IN1, false);
     setPCF8574Pin(PIN_MOTOR_IN2, false);
     setPCF8574Pin(PIN_IR_TX, true); // active-low off
+    commitPCF8574Outputs();
 }
 
 static inline void finish_with_led_min_on_time(unsigned long led_on_start_ms,
@@ -501,18 +561,25 @@ static inline void finish_with_led_min_on_time(unsigned long led_on_start_ms,
     }
 }
 
-static inline void stop_motor_ir_and_hold_led_if_needed(unsigned long led_on_start_ms,
-                                                        unsigned long min_on_ms) {
-    motor_ir_stop_only();
-    finish_with_led_min_on_time(led_on_start_ms, min_on_ms);
-}
-
 // ---------------------------
 // Async motor job internals
 // ---------------------------
+// millis() is esp_timer / 1000; taking both from one read keeps traces exact
+static inline uint64_t motor_now_us() { return (uint64_t)esp_timer_get_time(); }
+static inline unsigned long us_to_ms(uint64_t us) { return (unsigned long)(us / 1000ULL); }
+
+// Forward-running time of the current job: wall time minus reverse/unjam and
+// stalled-before-jam time. This is what the job timeout is measured against.
+static unsigned long motor_job_run_ms(unsigned long now) {
+    const unsigned long total = now - g_motor_job.start_ms;
+    const unsigned long excluded = g_motor_job.paused_for_reverse_ms + g_motor_job.stalled_ms;
+    return (total >= excluded) ? (total - excluded) : 0;
+}
+
 static void motor_job_reset_treat_logic() {
     g_motor_job.treatDispensed = false;
     g_motor_job.lhTransitions = 0;
+    g_motor_job.lhReplay = 0;
     g_motor_job.stopRequested_NoTreat = false;
     g_motor_job.waitForNextHigh_AfterTreat = false;
     g_motor_job.seenLowAfterTreat = false;
@@ -521,15 +588,16 @@ static void motor_job_reset_treat_logic() {
     g_motor_job.inst_current_amps = 0.0f;
     g_motor_job.filtered_current_amps = 0.0f;
     g_motor_job.peak_current_amps = 0.0f;
+    g_motor_job.rms_current_amps = 0.0f;
     g_motor_job.last_voltage = 0.0f;
     g_motor_job.last_delta_v = 0.0f;
     g_motor_job.last_adc = 0;
 
-    g_motor_job.last_motion_ms = millis();
-    g_motor_job.motion_arm_after_ms = g_motor_job.last_motion_ms + JAM_NO_MOTION_STARTUP_MS;
-    g_motor_job.saw_motion_this_run = false;
-
-    g_motor_job.filtered_jam_start_ms = 0;
+    const uint64_t now_us = motor_now_us();
+    const int32_t zero = volts_to_zero_counts(ZERO_CURRENT_VOLTAGE);
+    g_motor_job.jam.begin((uint32_t)us_to_ms(now_us), zero);
+    g_motor_job.dsp_cursor = current_sense_total_samples();
+    motor_trace_begin(now_us, zero, MOTOR_JOB_TICK_MS);
 
     // legacy mirrors for compatibility/debug
     treatDispensed = false;
@@ -540,13 +608,32 @@ static void motor_job_reset_treat_logic() {
     lastRotary = g_motor_job.lastRotary;
 }
 
+// UI side: hand the job to motor_task. Runs on the LVGL thread.
 static void start_async_motor_job(unsigned long timeout_ms,
                                   unsigned long led_on_start_ms,
                                   unsigned long led_min_on_ms,
                                   volatile bool* external_stop_flag,
                                   MotorJobDoneCb done_cb) {
+    if (motor_job_busy()) {
+        LOGI(MOTOR, "Async motor job already active; ignoring new request.");
+        return;
+    }
+
+    const MotorJobCmd cmd = { timeout_ms, led_on_start_ms, led_min_on_ms, external_stop_flag, done_cb };
+    if (!g_motor_task || !g_motor_cmd_q.push(cmd)) {
+        LOGW(MOTOR, "Async motor job: motor task unavailable; ignoring request.");
+        return;
+    }
+
+    g_motor_busy = true;
+    led_set_solid(true);
+    xTaskNotifyGive(g_motor_task);
+}
+
+// Task side: initialise job state and energise the motor.
+static void motor_job_begin(const MotorJobCmd& cmd) {
     if (g_motor_job.active) {
-        Serial.println("Async motor job already active; ignoring new request.");
+        LOGI(MOTOR, "Async motor job already active; ignoring new request.");
         return;
     }
 
@@ -554,178 +641,292 @@ static void start_async_motor_job(unsigned long timeout_ms,
 
     g_motor_job.active = true;
     g_motor_job.ir_started = false;
+    g_motor_job.motor_started = false;
     g_motor_job.start_ms = now;
-    g_motor_job.timeout_ms = timeout_ms;
-    g_motor_job.led_on_start_ms = led_on_start_ms;
-    g_motor_job.led_min_on_ms = led_min_on_ms;
+    g_motor_job.timeout_ms = cmd.timeout_ms;
+    g_motor_job.led_on_start_ms = cmd.led_on_start_ms;
+    g_motor_job.led_min_on_ms = cmd.led_min_on_ms;
     g_motor_job.ir_valid_after_ms = now + IR_SETTLE_MS;
     g_motor_job.paused_for_reverse_ms = 0;
-    g_motor_job.external_stop_flag = external_stop_flag;
-    g_motor_job.done_cb = done_cb;
+    g_motor_job.stalled_ms = 0;
+    g_motor_job.external_stop_flag = cmd.external_stop_flag;
+    g_motor_job.done_cb = cmd.done_cb;
     g_motor_job.final_reason = STOP_TIMEOUT;
 
     g_motor_job.reverse_active = false;
     g_motor_job.reverse_start_ms = 0;
     g_motor_job.jam_retries = 0;
-    g_motor_job.jam_rearm_after_ms = 0;
 
     motor_job_reset_treat_logic();
 
-    led_set_solid(true);
-    Motor_Start();
+    // Sample from before the motor starts so inrush is seen
+    current_sense_set_active(true);
+
+    // IR first; motor_job_tick() starts the motor once the receiver has settled
     setPCF8574Pin(PIN_IR_TX, false); // IR ON, non-blocking
     g_motor_job.ir_started = true;
 
-    if (g_motor_job.timer) {
-        lv_timer_del(g_motor_job.timer);
-        g_motor_job.timer = NULL;
-    }
+    LOGD(MOTOR, "Async motor job started.");
+}
 
-    g_motor_job.timer = lv_timer_create(motor_job_tick, MOTOR_JOB_TICK_MS, NULL);
-    Serial.println("Async motor job started.");
+// ---------------------------
+// Run log (motor_task side: fill and queue only)
+// ---------------------------
+static inline uint16_t sat_u16(unsigned long v) { return v > 0xFFFFUL ? 0xFFFF : (uint16_t)v; }
+static inline uint16_t amps_to_ma(float a) { return a <= 0.0f ? 0 : sat_u16((unsigned long)(a * 1000.0f + 0.5f)); }
+
+static void run_log_record_run(MotorStopReason reason, unsigned long now, unsigned long run_ms) {
+    run_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.reason = (uint8_t)reason;
+    rec.retries = (uint8_t)g_motor_job.jam_retries;
+    rec.flags = (g_motor_job.treatDispensed ? RUN_LOG_FLAG_TREAT : 0) |
+                (g_motor_job.jam.saw_motion ? RUN_LOG_FLAG_SAW_MOTION : 0);
+    rec.uptime_ms = (uint32_t)now;
+    rec.run_ms = (uint32_t)run_ms;
+    rec.reverse_ms = sat_u16(g_motor_job.paused_for_reverse_ms);
+    rec.no_motion_ms = sat_u16(now - g_motor_job.jam.last_motion_ms);
+    rec.transitions = sat_u16((unsigned long)g_motor_job.lhTransitions);
+    rec.peak_ma = amps_to_ma(g_motor_job.peak_current_amps);
+    rec.filtered_ma = amps_to_ma(g_motor_job.filtered_current_amps);
+    rec.rms_ma = amps_to_ma(g_motor_job.rms_current_amps);
+    rec.max_slope_ma = amps_to_ma(counts_to_amps(g_motor_job.jam.max_slope_counts));
+    (void)run_log_append(&rec);   // drops are counted and reported by the writer
 }
 
 static void motor_job_finish(MotorStopReason reason) {
     g_motor_job.final_reason = reason;
 
-    if (g_motor_job.timer) {
-        lv_timer_del(g_motor_job.timer);
-        g_motor_job.timer = NULL;
-    }
-
     g_motor_job.active = false;
     g_motor_job.reverse_active = false;
 
-    const unsigned long now = millis();
-    const unsigned long total_elapsed_ms = now - g_motor_job.start_ms;
-    const unsigned long effective_elapsed_ms =
-        (total_elapsed_ms >= g_motor_job.paused_for_reverse_ms)
-            ? (total_elapsed_ms - g_motor_job.paused_for_reverse_ms)
-            : 0;
-
-    Serial.printf(
-        "RUN SUMMARY: peak=%.2fA filtered=%.2fA inst=%.2fA zero=%.3fV retries=%d reason=%d transitions=%d treat=%d sawMotion=%d noMotionMs=%lu runMs=%lu reverseMs=%lu\r\n",
+    // Coast here, on the tick that decided to stop: the done callback only runs
+    // once the UI loop gets to it, and the cam keeps turning until IN1/IN2 drop.
+    motor_ir_stop_only();
+
+    const uint64_t now_us = motor_now_us();
+    const unsigned long now = us_to_ms(now_us);
+    const unsigned long effective_elapsed_ms = motor_job_run_ms(now);
+
+    motor_trace_event(now_us, TRACE_EV_FINISH, (uint16_t)reason);
+    motor_trace_end((uint8_t)reason);
+
+    LOGI(MOTOR,
+        "RUN SUMMARY: peak=%.2fA filtered=%.2fA inst=%.2fA rms=%.2fA maxSlope=%.2fA zero=%.3fV retries=%d reason=%d transitions=%d treat=%d sawMotion=%d noMotionMs=%lu runMs=%lu reverseMs=%lu",
         g_motor_job.peak_current_amps,
         g_motor_job.filtered_current_amps,
         g_motor_job.inst_current_amps,
+        g_motor_job.rms_current_amps,
+        counts_to_amps(g_motor_job.jam.max_slope_counts),
         ZERO_CURRENT_VOLTAGE,
         g_motor_job.jam_retries,
         (int)reason,
         g_motor_job.lhTransitions,
         g_motor_job.treatDispensed ? 1 : 0,
-        g_motor_job.saw_motion_this_run ? 1 : 0,
-        (unsigned long)(now - g_motor_job.last_motion_ms),
+        g_motor_job.jam.saw_motion ? 1 : 0,
+        (unsigned long)(now - g_motor_job.jam.last_motion_ms),
         effective_elapsed_ms,
         g_motor_job.paused_for_reverse_ms
     );
+    run_log_record_run(reason, now, effective_elapsed_ms);
+
+    // Always post, even without a callback: the UI clears g_motor_busy on delivery.
+    const MotorJobEvent ev = { g_motor_job.done_cb, reason };
+    g_motor_job.done_cb = nullptr;
+    if (!g_motor_event_q.push(ev)) {
+        LOGW(MOTOR, "Motor event queue full; completion dropped.");
+    }
+    current_sense_set_active(false);
+    ui_loop_wake();
+}
+
+// ---------------------------
+// Motor task + UI event pump
+// ---------------------------
+static void motor_task(void* /*param*/) {
+    const TickType_t period = pdMS_TO_TICKS(MOTOR_JOB_TICK_MS) ? pdMS_TO_TICKS(MOTOR_JOB_TICK_MS) : 1;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    for (;;) {
+        MotorJobCmd cmd;
+        while (g_motor_cmd_q.pop(cmd)) {
+            motor_job_begin(cmd);
+        }
+
+        if (!g_motor_job.active) {
+            // Idle: sleep until start_async_motor_job() notifies us
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+            continue;
+        }
+
+        motor_job_tick();
+        vTaskDelayUntil(&last_wake, period);
+    }
+}
 
-    if (g_motor_job.done_cb) {
-        MotorJobDoneCb cb = g_motor_job.done_cb;
-        g_motor_job.done_cb = nullptr;
-        cb(reason);
+// LVGL thread: deliver completions so callbacks may touch LVGL/UI state.
+// Called from loop() on every pass; motor_task wakes the loop after posting.
+extern "C" void actions_poll_events(void) {
+    MotorJobEvent ev;
+    bool any = false;
+    while (g_motor_event_q.pop(ev)) {
+        g_motor_busy = false;
+        if (ev.done_cb) ev.done_cb(ev.reason);
+        any = true;
     }
+    // The schedule holds off treats while the motor is busy; look again now it is free
+    if (any) schedule_rearm();
+}
+
+static void ensure_motor_task_running() {
+    if (g_motor_task) return;
+
+    xTaskCreatePinnedToCore(
+        motor_task,
+        "motor_task",
+        MOTOR_TASK_STACK,
+        nullptr,
+        MOTOR_TASK_PRIORITY,
+        &g_motor_task,
+        MOTOR_TASK_CORE
+    );
+
+    LOGI(MOTOR, "Motor task started: core=%d prio=%d tick=%d ms",
+                (int)MOTOR_TASK_CORE, (int)MOTOR_TASK_PRIORITY, (int)MOTOR_JOB_TICK_MS);
 }
 
 static void start_unjam_reverse(unsigned long now, const char* cause) {
     g_motor_job.jam_retries++;
-    g_motor_job.filtered_jam_start_ms = 0;
 
-    Serial.printf("JAM detected by %s -> retry %d/%d\r\n",
-                  cause,
-                  g_motor_job.jam_retries,
-                  MOTOR_MAX_UNJAM_RETRIES);
+    LOGW(JAM, "JAM detected by %s -> retry %d/%d",
+              cause,
+              g_motor_job.jam_retries,
+              MOTOR_MAX_UNJAM_RETRIES);
 
     if (g_motor_job.jam_retries > MOTOR_MAX_UNJAM_RETRIES) {
-        Serial.println("Max unjam retries exceeded. Stopping motor job as JAM.");
+        LOGW(JAM, "Max unjam retries exceeded. Stopping motor job as JAM.");
         motor_job_finish(STOP_JAM);
         return;
     }
 
+    // Single write: CW -> CCW without an intermediate IN1/IN2 state on the bus
+    beginPCF8574Outputs();
     setPCF8574Pin(PIN_MOTOR_IN1, false);
     setPCF8574Pin(PIN_MOTOR_IN2, true);
-    Serial.println("Motor ON (CCW / unjam)");
+    commitPCF8574Outputs();
+    LOGD(JAM, "Motor ON (CCW / unjam)");
 
     g_motor_job.reverse_active = true;
     g_motor_job.reverse_start_ms = now;
-    g_motor_job.last_motion_ms = now;
+    g_motor_job.jam.reversing((uint32_t)now);
 }
 
-static void motor_job_tick(lv_timer_t* timer) {
-    (void)timer;
-    const unsigned long now = millis();
+// Runs on motor_task only.
+static void motor_job_tick() {
+    const uint64_t now_us = motor_now_us();
+    const unsigned long now = us_to_ms(now_us);
 
-    if (!g_motor_job.active) {
-        if (g_motor_job.timer) {
-            lv_timer_del(g_motor_job.timer);
-            g_motor_job.timer = NULL;
-        }
-        return;
-    }
+    if (!g_motor_job.active) return;
+
+    motor_trace_tick(now_us, g_motor_job.reverse_active ? TRACE_F_REVERSE : 0, 0);
 
     if (g_motor_job.external_stop_flag && *g_motor_job.external_stop_flag) {
-        Serial.println("External stop flag set -> abort motor run.");
+        LOGI(MOTOR, "External stop flag set -> abort motor run.");
         motor_job_finish(STOP_EXTERNAL_REQUEST);
         return;
     }
 
+    // The beam reads broken until the receiver settles. A wheel parked just short
+    // of the drop (after a jam or timeout stop) would let its treat fall unseen
+    // and run on to the next pocket, so hold the motor until the beam is valid.
+    if (!g_motor_job.motor_started) {
+        if (now < g_motor_job.ir_valid_after_ms) return;
+        g_motor_job.motor_started = true;
+        g_motor_job.start_ms = now;
+        g_motor_job.jam.begin((uint32_t)now, volts_to_zero_counts(ZERO_CURRENT_VOLTAGE));
+        g_motor_job.dsp_cursor = current_sense_total_samples();
+        Motor_Start();
+        LOGD(MOTOR, "IR settled; motor started.");
+        return;
+    }
+
     // If reversing to unjam, hold reverse for a fixed interval, then resume forward.
     // IMPORTANT: reverse time does NOT count toward timeout.
     if (g_motor_job.reverse_active) {
+        // Follow the cam while backing up: each HIGH->LOW here un-crosses a LOW->HIGH
+        // edge the forward run already counted, and that edge comes round again once
+        // forward resumes. Those replays must not count toward the no-treat stop.
+        const bool rotary = (readPCF8574PortCached(NULL) & (1 << PIN_ROTARY)) != 0;
+        if (g_motor_job.lastRotary && !rotary) g_motor_job.lhReplay++;
+        g_motor_job.lastRotary = rotary;
+
         if ((now - g_motor_job.reverse_start_ms) >= MOTOR_UNJAM_REVERSE_MS) {
             g_motor_job.paused_for_reverse_ms += (now - g_motor_job.reverse_start_ms);
 
             g_motor_job.reverse_active = false;
-            g_motor_job.jam_rearm_after_ms = now + MOTOR_JAM_REARM_MS;
-            g_motor_job.motion_arm_after_ms = now + JAM_NO_MOTION_STARTUP_MS;
-            g_motor_job.filtered_jam_start_ms = 0;
-            g_motor_job.last_motion_ms = now;
-            g_motor_job.saw_motion_this_run = false;
+            g_motor_job.jam.resume((uint32_t)now, volts_to_zero_counts(ZERO_CURRENT_VOLTAGE));
+            g_motor_job.dsp_cursor = current_sense_total_samples();
+            motor_trace_event(now_us, TRACE_EV_REVERSE_END, 0);
 
             Motor_Start();
             g_motor_job.ir_valid_after_ms = now + IR_SETTLE_MS;
 
-            Serial.printf("Unjam reverse complete. Resuming forward. Retry %d/%d\r\n",
-                          g_motor_job.jam_retries, MOTOR_MAX_UNJAM_RETRIES);
+            LOGI(JAM, "Unjam reverse complete. Resuming forward. Retry %d/%d",
+                      g_motor_job.jam_retries, MOTOR_MAX_UNJAM_RETRIES);
         }
         return;
     }
 
     // Timeout applies only to forward-running time, not reverse/unjam time.
     {
-        const unsigned long total_elapsed_ms = now - g_motor_job.start_ms;
-        const unsigned long effective_elapsed_ms =
-            (total_elapsed_ms >= g_motor_job.paused_for_reverse_ms)
-                ? (total_elapsed_ms - g_motor_job.paused_for_reverse_ms)
-                : 0;
+        const unsigned long effective_elapsed_ms = motor_job_run_ms(now);
 
         if (effective_elapsed_ms >= g_motor_job.timeout_ms) {
-            Serial.printf("Motor timeout reached. effectiveRun=%lu ms reversePaused=%lu ms\r\n",
-                          effective_elapsed_ms,
-                          g_motor_job.paused_for_reverse_ms);
+            LOGI(MOTOR, "Motor timeout reached. effectiveRun=%lu ms reversePaused=%lu ms",
+                        effective_elapsed_ms,
+                        g_motor_job.paused_for_reverse_ms);
             motor_job_finish(STOP_TIMEOUT);
             return;
         }
     }
 
-    // Current monitoring while motor runs (averaged ADC)
-    const int adcValue = read_current_sensor_adc_avg();
+    // Current monitoring while motor runs (window of DMA samples since last tick)
+    const current_window_t win = read_current_sensor_window();
+    const int adcValue = win.mean;
     const float voltage = adc_to_voltage(adcValue);
     const float delta_v = voltage - ZERO_CURRENT_VOLTAGE;
     const float inst_current = voltage_to_current_amps(voltage);
+    // Sensor is bidirectional: the window extreme furthest from zero is the peak
+    const float win_peak_current = fmaxf(voltage_to_current_amps(adc_to_voltage(win.peak)),
+                                         voltage_to_current_amps(adc_to_voltage(win.min)));
 
-    if (g_motor_job.filtered_current_amps <= 0.0001f) {
-        g_motor_job.filtered_current_amps = inst_current;
-    } else {
-        g_motor_job.filtered_current_amps =
-            (CURRENT_FILTER_ALPHA * inst_current) +
-            ((1.0f - CURRENT_FILTER_ALPHA) * g_motor_job.filtered_current_amps);
+    // Stream every new sample through the integer DSP chain. Without DMA the
+    // tick's averaged sample is the only input (200 Hz; time constants scale up).
+    {
+        uint16_t batch[JAM_DSP_MAX_BATCH];
+        uint16_t n;
+        bool fed = false;
+        while ((n = current_sense_read_since(&g_motor_job.dsp_cursor, batch, JAM_DSP_MAX_BATCH)) > 0) {
+            for (uint16_t i = 0; i < n; i++) g_motor_job.jam.step(batch[i]);
+            motor_trace_samples(batch, n);
+            fed = true;
+            if (n < JAM_DSP_MAX_BATCH) break;
+        }
+        if (!fed) {
+            g_motor_job.jam.step(adcValue);
+            batch[0] = (uint16_t)adcValue;
+            motor_trace_samples(batch, 1);
+        }
     }
+    g_motor_job.filtered_current_amps = counts_to_amps(g_motor_job.jam.level_counts);
 
-    if (inst_current > g_motor_job.peak_current_amps) {
-        g_motor_job.peak_current_amps = inst_current;
+    if (win_peak_current > g_motor_job.peak_current_amps) {
+        g_motor_job.peak_current_amps = win_peak_current;
     }
 
     g_motor_job.inst_current_amps = inst_current;
+    g_motor_job.rms_current_amps = counts_to_amps(g_motor_job.jam.rms_counts);
     g_motor_job.last_voltage = voltage;
     g_motor_job.last_delta_v = delta_v;
     g_motor_job.last_adc = adcValue;
@@ -735,69 +936,52 @@ static void motor_job_tick(lv_timer_t* timer) {
         return;
     }
 
-    bool rawValue     = readPCF8574Pin(PIN_IR_RX);   // HIGH=intact, LOW=broken
-    bool rotarySwitch = readPCF8574Pin(PIN_ROTARY);  // HIGH=safe-to-stop
+    // One cached port snapshot serves both inputs (at most one I2C read per tick)
+    const uint8_t port = readPCF8574PortCached(NULL);
+    bool rawValue     = (port & (1 << PIN_IR_RX)) != 0;   // HIGH=intact, LOW=broken
+    bool rotarySwitch = (port & (1 << PIN_ROTARY)) != 0;  // HIGH=safe-to-stop
     bool beamBroken   = !rawValue;
 
     // Rotary motion detection
-    if (rotarySwitch != g_motor_job.lastRotary) {
-        g_motor_job.last_motion_ms = now;
-        g_motor_job.saw_motion_this_run = true;
-    }
+    const bool moved = rotarySwitch != g_motor_job.lastRotary;
+    if (moved) g_motor_job.jam.motion((uint32_t)now);
 
-    // ---------------------------------------------
-    // JAM PATH A: PRIMARY - no rotary movement
-    // Does NOT require current threshold.
-    // ---------------------------------------------
-    if (now >= g_motor_job.jam_rearm_after_ms &&
-        now >= g_motor_job.motion_arm_after_ms &&
-        !g_motor_job.treatDispensed) {
-
-        const bool no_motion_too_long =
-            ((now - g_motor_job.last_motion_ms) >= JAM_NO_MOTION_TIMEOUT_MS);
-
-        if (no_motion_too_long) {
-            Serial.printf("NO-MOTION JAM detected! noMotion=%lums I=%.2fA Ifilt=%.2fA Ipeak=%.2fA\r\n",
-                          (unsigned long)(now - g_motor_job.last_motion_ms),
-                          g_motor_job.inst_current_amps,
-                          g_motor_job.filtered_current_amps,
-                          g_motor_job.peak_current_amps);
-            start_unjam_reverse(now, "NO_MOTION");
-            return;
-        }
-    }
+    motor_trace_tick_inputs(TRACE_F_CHECKED |
+                            (rotarySwitch ? TRACE_F_ROTARY : 0) |
+                            (beamBroken ? TRACE_F_BEAM : 0) |
+                            (moved ? TRACE_F_MOTION : 0));
 
     // ---------------------------------------------
-    // JAM PATH B: SECONDARY - elevated filtered current
-    // Runs after rotary no-motion logic and uses startup blanking.
+    // JAM PATH A: PRIMARY - no rotary movement (does NOT require current threshold)
+    // JAM PATH B: SECONDARY - elevated filtered current, after A
+    // Both use startup blanking; see jam_detect.h.
     // ---------------------------------------------
-    if (now >= g_motor_job.jam_rearm_after_ms &&
-        now >= g_motor_job.motion_arm_after_ms) {
-
-        const bool filtered_over =
-            (g_motor_job.filtered_current_amps >= JAM_FILTERED_THRESHOLD_AMPS);
+    switch (g_motor_job.jam.check((uint32_t)now, g_motor_job.treatDispensed)) {
+    case JAM_NO_MOTION:
+        LOGW(JAM, "NO-MOTION JAM detected! noMotion=%lums I=%.2fA Ifilt=%.2fA Ipeak=%.2fA",
+                  (unsigned long)(now - g_motor_job.jam.last_motion_ms),
+                  g_motor_job.inst_current_amps,
+                  g_motor_job.filtered_current_amps,
+                  g_motor_job.peak_current_amps);
+        motor_trace_event(now_us, TRACE_EV_JAM_NO_MOTION, (uint16_t)(g_motor_job.jam_retries + 1));
+        // The wheel sat still for the whole detection window; that is no
+        // forward progress, so it must not use up the job timeout either.
+        g_motor_job.stalled_ms += now - g_motor_job.jam.last_motion_ms;
+        start_unjam_reverse(now, "NO_MOTION");
+        return;
 
-        if (filtered_over) {
-            if (g_motor_job.filtered_jam_start_ms == 0) {
-                g_motor_job.filtered_jam_start_ms = now;
-            }
-        } else {
-            g_motor_job.filtered_jam_start_ms = 0;
-        }
+    case JAM_FILTERED_CURRENT:
+        LOGW(JAM, "FILTERED-CURRENT JAM detected! Ifilt=%.2fA I=%.2fA Ipeak=%.2fA overFor=%lums",
+                  g_motor_job.filtered_current_amps,
+                  g_motor_job.inst_current_amps,
+                  g_motor_job.peak_current_amps,
+                  (unsigned long)(now - g_motor_job.jam.filtered_start_ms));
+        motor_trace_event(now_us, TRACE_EV_JAM_FILTERED, (uint16_t)(g_motor_job.jam_retries + 1));
+        start_unjam_reverse(now, "FILTERED_CURRENT");
+        return;
 
-        const bool filtered_jam_confirmed =
-            (g_motor_job.filtered_jam_start_ms != 0) &&
-            ((now - g_motor_job.filtered_jam_start_ms) >= JAM_FILTERED_CONFIRM_MS);
-
-        if (filtered_jam_confirmed) {
-            Serial.printf("FILTERED-CURRENT JAM detected! Ifilt=%.2fA I=%.2fA Ipeak=%.2fA overFor=%lums\r\n",
-                          g_motor_job.filtered_current_amps,
-                          g_motor_job.inst_current_amps,
-                          g_motor_job.peak_current_amps,
-                          (unsigned long)(now - g_motor_job.filtered_jam_start_ms));
-            start_unjam_reverse(now, "FILTERED_CURRENT");
-            return;
-        }
+    case JAM_NONE:
+        break;
     }
 
     if (!g_motor_job.treatDispensed && beamBroken) {
@@ -813,16 +997,21 @@ static void motor_job_tick(lv_timer_t* timer) {
         waitForNextHigh_AfterTreat = true;
         seenLowAfterTreat = g_motor_job.seenLowAfterTreat;
 
-        Serial.println("Beam broken! Treat dispensed.");
+        motor_trace_event(now_us, TRACE_EV_TREAT, 0);
+        LOGI(MOTOR, "Beam broken! Treat dispensed.");
     }
 
     if (!g_motor_job.treatDispensed) {
-        if (!g_motor_job.lastRotary && rotarySwitch) {
+        if (!g_motor_job.lastRotary && rotarySwitch && g_motor_job.lhReplay > 0) {
+            g_motor_job.lhReplay--;
+            LOGD(MOTOR, "Rotary LOW->HIGH re-crossed after unjam (not counted), %d left",
+                        g_motor_job.lhReplay);
+        } else if (!g_motor_job.lastRotary && rotarySwitch) {
             g_motor_job.lhTransitions++;
             lhTransitions = g_motor_job.lhTransitions;
+            motor_trace_event(now_us, TRACE_EV_ROTARY_LH, (uint16_t)g_motor_job.lhTransitions);
 
-            Serial.print("Rotary LOW->HIGH transitions: ");
-            Serial.println(g_motor_job.lhTransitions);
+            LOGD(MOTOR, "Rotary LOW->HIGH transitions: %d", g_motor_job.lhTransitions);
 
             if (g_motor_job.lhTransitions >= 3) {
                 g_motor_job.stopRequested_NoTreat = true;
@@ -839,7 +1028,7 @@ static void motor_job_tick(lv_timer_t* timer) {
             }
         } else {
             if (rotarySwitch) {
-                Serial.println("Stopping at NEXT HIGH after treat dispense.");
+                LOGI(MOTOR, "Stopping at NEXT HIGH after treat dispense.");
                 motor_job_finish(STOP_TREAT_NEXT_HIGH);
                 return;
             }
@@ -847,7 +1036,7 @@ static void motor_job_tick(lv_timer_t* timer) {
     }
 
     if (g_motor_job.stopRequested_NoTreat && rotarySwitch) {
-        Serial.println("No treat after 3 LOW->HIGH transitions. Stopping at HIGH.");
+        LOGI(MOTOR, "No treat after 3 LOW->HIGH transitions. Stopping at HIGH.");
         motor_job_finish(STOP_NO_TREAT_3_TRANSITIONS);
         return;
     }
@@ -860,10 +1049,9 @@ static void motor_job_tick(lv_timer_t* timer) {
 // IR Remote (P7 active-low) -> start foot-switch training ANYTIME
 // =====================================================
 static lv_timer_t* remote_poll_timer = NULL;
+static bool remote_settling = false;  // P7 differs from its debounced state
 
-static inline bool remote_p7_edge_pressed(unsigned long now_ms) {
-    bool raw = !readPCF8574Pin(PIN_REMOTE); // active-low, pressed = true
-
+static inline bool remote_p7_edge_pressed(unsigned long now_ms, bool raw) {
     static bool last_raw = false;
     static bool stable_state = false;
     static unsigned long last_change_ms = 0;
@@ -873,23 +1061,23 @@ static inline bool remote_p7_edge_pressed(unsigned long now_ms) {
         last_change_ms = now_ms;
     }
 
+    bool pressed = false;
     if ((now_ms - last_change_ms) >= REMOTE_DEBOUNCE_MS) {
         if (stable_state != raw) {
             bool previous_stable = stable_state;
             stable_state = raw;
-            if (stable_state && !previous_stable) {
-                return true;
-            }
+            pressed = stable_state && !previous_stable;
         }
     }
 
-    return false;
+    remote_settling = (stable_state != raw);
+    return pressed;
 }
 
 static void cancel_footswitch_training_window() {
     if (!foot_train_active && !foot_train_timer) return;
 
-    Serial.println("Foot-switch training window CANCELLED");
+    LOGI(TRAIN, "Foot-switch training window CANCELLED");
 
     foot_train_active = false;
 
@@ -903,9 +1091,9 @@ static void cancel_footswitch_training_window() {
 }
 
 static void start_footswitch_training_window() {
-    if (foot_train_active || foot_train_timer || g_motor_job.active) return;
+    if (foot_train_active || foot_train_timer || motor_job_busy()) return;
 
-    Serial.println("Foot-switch training window STARTED (remote/UI)");
+    LOGI(TRAIN, "Foot-switch training window STARTED (remote/UI)");
 
     initPCF8574Pins();
     full_stop();
@@ -923,61 +1111,36 @@ static void start_footswitch_training_window() {
 
     foot_train_timer = lv_timer_create(footswitch_train_tick, 50, NULL);
 
-    Serial.printf("Training LED: PIN_LED=%d read=%d (LOW=ON if active-low)\n",
-                  (int)PIN_LED, (int)readPCF8574Pin(PIN_LED));
+    LOGD(TRAIN, "Training LED: PIN_LED=%d read=%d (LOW=ON if active-low)",
+                (int)PIN_LED, (int)readPCF8574Pin(PIN_LED));
 }
 
 static void remote_poll_tick(lv_timer_t* t) {
-    (void)t;
+    static uint32_t seen_seq = 0;
+    const unsigned long period_ms = remote_settling ? REMOTE_POLL_INTERVAL_MS : REMOTE_IDLE_POLL_MS;
+    const uint8_t port = readPCF8574PortMaxAge(period_ms * 1000UL);
+
+    // No input bit changed since the last pass and nothing is being debounced
+    const uint32_t seq = getPCF8574InputSeq();
+    if (seq == seen_seq && !remote_settling) return;
+    seen_seq = seq;
+
     unsigned long now = millis();
-    if (remote_p7_edge_pressed(now)) {
-        Serial.println("IR Remote (P7) pressed -> start training");
+    if (remote_p7_edge_pressed(now, !(port & (1 << PIN_REMOTE)))) { // active-low, pressed = true
+        LOGI(TRAIN, "IR Remote (P7) pressed -> start training");
         start_footswitch_training_window();
     }
+    lv_timer_set_period(t, remote_settling ? REMOTE_POLL_INTERVAL_MS : REMOTE_IDLE_POLL_MS);
 }
 
 static void ensure_remote_poll_timer_running() {
     if (!remote_poll_timer) {
         setPCF8574Pin(PIN_REMOTE, false); // release pin for input
-        remote_poll_timer = lv_timer_create(remote_poll_tick, REMOTE_POLL_INTERVAL_MS, NULL);
-        Serial.printf("Remote poll timer started (P7 training trigger), poll=%lu ms, debounce=%lu ms\r\n",
-                      (unsigned long)REMOTE_POLL_INTERVAL_MS,
-                      (unsigned long)REMOTE_DEBOUNCE_MS);
-    }
-}
-
-// ---------------------------
-// UI updater
-// ---------------------------
-extern "C" void update_schedule_3_ui() {
-    if (objects.treats_per_hour) {
-        char treats_str[10];
-        snprintf(treats_str, sizeof(treats_str), "%d", selected_treats_number);
-        lv_label_set_text(objects.treats_per_hour, treats_str);
-    }
-
-    if (objects.treats_dispensed) {
-        char dispensed_str[10];
-        snprintf(dispensed_str, sizeof(dispensed_str), "%d", schedule_treats_dispensed);
-        lv_label_set_text(objects.treats_dispensed, dispensed_str);
-    }
-
-    if (objects.schedule_time_left) {
-        char time_str[10];
-        if (schedule_is_running) {
-            int hours = schedule_remaining_minutes / 60;
-            int minutes = schedule_remaining_minutes % 60;
-            snprintf(time_str, sizeof(time_str), "%d:%02d", hours, minutes);
-        } else {
-            snprintf(time_str, sizeof(time_str), "%d:00", selected_hours_to_dispense);
-        }
-        lv_label_set_text(objects.schedule_time_left, time_str);
-    }
-
-    unsigned long now = millis();
-    if (every_30s(now)) {
-        Serial.printf("Updated Schedule UI: treats/hr=%d, dispensed=%d, hours=%d, remaining_min=%d\n",
-                      selected_treats_number, schedule_treats_dispensed, selected_hours_to_dispense, schedule_remaining_minutes);
+        remote_poll_timer = lv_timer_create(remote_poll_tick, REMOTE_IDLE_POLL_MS, NULL);
+        LOGI(TRAIN, "Remote poll timer started (P7 training trigger), poll=%lu/%lu ms (idle/settling), debounce=%lu ms",
+                    (unsigned long)REMOTE_IDLE_POLL_MS,
+                    (unsigned long)REMOTE_POLL_INTERVAL_MS,
+                    (unsigned long)REMOTE_DEBOUNCE_MS);
     }
 }
 
@@ -985,72 +1148,28 @@ extern "C" void update_schedule_3_ui() {
 // Schedule generation
 // ---------------------------
 static void generate_schedule_times() {
-    total_scheduled_treats = 0;
     current_treat_index = 0;
 
-    int treats_per_hour = selected_treats_number;
-    int total_hours     = selected_hours_to_dispense;
-
-    if (treats_per_hour < 2) treats_per_hour = 2;
-
-    int reliable_per_hour = (treats_per_hour + 1) / 2;
-    int random_per_hour   = treats_per_hour / 2;
-    int spacing = 60 / reliable_per_hour;
-
-    for (int hour = 0; hour < total_hours; hour++) {
-        int hour_offset = hour * 60;
-
-        for (int k = 0; k < reliable_per_hour; k++) {
-            int t = k * spacing;
-            if (t >= 60) t = 59;
-            scheduled_times[total_scheduled_treats++] = hour_offset + t;
-        }
+    plan_params_t params;
+    params.dist = (plan_dist_t)SCHEDULE_DISTRIBUTION;
+    params.treats_per_hour = (uint16_t)schedule_selected_treats();
+    params.hours = (uint16_t)schedule_selected_hours();
+    params.min_gap_s = SCHEDULE_MIN_GAP_S;
+    params.seed = SCHEDULE_SEED;
 
-        for (int r = 0; r < random_per_hour; r++) {
-            bool valid = false;
-            int attempts = 0;
-            int t = 0;
-
-            while (!valid && attempts < 100) {
-                t = random() % 60;
-                valid = true;
-
-                for (int j = 0; j < total_scheduled_treats; j++) {
-                    int existing = scheduled_times[j];
-                    if (existing >= hour_offset && existing < hour_offset + 60) {
-                        int existing_min = existing - hour_offset;
-                        if (abs(existing_min - t) < 1) {
-                            valid = false;
-                            break;
-                        }
-                    }
-                }
-                attempts++;
-            }
-
-            if (valid) {
-                scheduled_times[total_scheduled_treats++] = hour_offset + t;
-            } else {
-                scheduled_times[total_scheduled_treats++] = hour_offset + (59 - r);
-            }
-        }
-    }
-
-    for (int i = 0; i < total_scheduled_treats - 1; i++) {
-        for (int j = i + 1; j < total_scheduled_treats; j++) {
-            if (scheduled_times[i] > scheduled_times[j]) {
-                int tmp = scheduled_times[i];
-                scheduled_times[i] = scheduled_times[j];
-                scheduled_times[j] = tmp;
-            }
-        }
+    if (!schedule_plan_build(&params, &schedule_plan)) {
+        LOGW(SCHED, "Schedule plan failed (%u/hr x %u h)",
+                    (unsigned)params.treats_per_hour, (unsigned)params.hours);
+        return;
     }
 
-    Serial.println("=== Generated Schedule ===");
-    for (int i = 0; i < total_scheduled_treats; i++) {
-        int h = scheduled_times[i] / 60;
-        int m = scheduled_times[i] % 60;
-        Serial.printf("Treat %d: %d:%02d\n", i + 1, h, m);
+    LOGI(SCHED, "=== Generated Schedule (%s, seed %lu, %u treats) ===",
+                schedule_plan_dist_name(schedule_plan.dist), (unsigned long)schedule_plan.seed,
+                (unsigned)schedule_plan.count);
+    for (uint16_t i = 0; i < schedule_plan.count; i++) {
+        const uint32_t t = schedule_plan.at_s[i];
+        LOGI(SCHED, "Treat %u: %lu:%02lu:%02lu", (unsigned)(i + 1),
+                    (unsigned long)(t / 3600), (unsigned long)(t / 60 % 60), (unsigned long)(t % 60));
     }
 }
 
@@ -1061,57 +1180,51 @@ static bool legacy_train_job_done = false;
 static MotorStopReason legacy_train_reason = STOP_TIMEOUT;
 
 static void training_motor_done_cb(MotorStopReason reason) {
-    full_stop();
+    led_set_solid(false);  // motor and IR already stopped by motor_job_finish()
     play_jam_warning_if_needed(reason);
-    Serial.print("Foot-switch dispense stop reason: ");
-    Serial.println((int)reason);
+    LOGI(TRAIN, "Foot-switch dispense stop reason: %d", (int)reason);
 }
 
 static void manual_dispense_done_cb(MotorStopReason reason) {
-    stop_motor_ir_and_hold_led_if_needed(g_motor_job.led_on_start_ms, 5000UL);
+    finish_with_led_min_on_time(g_motor_job.led_on_start_ms, 5000UL);
     play_jam_warning_if_needed(reason);
-    Serial.print("Manual stop reason: ");
-    Serial.println((int)reason);
-    Serial.println("=== Manual Treat Dispense Complete ===\n");
+    LOGI(SYS, "Manual stop reason: %d", (int)reason);
+    LOGI(SYS, "=== Manual Treat Dispense Complete ===");
 }
 
 static void schedule_treat1_done_cb(MotorStopReason reason) {
-    stop_motor_ir_and_hold_led_if_needed(g_motor_job.led_on_start_ms, 5000UL);
+    finish_with_led_min_on_time(g_motor_job.led_on_start_ms, 5000UL);
     play_jam_warning_if_needed(reason);
 
-    Serial.print("Schedule #1 stop reason: ");
-    Serial.println((int)reason);
+    LOGI(SCHED, "Schedule #1 stop reason: %d", (int)reason);
 
     if (reason == STOP_EXTERNAL_REQUEST) {
-        Serial.println("Schedule stopped by user during treat #1; not incrementing counters.");
+        LOGI(SCHED, "Schedule stopped by user during treat #1; not incrementing counters.");
         return;
     }
 
-    schedule_treats_dispensed++;
-    update_schedule_3_ui();
+    schedule_set_treats_dispensed(schedule_treats_dispensed() + 1);
     current_treat_index++;
 }
 
 static void schedule_footswitch_done_cb(MotorStopReason reason) {
-    full_stop();
+    led_set_solid(false);  // motor and IR already stopped by motor_job_finish()
     play_jam_warning_if_needed(reason);
 
-    Serial.print("Schedule foot-switch stop reason: ");
-    Serial.println((int)reason);
+    LOGI(SCHED, "Schedule foot-switch stop reason: %d", (int)reason);
 
     if (reason == STOP_EXTERNAL_REQUEST) {
-        Serial.println("Schedule stopped by user during foot-switch dispense; not incrementing counters.");
+        LOGI(SCHED, "Schedule stopped by user during foot-switch dispense; not incrementing counters.");
         return;
     }
 
-    schedule_treats_dispensed++;
-    update_schedule_3_ui();
+    schedule_set_treats_dispensed(schedule_treats_dispensed() + 1);
     current_treat_index++;
     led_set_solid(false);
 }
 
 static void legacy_train_done_cb(MotorStopReason reason) {
-    full_stop();
+    led_set_solid(false);  // motor and IR already stopped by motor_job_finish()
     play_jam_warning_if_needed(reason);
     legacy_train_reason = reason;
     legacy_train_job_done = true;
@@ -1121,16 +1234,16 @@ static void legacy_train_done_cb(MotorStopReason reason) {
 // Scheduled treat helpers
 // ---------------------------
 static bool schedule_dispense_manual_sequence_now(volatile bool* stop_flag) {
-    if (g_motor_job.active) {
-        Serial.println("Schedule treat #1 ignored: motor job already active.");
+    if (motor_job_busy()) {
+        LOGI(SCHED, "Schedule treat #1 ignored: motor job already active.");
         return false;
     }
 
-    Serial.println("Schedule treat #1: manual-sequence dispense");
+    LOGI(SCHED, "Schedule treat #1: manual-sequence dispense");
 
     const unsigned long led_on_start = millis();
     led_set_solid(true);
-    audio_play_tone_1s();
+    play_dispense_sound();
 
     start_async_motor_job(TRAIN_MOTOR_RUN_MS,
                           led_on_start,
@@ -1141,12 +1254,12 @@ static bool schedule_dispense_manual_sequence_now(volatile bool* stop_flag) {
 }
 
 static bool schedule_dispense_now_on_footswitch(volatile bool* stop_flag) {
-    if (g_motor_job.active) {
-        Serial.println("Schedule foot-switch dispense ignored: motor job already active.");
+    if (motor_job_busy()) {
+        LOGI(SCHED, "Schedule foot-switch dispense ignored: motor job already active.");
         return false;
     }
 
-    Serial.println("Schedule: foot-switch dispense NOW");
+    LOGI(SCHED, "Schedule: foot-switch dispense NOW");
 
     full_stop();
     led_set_solid(true);
@@ -1160,7 +1273,7 @@ static bool schedule_dispense_now_on_footswitch(volatile bool* stop_flag) {
 }
 
 static void schedule_dispense_treat() {
-    Serial.println("=== Schedule Treat Trigger ===");
+    LOGI(SCHED, "=== Schedule Treat Trigger ===");
 
     if (current_treat_index == 0) {
         (void)schedule_dispense_manual_sequence_now(&schedule_stop_requested);
@@ -1168,7 +1281,63 @@ static void schedule_dispense_treat() {
         schedule_waiting_for_footswitch = true;
         schedule_wait_start_ms = millis();
         schedule_last_tone_ms  = schedule_wait_start_ms - 5000UL;
-        Serial.printf("Schedule treat %d: waiting for FOOT SWITCH (20s)\n", current_treat_index + 1);
+        LOGI(SCHED, "Schedule treat %d: waiting for FOOT SWITCH (20s)", current_treat_index + 1);
+    }
+}
+
+// ---------------------------
+// Schedule deadlines
+// schedule_timer is a single one-shot: it is armed for whichever is due first (the
+// next treat, the next minute of the countdown, or the end of the run) and re-armed
+// after each fire. Between deadlines the schedule costs nothing and the UI loop can
+// sleep. Motor job completions re-arm it (actions_poll_events), so a treat that came
+// due while the motor was busy is picked up as soon as the job ends.
+// ---------------------------
+static void schedule_timer_tick(lv_timer_t * timer);
+
+// Milliseconds from now until the schedule next needs the CPU
+static unsigned long schedule_next_deadline_ms(unsigned long now) {
+    // The foot-switch window is the one place that still polls: PCF inputs only
+    // read on demand, and the window is 20 s long at most
+    if (schedule_waiting_for_footswitch) return SCHEDULE_FOOTSWITCH_POLL_MS;
+
+    const unsigned long elapsed = now - schedule_start_time;
+    const unsigned long end_ms = (unsigned long)schedule_selected_hours() * 3600000UL;
+    unsigned long due = (elapsed / 60000UL + 1UL) * 60000UL;   // next countdown minute
+    if (end_ms < due) due = end_ms;
+
+    if (!motor_job_busy() && current_treat_index < schedule_plan.count) {
+        const unsigned long treat_ms = (unsigned long)schedule_plan.at_s[current_treat_index] * 1000UL;
+        if (treat_ms < due) due = treat_ms;
+    }
+    return due > elapsed ? due - elapsed : 0;
+}
+
+static void schedule_rearm() {
+    lv_timer_t* t = (lv_timer_t*)schedule_timer;
+    if (t == NULL) return;
+    if (!schedule_running() || schedule_paused()) {
+        lv_timer_pause(t);
+        return;
+    }
+    const unsigned long delay_ms = schedule_next_deadline_ms(millis());
+    lv_timer_set_period(t, delay_ms ? (uint32_t)delay_ms : 1);
+    lv_timer_reset(t);
+    lv_timer_resume(t);
+}
+
+static void schedule_timer_begin() {
+    if (schedule_timer != NULL) {
+        lv_timer_del((lv_timer_t*)schedule_timer);
+    }
+    schedule_timer = lv_timer_create(schedule_timer_tick, 1, NULL);
+    lv_timer_pause((lv_timer_t*)schedule_timer);
+}
+
+static void schedule_timer_end() {
+    if (schedule_timer != NULL) {
+        lv_timer_del((lv_timer_t*)schedule_timer);
+        schedule_timer = NULL;
     }
 }
 
@@ -1178,147 +1347,131 @@ static void schedule_dispense_treat() {
 static void schedule_timer_tick(lv_timer_t * timer) {
     (void)timer;
 
-    if (!schedule_is_running || schedule_is_paused) return;
+    if (!schedule_running() || schedule_paused()) {
+        schedule_rearm();
+        return;
+    }
 
     unsigned long now = millis();
 
     if (schedule_stop_requested) {
-        schedule_is_running = false;
+        schedule_set_running(false);
         schedule_waiting_for_footswitch = false;
         schedule_stop_requested = false;
 
         full_stop();
+        schedule_timer_end();
 
-        if (schedule_timer != NULL) {
-            lv_timer_del((lv_timer_t*)schedule_timer);
-            schedule_timer = NULL;
-        }
-
-        Serial.println("=== Schedule STOPPED by user ===");
+        LOGI(SCHED, "=== Schedule STOPPED by user ===");
         return;
     }
 
     if (schedule_waiting_for_footswitch) {
+        beginPCF8574Outputs();
         setPCF8574Pin(PIN_MOTOR_IN1, false);
         setPCF8574Pin(PIN_MOTOR_IN2, false);
-
         led_set_solid(true);
+        commitPCF8574Outputs();
 
         if (now - schedule_last_tone_ms >= 5000UL) {
             schedule_last_tone_ms = now;
-            audio_play_tone_1s();
+            play_cue_tone();
         }
 
         if (now - schedule_wait_start_ms >= 20000UL) {
-            Serial.printf("Schedule treat %d: foot-switch TIMEOUT -> skipping\n", current_treat_index + 1);
+            LOGI(SCHED, "Schedule treat %d: foot-switch TIMEOUT -> skipping", current_treat_index + 1);
             schedule_waiting_for_footswitch = false;
             led_set_solid(false);
             current_treat_index++;
-            return;
-        }
-
-        if (footswitch_pressed_debounced(now) && !g_motor_job.active) {
-            Serial.printf("Schedule treat %d: foot-switch PRESSED -> dispensing\n", current_treat_index + 1);
+        } else if (footswitch_pressed_debounced(now) && !motor_job_busy()) {
+            LOGI(SCHED, "Schedule treat %d: foot-switch PRESSED -> dispensing", current_treat_index + 1);
             schedule_waiting_for_footswitch = false;
             (void)schedule_dispense_now_on_footswitch(&schedule_stop_requested);
-            return;
         }
 
+        schedule_rearm();
         return;
     }
 
     unsigned long elapsed_total = now - schedule_start_time;
     int elapsed_minutes = (int)(elapsed_total / 60000UL);
 
-    int total_minutes = selected_hours_to_dispense * 60;
-    schedule_remaining_minutes = total_minutes - elapsed_minutes;
-    if (schedule_remaining_minutes < 0) schedule_remaining_minutes = 0;
+    int remaining_minutes = schedule_selected_hours() * 60 - elapsed_minutes;
+    if (remaining_minutes < 0) remaining_minutes = 0;
+    schedule_set_remaining_minutes(remaining_minutes);   // redraws only on a new minute
 
-    if (schedule_remaining_minutes != schedule_last_displayed_minutes) {
-        schedule_last_displayed_minutes = schedule_remaining_minutes;
-        update_schedule_3_ui();
-    }
-
-    if (schedule_remaining_minutes <= 0 || current_treat_index >= total_scheduled_treats) {
-        schedule_is_running = false;
-        schedule_remaining_minutes = 0;
+    if (remaining_minutes <= 0 || current_treat_index >= schedule_plan.count) {
+        schedule_set_running(false);
+        schedule_set_remaining_minutes(0);
 
         full_stop();
+        schedule_timer_end();
 
-        if (schedule_timer != NULL) {
-            lv_timer_del((lv_timer_t*)schedule_timer);
-            schedule_timer = NULL;
-        }
-
-        Serial.println("=== Schedule Complete ===");
+        LOGI(SCHED, "=== Schedule Complete ===");
         return;
     }
 
-    static unsigned long last_dispense_time = 0;
-    static bool dispense_in_progress = false;
+    // A minute boundary fires here too; only dispense once the treat is actually due.
+    // Spacing between treats is the plan's job (SCHEDULE_MIN_GAP_S).
+    if (!motor_job_busy()) {
+        const uint32_t elapsed_s = (uint32_t)(elapsed_total / 1000UL);
+        const uint32_t next_treat_s = schedule_plan.at_s[current_treat_index];
 
-    if (!g_motor_job.active && current_treat_index < total_scheduled_treats) {
-        int next_treat_time = scheduled_times[current_treat_index];
+        if (elapsed_s >= next_treat_s) {
+            LOGI(SCHED, "TRIGGER schedule treat: idx=%d (treat=%d), now=%lu s, scheduled=%lu s",
+                        current_treat_index, current_treat_index + 1,
+                        (unsigned long)elapsed_s, (unsigned long)next_treat_s);
 
-        if (schedule_is_running && current_treat_index == 1 && every_30s(now)) {
-            Serial.printf("Checking treat 2: current_time=%d min, scheduled=%d min\n",
-                          elapsed_minutes, next_treat_time);
-        }
-
-        if (elapsed_minutes >= next_treat_time) {
-            if (!dispense_in_progress && (now - last_dispense_time >= 30000UL)) {
-                dispense_in_progress = true;
-                last_dispense_time = now;
-
-                Serial.printf("TRIGGER schedule treat: idx=%d (treat=%d), now=%d min, scheduled=%d min\n",
-                              current_treat_index, current_treat_index + 1, elapsed_minutes, next_treat_time);
-
-                schedule_dispense_treat();
-
-                dispense_in_progress = false;
-            }
+            schedule_dispense_treat();
         }
     }
+
+    schedule_rearm();
 }
 
 // ---------------------------
-// Jam warning tone
-// High-pitched blocking 5-beep alert used only on terminal jam.
+// Cue tone
+// Appended to the audio queue, so it never cuts off a jam alert in progress.
 // ---------------------------
-static void play_square_tone_blocking(uint16_t freq_hz,
-                                      uint8_t amplitude,
-                                      unsigned long duration_ms) {
-    if (freq_hz == 0 || duration_ms == 0) return;
-
-    dac_output_enable(DAC_CHANNEL_2);
+static const audio_step_t CUE_TONE_STEP = {
+    (uint16_t)CUE_TONE_FREQ_HZ,
+    (uint8_t)CUE_TONE_DAC_AMPLITUDE,
+    1,
+    (uint16_t)CUE_TONE_MS,
+    0
+};
 
-    const unsigned long half_period_us = 1000000UL / ((unsigned long)freq_hz * 2UL);
-    const unsigned long total_cycles = ((unsigned long)freq_hz * duration_ms) / 1000UL;
+static void play_cue_tone() {
+    audio_play_pattern(&CUE_TONE_STEP, 1);
+}
 
-    for (unsigned long i = 0; i < total_cycles; ++i) {
-        dac_output_voltage(DAC_CHANNEL_2, amplitude);
-        delayMicroseconds(half_period_us);
-        dac_output_voltage(DAC_CHANNEL_2, 0);
-        delayMicroseconds(half_period_us);
+// Dispense sound: WAV_FILE streamed from SD; audio_task falls back to the
+// cue tone if the card or file is missing or unreadable.
+static void play_dispense_sound() {
+    if (!audio_play_wav(WAV_FILE, &CUE_TONE_STEP)) {
+        play_cue_tone();
     }
-
-    dac_output_voltage(DAC_CHANNEL_2, 0);
 }
 
+// ---------------------------
+// Jam warning tone
+// High-pitched 5-beep alert used only on terminal jam.
+// Queued on audio_task as one pattern step; returns immediately.
+// ---------------------------
 static void play_jam_warning_5x() {
-    Serial.println("Playing terminal JAM warning tone (5 beeps).");
-
-    for (int i = 0; i < JAM_WARNING_BEEP_COUNT; ++i) {
-        play_square_tone_blocking((uint16_t)JAM_WARNING_FREQ_HZ,
-                                  (uint8_t)JAM_WARNING_DAC_AMPLITUDE,
-                                  JAM_WARNING_BEEP_ON_MS);
-
-        if (i < (JAM_WARNING_BEEP_COUNT - 1)) {
-            delay(JAM_WARNING_BEEP_OFF_MS);
-        }
-    }
-
-    dac_output_voltage(DAC_CHANNEL_2, 0);
+    LOGI(AUDIO, "Playing terminal JAM warning tone (5 beeps).");
+
+    static const audio_step_t jam_alert = {
+        (uint16_t)JAM_WARNING_FREQ_HZ,
+        (uint8_t)JAM_WARNING_DAC_AMPLITUDE,
+        (uint8_t)JAM_WARNING_BEEP_COUNT,
+        (uint16_t)JAM_WARNING_BEEP_ON_MS,
+        (uint16_t)JAM_WARNING_BEEP_OFF_MS
+    };
+
+    // The alarm pre-empts any training/dispense tone still playing
+    audio_stop();
+    audio_play_pattern(&jam_alert, 1);
 }
 
 static void play_jam_warning_if_needed(MotorStopReason reason) {
@@ -1333,26 +1486,30 @@ static void play_jam_warning_if_needed(MotorStopReason reason) {
 extern "C" void init_audio() {
     dac_output_enable(DAC_CHANNEL_2);
     dac_output_voltage(DAC_CHANNEL_2, 0);
-    Serial.println("DAC audio initialized on GPIO 26 (DAC_CHANNEL_2)");
+    LOGI(AUDIO, "DAC audio initialized on GPIO 26 (DAC_CHANNEL_2)");
 }
 
 // ---------------------------
 // Motor/IR control
 // ---------------------------
 extern "C" void full_stop() {
+    beginPCF8574Outputs();
     setPCF8574Pin(PIN_MOTOR_IN1, false);
     setPCF8574Pin(PIN_MOTOR_IN2, false);
-
     led_set_solid(false);
     setPCF8574Pin(PIN_IR_TX, true);
+    commitPCF8574Outputs();
 
-    Serial.println("Full stop: Motor and LED OFF");
+    LOGD(MOTOR, "Full stop: Motor and LED OFF");
 }
 
 extern "C" void Motor_Start() {
+    // Single write: IN2 drops in the same transaction IN1 rises (no IN1+IN2 HIGH)
+    beginPCF8574Outputs();
     setPCF8574Pin(PIN_MOTOR_IN1, true);
     setPCF8574Pin(PIN_MOTOR_IN2, false);
-    Serial.println("Motor ON (CW)");
+    commitPCF8574Outputs();
+    LOGD(MOTOR, "Motor ON (CW)");
 }
 
 static bool beam_initial_state = true;
@@ -1362,14 +1519,13 @@ extern "C" void IR_Start() {
     led_set_solid(true);
     setPCF8574Pin(PIN_IR_TX, false);
     beam_initial_state = read_beam();
-    Serial.print("IR Start requested - initial beam: ");
-    Serial.println(beam_initial_state ? "HIGH" : "LOW");
+    LOGD(MOTOR, "IR Start requested - initial beam: %s", beam_initial_state ? "HIGH" : "LOW");
 }
 
 extern "C" void IR_Stop() {
     led_set_solid(false);
     setPCF8574Pin(PIN_IR_TX, true);
-    Serial.println("IR transmitter OFF");
+    LOGD(MOTOR, "IR transmitter OFF");
 }
 
 // ---------------------------
@@ -1388,14 +1544,15 @@ static void footswitch_train_tick(lv_timer_t* timer) {
         return;
     }
 
+    beginPCF8574Outputs();
     setPCF8574Pin(PIN_MOTOR_IN1, false);
     setPCF8574Pin(PIN_MOTOR_IN2, false);
-
     led_set_solid(true);
+    commitPCF8574Outputs();
 
     if (now - foot_train_last_tone_ms >= 5000UL) {
         foot_train_last_tone_ms = now;
-        audio_play_tone_1s();
+        play_cue_tone();
     }
 
     if (now < foot_train_armed_after_ms) {
@@ -1403,14 +1560,14 @@ static void footswitch_train_tick(lv_timer_t* timer) {
     }
 
     if (now - foot_train_start_ms >= 20000UL) {
-        Serial.println("Foot-switch training: TIMEOUT (no treat dispensed).");
+        LOGI(TRAIN, "Foot-switch training: TIMEOUT (no treat dispensed).");
         foot_train_active = false;
         cancel_footswitch_training_window();
         return;
     }
 
-    if (footswitch_pressed_debounced(now) && !g_motor_job.active) {
-        Serial.println("Foot-switch training: PRESSED -> dispensing 1 treat.");
+    if (footswitch_pressed_debounced(now) && !motor_job_busy()) {
+        LOGI(TRAIN, "Foot-switch training: PRESSED -> dispensing 1 treat.");
 
         foot_train_active = false;
         if (foot_train_timer) {
@@ -1437,7 +1594,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
         led_set_solid(false);
         lv_timer_del(timer);
         train_dispense_state = 0;
-        Serial.println("=== Train Dispense STOPPED ===");
+        LOGI(TRAIN, "=== Train Dispense STOPPED ===");
         return;
     }
 
@@ -1449,7 +1606,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
         case 0: {
             led_set_solid(true);
             static bool audio0 = false;
-            if (!audio0) { audio_play_tone_1s(); audio0 = true; }
+            if (!audio0) { play_cue_tone(); audio0 = true; }
 
             if (edge_pressed) {
                 train_dispense_state = 10;
@@ -1478,7 +1635,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
         case 2: {
             led_set_solid(true);
             static bool audio2 = false;
-            if (!audio2) { audio_play_tone_1s(); audio2 = true; }
+            if (!audio2) { play_cue_tone(); audio2 = true; }
 
             if (edge_pressed) {
                 train_dispense_state = 10;
@@ -1497,7 +1654,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
 
         case 3: {
             static bool audiob = false;
-            if (!audiob) { audio_play_tone_1s(); audiob = true; }
+            if (!audiob) { play_cue_tone(); audiob = true; }
 
             if (edge_pressed) {
                 train_dispense_state = 10;
@@ -1516,7 +1673,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
         }
 
         case 10: {
-            if (g_motor_job.active) break;
+            if (motor_job_busy()) break;
 
             led_blink_mode = false;
             led_set_solid(true);
@@ -1535,8 +1692,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
 
         case 11: {
             if (legacy_train_job_done) {
-                Serial.print("Train stop reason: ");
-                Serial.println((int)legacy_train_reason);
+                LOGI(TRAIN, "Train stop reason: %d", (int)legacy_train_reason);
                 train_dispense_state = 99;
             }
             break;
@@ -1547,7 +1703,7 @@ static void train_dispense_tick(lv_timer_t * timer) {
             led_set_solid(false);
             lv_timer_del(timer);
             train_dispense_state = 0;
-            Serial.println("=== Train Dispense Complete ===");
+            LOGI(TRAIN, "=== Train Dispense Complete ===");
             break;
         }
     }
@@ -1558,34 +1714,39 @@ static void train_dispense_tick(lv_timer_t * timer) {
 // ---------------------------
 extern "C" void actions_init() {
     Wire.setClock(400000);
+    current_sense_begin();
+    ensure_motor_task_running();
     ensure_remote_poll_timer_running();
-    Serial.printf("Current config: ZERO=%.3fV SENS=%.3fV/A AVG=%d FILTER_ALPHA=%.2f NO_MOTION_START=%lu NO_MOTION_TIMEOUT=%lu IFILT_JAM=%.2f IFILT_CONFIRM=%lu JAM_BEEPS=%d JAM_FREQ=%u\r\n",
-                  ZERO_CURRENT_VOLTAGE,
-                  SENSITIVITY,
-                  (int)CURRENT_SENSOR_AVG_SAMPLES,
-                  (float)CURRENT_FILTER_ALPHA,
-                  (unsigned long)JAM_NO_MOTION_STARTUP_MS,
-                  (unsigned long)JAM_NO_MOTION_TIMEOUT_MS,
-                  (float)JAM_FILTERED_THRESHOLD_AMPS,
-                  (unsigned long)JAM_FILTERED_CONFIRM_MS,
-                  (int)JAM_WARNING_BEEP_COUNT,
-                  (unsigned int)JAM_WARNING_FREQ_HZ);
+    LOGI(SYS, "Current config: ZERO=%.3fV SENS=%.3fV/A AVG=%d DMA_HZ=%lu DSP=med%d/iir%d NO_MOTION_START=%lu NO_MOTION_TIMEOUT=%lu IFILT_JAM=%.2f/%.2f IFILT_CONFIRM=%lu JAM_BEEPS=%d JAM_FREQ=%u",
+              ZERO_CURRENT_VOLTAGE,
+              SENSITIVITY,
+              (int)CURRENT_SENSOR_AVG_SAMPLES,
+              (unsigned long)current_sense_sample_rate_hz(),
+              (int)JAM_DSP_MEDIAN_N,
+              (int)JAM_DSP_IIR_SHIFT,
+              (unsigned long)JAM_NO_MOTION_STARTUP_MS,
+              (unsigned long)JAM_NO_MOTION_TIMEOUT_MS,
+              (float)JAM_FILTERED_THRESHOLD_AMPS,
+              (float)JAM_FILTERED_RELEASE_AMPS,
+              (unsigned long)JAM_FILTERED_CONFIRM_MS,
+              (int)JAM_WARNING_BEEP_COUNT,
+              (unsigned int)JAM_WARNING_FREQ_HZ);
 }
 
 // Manual treat behavior
 extern "C" void action_manual_dispense_treat(lv_event_t * e) {
     (void)e;
 
-    if (g_motor_job.active) {
-        Serial.println("Manual dispense ignored: motor job already active.");
+    if (motor_job_busy()) {
+        LOGI(SYS, "Manual dispense ignored: motor job already active.");
         return;
     }
 
-    Serial.println("\n=== Manual Treat Dispense Started ===");
+    LOGI(SYS, "=== Manual Treat Dispense Started ===");
 
     const unsigned long led_on_start = millis();
     led_set_solid(true);
-    audio_play_tone_1s();
+    play_dispense_sound();
 
     start_async_motor_job(TRAIN_MOTOR_RUN_MS,
                           led_on_start,
@@ -1596,14 +1757,14 @@ extern "C" void action_manual_dispense_treat(lv_event_t * e) {
 
 extern "C" void action_train_dispense_treat(lv_event_t * e) {
     (void)e;
-    Serial.println("=== Training Mode START (footswitch window) ===");
+    LOGI(TRAIN, "=== Training Mode START (footswitch window) ===");
     ensure_remote_poll_timer_running();
     start_footswitch_training_window();
 }
 
 extern "C" void action_train_dispense_stop(lv_event_t * e) {
     (void)e;
-    Serial.println("=== Training Mode STOP requested ===");
+    LOGI(TRAIN, "=== Training Mode STOP requested ===");
     cancel_footswitch_training_window();
     train_dispense_stop_requested = true;
     full_stop();
@@ -1616,109 +1777,100 @@ extern "C" void action_train_footswitch_dispense_start(lv_event_t* e) {
 
 extern "C" void action_schedule_add_treat_num(lv_event_t * e) {
     (void)e;
+    if (!objects.schedule_1_treatsnumber) return;
     int idx = lv_roller_get_selected(objects.schedule_1_treatsnumber);
-    selected_treats_number = idx + 1;
-    Serial.print("Treats to dispense selected: ");
-    Serial.println(selected_treats_number);
-    update_schedule_3_ui();
+    schedule_set_selected_treats(idx + 1);
+    LOGI(SCHED, "Treats to dispense selected: %d", idx + 1);
 }
 
 extern "C" void action_schedule_add_hours(lv_event_t * e) {
     (void)e;
+    if (!objects.schedule_2_hours_to_dispense) return;
     int idx = lv_roller_get_selected(objects.schedule_2_hours_to_dispense);
-    selected_hours_to_dispense = idx + 1;
-    Serial.print("Hours to dispense selected: ");
-    Serial.println(selected_hours_to_dispense);
-    update_schedule_3_ui();
+    schedule_set_selected_hours(idx + 1);
+    LOGI(SCHED, "Hours to dispense selected: %d", idx + 1);
 }
 
 extern "C" void action_schedule_2_next(lv_event_t * e) {
     (void)e;
-    Serial.println("Transitioning to Schedule 3 screen");
-    Serial.printf("Current values: treats=%d, hours=%d\n", selected_treats_number, selected_hours_to_dispense);
+    LOGI(SCHED, "Transitioning to Schedule 3 screen");
+    LOGI(SCHED, "Current values: treats=%d, hours=%d", schedule_selected_treats(), schedule_selected_hours());
 }
 
 extern "C" void action_scheduletreatdispensestart(lv_event_t * e) {
     (void)e;
-    Serial.println("=== Schedule Dispense START ===");
+    LOGI(SCHED, "=== Schedule Dispense START ===");
     full_stop();
 
-    if (!schedule_is_running) {
+    if (!schedule_running()) {
         schedule_stop_requested = false;
 
-        schedule_treats_dispensed = 0;
-        schedule_remaining_minutes = selected_hours_to_dispense * 60;
+        schedule_set_treats_dispensed(0);
+        schedule_set_remaining_minutes(schedule_selected_hours() * 60);
         current_treat_index = 0;
         schedule_waiting_for_footswitch = false;
 
-        Serial.printf("Initializing schedule: %d hours = %d minutes\n",
-                      selected_hours_to_dispense, schedule_remaining_minutes);
+        LOGI(SCHED, "Initializing schedule: %d hours = %d minutes",
+                    schedule_selected_hours(), schedule_remaining_minutes());
 
         generate_schedule_times();
 
-        schedule_is_running = true;
-        schedule_is_paused = false;
+        schedule_set_running(true);
+        schedule_set_paused(false);
         schedule_start_time = millis();
 
-        schedule_remaining_minutes = selected_hours_to_dispense * 60;
-        schedule_last_displayed_minutes = -9999;
-        update_schedule_3_ui();
-
-        if (schedule_timer != NULL) {
-            lv_timer_del((lv_timer_t*)schedule_timer);
-            schedule_timer = NULL;
-        }
+        schedule_timer_begin();
 
-        schedule_timer = lv_timer_create(schedule_timer_tick, 100, NULL);
-
-        Serial.println("Triggering treat #1 immediately (manual sequence)");
+        LOGI(SCHED, "Triggering treat #1 immediately (manual sequence)");
         schedule_dispense_treat();
+        schedule_rearm();
 
-        Serial.printf("Schedule started: %d treats/hr over %d hours\n",
-                      selected_treats_number, selected_hours_to_dispense);
-    } else if (schedule_is_paused) {
-        schedule_is_paused = false;
+        LOGI(SCHED, "Schedule started: %d treats/hr over %d hours",
+                    schedule_selected_treats(), schedule_selected_hours());
+    } else if (schedule_paused()) {
+        schedule_set_paused(false);
         unsigned long pause_duration = millis() - schedule_pause_time;
+        // Every deadline is relative to these, so shifting them shifts the whole run
         schedule_start_time += pause_duration;
-        Serial.println("Schedule RESUMED");
+        schedule_wait_start_ms += pause_duration;
+        schedule_last_tone_ms += pause_duration;
+        schedule_rearm();
+        LOGI(SCHED, "Schedule RESUMED");
     }
 }
 
 extern "C" void action_scheduletreatdispensepause(lv_event_t * e) {
     (void)e;
-    if (schedule_is_running && !schedule_is_paused) {
-        schedule_is_paused = true;
+    if (schedule_running() && !schedule_paused()) {
+        schedule_set_paused(true);
         schedule_pause_time = millis();
+        schedule_rearm();   // parks the timer until resume
         full_stop();
-        Serial.println("=== Schedule Dispense PAUSED ===");
-    } else if (schedule_is_paused) {
+        LOGI(SCHED, "=== Schedule Dispense PAUSED ===");
+    } else if (schedule_paused()) {
         action_scheduletreatdispensestart(e);
     }
 }
 
 extern "C" void action_scheduletreatdispensestop(lv_event_t * e) {
     (void)e;
-    Serial.println("=== Schedule Dispense STOPPED ===");
+    LOGI(SCHED, "=== Schedule Dispense STOPPED ===");
 
-    if (g_motor_job.active) {
+    if (motor_job_busy()) {
         schedule_stop_requested = true;
     }
 
-    schedule_is_running = false;
-    schedule_is_paused = false;
-    schedule_treats_dispensed = 0;
-    schedule_remaining_minutes = 0;
+    schedule_set_running(false);
+    schedule_set_paused(false);
+    schedule_set_treats_dispensed(0);
+    schedule_set_remaining_minutes(0);
     current_treat_index = 0;
 
     schedule_waiting_for_footswitch = false;
 
-    if (schedule_timer != NULL) {
-        lv_timer_del((lv_timer_t*)schedule_timer);
-        schedule_timer = NULL;
-    }
+    schedule_timer_end();
 
     full_stop();
-    update_schedule_3_ui();
 
-    Serial.println("=== Schedule Dispense STOP Complete ===");
+    LOGI(SCHED, "=== Schedule Dispense STOP Complete ===");
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ extern "C" {
 
 extern float ZERO_CURRENT_VOLTAGE;
 void actions_init(void);
+void actions_poll_events(void);
 void init_audio(void);
 void setPCF8574Pin(uint8_t pin, bool state);
 void action_manual_dispense_treat(lv_event_t * e);
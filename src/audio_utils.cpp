@@ -1,106 +1,445 @@
 #include "audio_utils.h"
 #include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
 #include "driver/dac.h"
+#include "hal/dac_ll.h"
+#include "freertos/queue.h"
+#include "sdkconfig.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+#include "log.h"
+
+// -----------------------------
+// Engine configuration
+// -----------------------------
+// The built-in DAC can only be DMA-fed through I2S0, which current_sense owns
+// (ADC DMA). Samples are therefore clocked out by a hardware timer ISR from a
+// double buffer; audio_task only refills a half when the ISR hands it back.
+#ifndef AUDIO_STEP_QUEUE_LEN
+#define AUDIO_STEP_QUEUE_LEN 16
+#endif
+
+#ifndef AUDIO_TONE_SAMPLE_RATE_HZ
+#define AUDIO_TONE_SAMPLE_RATE_HZ 16000U
+#endif
+
+// Samples per half of the double buffer (32 ms at 16 kHz)
+#ifndef AUDIO_BUF_SAMPLES
+#define AUDIO_BUF_SAMPLES 512
+#endif
+
+#ifndef AUDIO_HW_TIMER_NUM
+#define AUDIO_HW_TIMER_NUM 1
+#endif
+
+// Timer tick after the prescaler (APB 80 MHz / 5)
+#ifndef AUDIO_TIMER_CLOCK_HZ
+#define AUDIO_TIMER_CLOCK_HZ 16000000UL
+#endif
+
+// WAV gain, 256 = unity
+#ifndef AUDIO_WAV_GAIN
+#define AUDIO_WAV_GAIN 256
+#endif
+
+#ifndef AUDIO_PATH_MAX
+#define AUDIO_PATH_MAX 32
+#endif
+
+// Default tone for audio_play_tone_1s()
+static const uint16_t DEFAULT_FREQ_HZ = 400;
+static const uint8_t  DEFAULT_AMP     = 200;
 
 // --------- Command/state shared with audio task ----------
-static volatile bool     g_playing = false;
-static volatile uint16_t g_freq_hz  = 400;
-static volatile uint8_t  g_amp      = 200;
-static volatile uint32_t g_end_ms   = 0;
+// Queued steps carry the generation they were queued in; audio_stop() bumps
+// the generation so the task drops the current step and any stale ones.
+enum StepKind : uint8_t {
+    STEP_TONE = 0,
+    STEP_WAV
+};
+
+struct QueuedStep {
+    audio_step_t step;      // tone, or fallback for STEP_WAV
+    uint32_t     gen;
+    uint8_t      kind;
+    char         path[AUDIO_PATH_MAX];
+};
+
+static QueueHandle_t     g_stepQueue = nullptr;
+static volatile uint32_t g_gen       = 0;
+static volatile bool     g_playing   = false;
 
 static TaskHandle_t g_audioTaskHandle = nullptr;
 
-// Audio task: runs on background core, toggles DAC without blocking your UI/main
-static void audio_task(void* /*param*/) {
-    // Enable DAC once
-    dac_output_enable(DAC_CHANNEL_2);
+// --------- Double-buffered timer engine ----------
+// A half with len 0 is owned by the task; len > 0 hands it to the ISR.
+static uint8_t           g_buf[2][AUDIO_BUF_SAMPLES];
+static volatile uint16_t g_len[2]   = { 0, 0 };
+static volatile uint8_t  g_playBuf  = 0;
+static volatile uint16_t g_playPos  = 0;
+static hw_timer_t*       g_timer    = nullptr;
+
+#if CONFIG_PM_ENABLE
+// Held while the timer runs: light sleep or an APB change would stop/detune it
+static esp_pm_lock_handle_t g_pmLock = nullptr;
+#endif
+
+static void IRAM_ATTR audio_timer_isr() {
+    uint8_t b = g_playBuf;
+    if (g_playPos >= g_len[b]) {
+        if (g_len[b] != 0) {
+            // Half finished: give it back to the task and move to the other one
+            g_len[b] = 0;
+            b ^= 1;
+            g_playBuf = b;
+            g_playPos = 0;
+
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(g_audioTaskHandle, &woken);
+            if (woken) portYIELD_FROM_ISR();
+        }
+        if (g_playPos >= g_len[b]) {
+            dac_ll_update_output_value(DAC_CHANNEL_2, 0);  // underrun / drained
+            return;
+        }
+    }
+    dac_ll_update_output_value(DAC_CHANNEL_2, g_buf[b][g_playPos++]);
+}
+
+static void engine_start(uint32_t sample_rate) {
+    g_len[0] = 0;
+    g_len[1] = 0;
+    g_playBuf = 0;
+    g_playPos = 0;
+
+#if CONFIG_PM_ENABLE
+    if (!g_pmLock) esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "audio", &g_pmLock);
+    if (g_pmLock) esp_pm_lock_acquire(g_pmLock);
+#endif
+
+    if (!g_timer) {
+        // Attached from audio_task, so the ISR lives on core 0 as well
+        g_timer = timerBegin(AUDIO_HW_TIMER_NUM, (uint16_t)(80000000UL / AUDIO_TIMER_CLOCK_HZ), true);
+        timerAttachInterrupt(g_timer, &audio_timer_isr, true);
+    }
+    timerAlarmWrite(g_timer, AUDIO_TIMER_CLOCK_HZ / sample_rate, true);
+    timerWrite(g_timer, 0);
+    timerAlarmEnable(g_timer);
+}
+
+static void engine_stop() {
+    if (g_timer) timerAlarmDisable(g_timer);
+    g_len[0] = 0;
+    g_len[1] = 0;
     dac_output_voltage(DAC_CHANNEL_2, 0);
+#if CONFIG_PM_ENABLE
+    if (g_pmLock) esp_pm_lock_release(g_pmLock);
+#endif
+}
+
+// Stream a source to the DAC until it ends or the step is cancelled.
+// Returns false if cancelled.
+static bool engine_play(audio_source_t* src, uint32_t gen) {
+    if (!src || !src->fill || src->sample_rate == 0) return true;
 
-    bool high = false;
+    engine_start(src->sample_rate);
+    bool more = true;
+    bool cancelled = false;
 
     for (;;) {
-        // Sleep until we have something to do
-        if (!g_playing) {
-            dac_output_voltage(DAC_CHANNEL_2, 0);
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
+        if (gen != g_gen) {
+            cancelled = true;
+            break;
         }
 
-        // Tone parameters (copy volatile -> local)
-        uint16_t freq = g_freq_hz;
-        uint8_t  amp  = g_amp;
-
-        if (freq == 0) {
-            g_playing = false;
-            dac_output_voltage(DAC_CHANNEL_2, 0);
-            continue;
+        // Refill free halves, the one the ISR is waiting on first
+        const uint8_t pb = g_playBuf;
+        const uint8_t order[2] = { pb, (uint8_t)(pb ^ 1) };
+        for (int k = 0; k < 2 && more; k++) {
+            const uint8_t b = order[k];
+            if (g_len[b] != 0) continue;
+            const size_t n = src->fill(src, g_buf[b], AUDIO_BUF_SAMPLES);
+            if (n == 0) {
+                more = false;
+                break;
+            }
+            g_len[b] = (uint16_t)n;  // publish after the samples are written
         }
 
-        uint32_t half_period_us = (1000000UL / (uint32_t)freq) / 2UL;
-        if (half_period_us == 0) {
-            // Too high for this method; stop safely
-            g_playing = false;
-            dac_output_voltage(DAC_CHANNEL_2, 0);
-            continue;
+        if (!more && g_len[0] == 0 && g_len[1] == 0) break;  // drained
+
+        // ISR notifies on every half; the timeout only bounds stop latency
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+    }
+
+    engine_stop();
+    return !cancelled;
+}
+
+// --------- Sources ----------
+// Square wave by phase accumulator: pitch is exact to the sample clock.
+struct ToneSource {
+    audio_source_t base;   // must stay first
+    uint32_t phase;
+    uint32_t inc;
+    uint32_t remaining;
+    uint8_t  amp;
+};
+
+static size_t tone_fill(audio_source_t* self, uint8_t* dst, size_t max) {
+    ToneSource* t = (ToneSource*)self;
+    const size_t n = (max < t->remaining) ? max : t->remaining;
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = (t->phase & 0x80000000UL) ? 0 : t->amp;
+        t->phase += t->inc;
+    }
+    t->remaining -= n;
+    return n;
+}
+
+static void tone_source_init(ToneSource* t, const audio_step_t& step) {
+    t->base.fill = tone_fill;
+    t->base.close = nullptr;
+    t->base.sample_rate = AUDIO_TONE_SAMPLE_RATE_HZ;
+    t->phase = 0;
+    t->inc = (uint32_t)(((uint64_t)step.freq_hz << 32) / AUDIO_TONE_SAMPLE_RATE_HZ);
+    t->remaining = (uint32_t)(((uint64_t)AUDIO_TONE_SAMPLE_RATE_HZ * step.on_ms) / 1000UL);
+    t->amp = step.amplitude;
+}
+
+// PCM WAV from SD, converted to unsigned 8-bit mono on the fly.
+struct WavSource {
+    audio_source_t base;   // must stay first
+    File     f;
+    uint32_t data_left;    // bytes
+    uint8_t  channels;
+    uint8_t  bits;
+    uint8_t  raw[AUDIO_BUF_SAMPLES * 4];  // worst case 16-bit stereo
+};
+
+static WavSource g_wav;  // one WAV at a time; keeps the 2 KB buffer off the task stack
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t* p) { return (uint32_t)rd16(p) | ((uint32_t)rd16(p + 2) << 16); }
+
+static size_t wav_fill(audio_source_t* self, uint8_t* dst, size_t max) {
+    WavSource* w = (WavSource*)self;
+    const uint32_t frame_bytes = (uint32_t)w->channels * (w->bits / 8);
+
+    uint32_t frames = w->data_left / frame_bytes;
+    if (frames > max) frames = max;
+    if (frames == 0) return 0;
+
+    const int got = w->f.read(w->raw, frames * frame_bytes);
+    if (got <= 0) return 0;
+    frames = (uint32_t)got / frame_bytes;
+    w->data_left -= frames * frame_bytes;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        const uint8_t* fr = w->raw + i * frame_bytes;
+        int32_t s = 0;  // signed, centred on 0, 8-bit range
+        for (uint8_t c = 0; c < w->channels; c++) {
+            if (w->bits == 8) s += (int32_t)fr[c] - 128;
+            else              s += (int16_t)rd16(fr + 2 * c) >> 8;
         }
+        s /= w->channels;
+        s = (s * AUDIO_WAV_GAIN) >> 8;
+        if (s < -128) s = -128;
+        if (s > 127) s = 127;
+        dst[i] = (uint8_t)(s + 128);
+    }
+    return frames;
+}
+
+static void wav_close(audio_source_t* self) {
+    WavSource* w = (WavSource*)self;
+    if (w->f) w->f.close();
+}
+
+static bool wav_open(WavSource* w, const char* path) {
+    w->f = SD.open(path, FILE_READ);
+    if (!w->f) {
+        LOGW(AUDIO, "WAV %s: open failed", path);
+        return false;
+    }
+
+    uint8_t hdr[16];
+    if (w->f.read(hdr, 12) != 12 || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+        LOGW(AUDIO, "WAV %s: not a RIFF/WAVE file", path);
+        w->f.close();
+        return false;
+    }
+
+    bool have_fmt = false;
+    uint16_t format = 0;
+    uint32_t rate = 0;
 
-        // Stop check (millis wrap safe)
-        if ((int32_t)(millis() - g_end_ms) >= 0) {
-            g_playing = false;
-            dac_output_voltage(DAC_CHANNEL_2, 0);
-            continue;
+    // Walk chunks until "data"; everything but "fmt " is skipped
+    while (w->f.read(hdr, 8) == 8) {
+        const uint32_t size = rd32(hdr + 4);
+        if (memcmp(hdr, "fmt ", 4) == 0 && size >= 16) {
+            if (w->f.read(hdr, 16) != 16) break;
+            format      = rd16(hdr + 0);
+            w->channels = (uint8_t)rd16(hdr + 2);
+            rate        = rd32(hdr + 4);
+            w->bits     = (uint8_t)rd16(hdr + 14);
+            have_fmt = true;
+            w->f.seek(w->f.position() + (size - 16) + (size & 1));
+        } else if (memcmp(hdr, "data", 4) == 0) {
+            if (!have_fmt || format != 1 ||
+                w->channels < 1 || w->channels > 2 ||
+                (w->bits != 8 && w->bits != 16) ||
+                rate < 4000 || rate > 48000) {
+                LOGW(AUDIO, "WAV %s: unsupported (fmt=%u ch=%u bits=%u rate=%lu)",
+                            path, (unsigned)format, (unsigned)w->channels,
+                            (unsigned)w->bits, (unsigned long)rate);
+                break;
+            }
+            w->data_left = size;
+            w->base.fill = wav_fill;
+            w->base.close = wav_close;
+            w->base.sample_rate = rate;
+            return true;
+        } else {
+            w->f.seek(w->f.position() + size + (size & 1));
         }
+    }
+
+    w->f.close();
+    return false;
+}
+
+// Silence for off_ms in 10 ms slices so a stop is still seen promptly.
+// The timer is off during gaps, so they cost nothing.
+static bool play_gap(uint32_t off_ms, uint32_t gen) {
+    const uint32_t end_ms = millis() + off_ms;
+    while ((int32_t)(millis() - end_ms) < 0) {
+        if (gen != g_gen) return false;
+        const uint32_t left = end_ms - millis();
+        const TickType_t ticks = pdMS_TO_TICKS(left < 10 ? left : 10);
+        vTaskDelay(ticks ? ticks : 1);
+    }
+    return true;
+}
+
+static void play_tone_step(const audio_step_t& step, uint32_t gen) {
+    if (step.freq_hz == 0 || step.amplitude == 0 || step.on_ms == 0 ||
+        step.freq_hz >= AUDIO_TONE_SAMPLE_RATE_HZ / 2) {
+        // Pure rest (or a pitch the sample rate can't carry)
+        play_gap((uint32_t)step.on_ms + step.off_ms, gen);
+        return;
+    }
+
+    const uint8_t reps = step.repeat ? step.repeat : 1;
+    for (uint8_t i = 0; i < reps; i++) {
+        ToneSource tone;
+        tone_source_init(&tone, step);
+        if (!engine_play(&tone.base, gen)) return;
+        if (i + 1 < reps && !play_gap(step.off_ms, gen)) return;
+    }
+}
 
-        // Toggle output (square wave)
-        high = !high;
-        dac_output_voltage(DAC_CHANNEL_2, high ? amp : 0);
+// Audio task: runs on background core, consumes the step queue
+static void audio_task(void* /*param*/) {
+    // Enable DAC once
+    dac_output_enable(DAC_CHANNEL_2);
+    dac_output_voltage(DAC_CHANNEL_2, 0);
 
-        // Precise-ish delay in task context (won't freeze UI)
-        ets_delay_us(half_period_us);
+    for (;;) {
+        // Sleep until we have something to do
+        QueuedStep qs;
+        if (xQueueReceive(g_stepQueue, &qs, portMAX_DELAY) != pdTRUE) continue;
+        if (qs.gen != g_gen) continue;  // queued before the last audio_stop()
 
-        // Yield occasionally so we don't hog CPU
-        // (every ~5ms worth of toggles)
-        static uint32_t lastYield = 0;
-        uint32_t now = millis();
-        if ((uint32_t)(now - lastYield) >= 5) {
-            lastYield = now;
-            taskYIELD();
+        if (qs.kind == STEP_WAV) {
+            if (wav_open(&g_wav, qs.path)) {
+                engine_play(&g_wav.base, qs.gen);
+                wav_close(&g_wav.base);
+            } else {
+                play_tone_step(qs.step, qs.gen);
+            }
+        } else {
+            play_tone_step(qs.step, qs.gen);
         }
+
+        if (uxQueueMessagesWaiting(g_stepQueue) == 0) g_playing = false;
     }
 }
 
 void audio_init(void) {
     if (g_audioTaskHandle) return;
 
+    g_stepQueue = xQueueCreate(AUDIO_STEP_QUEUE_LEN, sizeof(QueuedStep));
+
     // Create task on the OTHER core than Arduino loop typically runs on.
     // Arduino loop is usually core 1; pin audio to core 0 to keep UI responsive.
     xTaskCreatePinnedToCore(
         audio_task,
         "audio_task",
-        2048,
+        4096,           // SD/FS file access
         nullptr,
-        1,              // low priority
+        1,              // low priority; sample timing comes from the timer ISR
         &g_audioTaskHandle,
         0               // core 0
     );
 }
 
+static bool enqueue_step(const QueuedStep& qs) {
+    return xQueueSend(g_stepQueue, &qs, 0) == pdTRUE;
+}
+
+bool audio_play_pattern(const audio_step_t* steps, size_t count) {
+    if (!g_audioTaskHandle) audio_init();
+    if (!steps || count == 0) return true;
+    if (uxQueueSpacesAvailable(g_stepQueue) < count) return false;
+
+    QueuedStep qs;
+    memset(&qs, 0, sizeof(qs));
+    qs.gen = g_gen;
+    qs.kind = STEP_TONE;
+    for (size_t i = 0; i < count; i++) {
+        qs.step = steps[i];
+        enqueue_step(qs);
+    }
+    g_playing = true;
+    return true;
+}
+
+bool audio_play_wav(const char* path, const audio_step_t* fallback) {
+    if (!g_audioTaskHandle) audio_init();
+    if (!path) return false;
+
+    QueuedStep qs;
+    memset(&qs, 0, sizeof(qs));
+    qs.gen = g_gen;
+    qs.kind = STEP_WAV;
+    if (fallback) qs.step = *fallback;
+    strncpy(qs.path, path, sizeof(qs.path) - 1);
+
+    if (!enqueue_step(qs)) return false;
+    g_playing = true;
+    return true;
+}
+
 void audio_play_tone(uint16_t frequency_hz, uint8_t amplitude, uint32_t duration_ms) {
     if (!g_audioTaskHandle) audio_init();
 
+    // A plain tone replaces whatever is playing (previous behaviour)
+    audio_stop();
+
     if (duration_ms == 0 || frequency_hz == 0 || amplitude == 0) {
-        audio_stop();
         return;
     }
 
-    g_freq_hz  = frequency_hz;
-    g_amp      = amplitude;
-    g_end_ms   = millis() + duration_ms;
-    g_playing  = true;
+    if (duration_ms > 0xFFFFUL) duration_ms = 0xFFFFUL;
+    const audio_step_t step = { frequency_hz, amplitude, 1, (uint16_t)duration_ms, 0 };
+    audio_play_pattern(&step, 1);
 }
 
 void audio_play_tone_1s(void) {
-    audio_play_tone(g_freq_hz, g_amp, 1000);
+    audio_play_tone(DEFAULT_FREQ_HZ, DEFAULT_AMP, 1000);
 }
 
 bool audio_is_playing(void) {
@@ -108,6 +447,8 @@ bool audio_is_playing(void) {
 }
 
 void audio_stop(void) {
+    g_gen = g_gen + 1;
+    if (g_stepQueue) xQueueReset(g_stepQueue);
     g_playing = false;
-    // Task will force DAC to 0 on its next loop
+    // Task stops the timer and forces the DAC to 0 within one 10 ms slice
 }
@@ -1,19 +1,46 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// One step of a tone pattern: `repeat` beeps of on_ms at freq_hz/amplitude,
+// separated by off_ms of silence (no trailing gap after the last beep).
+typedef struct {
+    uint16_t freq_hz;
+    uint8_t  amplitude;
+    uint8_t  repeat;      // 0 is treated as 1
+    uint16_t on_ms;
+    uint16_t off_ms;
+} audio_step_t;
+
+// Sample generator: audio_task pulls unsigned 8-bit DAC samples from it into
+// the engine's double buffer. fill() returns the number written; 0 = finished.
+typedef struct audio_source_s {
+    size_t   (*fill)(struct audio_source_s* self, uint8_t* dst, size_t max);
+    void     (*close)(struct audio_source_s* self);   // may be NULL
+    uint32_t sample_rate;
+} audio_source_t;
+
 void audio_init(void);
 
 // Non-blocking: returns immediately; audio runs in background task
 void audio_play_tone(uint16_t frequency_hz, uint8_t amplitude, uint32_t duration_ms);
 void audio_play_tone_1s(void);
 
+// Non-blocking: appends steps after whatever is already queued.
+// Returns false if the step queue is full (nothing is queued then).
+bool audio_play_pattern(const audio_step_t* steps, size_t count);
+
+// Non-blocking: queues a PCM WAV (8/16-bit, mono/stereo) streamed from SD.
+// If the file can't be opened or parsed, `fallback` (may be NULL) plays instead.
+bool audio_play_wav(const char* path, const audio_step_t* fallback);
+
 bool audio_is_playing(void);
-void audio_stop(void);
+void audio_stop(void);   // drops the current step and everything queued
 
 #ifdef __cplusplus
 }
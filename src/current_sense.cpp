@@ -0,0 +1,239 @@
+#include "current_sense.h"
+#include <Arduino.h>
+#include <math.h>
+#include <atomic>
+#include "driver/i2s.h"
+#include "driver/adc.h"
+#include "log.h"
+
+// -----------------------------
+// Configuration
+// -----------------------------
+#ifndef CURRENT_SENSOR_PIN
+#define CURRENT_SENSOR_PIN 35
+#endif
+
+// GPIO35 = ADC1 channel 7 (I2S ADC mode only supports ADC1)
+#ifndef CURRENT_SENSE_ADC_CHANNEL
+#define CURRENT_SENSE_ADC_CHANNEL ADC1_CHANNEL_7
+#endif
+
+#ifndef CURRENT_SENSE_SAMPLE_RATE_HZ
+#define CURRENT_SENSE_SAMPLE_RATE_HZ 8000U
+#endif
+
+// Samples per DMA buffer (one i2s_read per buffer)
+#ifndef CURRENT_SENSE_DMA_BUF_LEN
+#define CURRENT_SENSE_DMA_BUF_LEN 64
+#endif
+
+#ifndef CURRENT_SENSE_DMA_BUF_COUNT
+#define CURRENT_SENSE_DMA_BUF_COUNT 4
+#endif
+
+// Ring of raw 12-bit samples; power of two (~128 ms at 8 kHz)
+#ifndef CURRENT_SENSE_RING_SIZE
+#define CURRENT_SENSE_RING_SIZE 1024
+#endif
+
+// Fallback (no DMA): cap on blocking analogRead() calls per window
+#ifndef CURRENT_SENSE_FALLBACK_MAX_SAMPLES
+#define CURRENT_SENSE_FALLBACK_MAX_SAMPLES 4
+#endif
+
+// Max ticks current_sense_read_adc() waits for the first DMA buffer after start/resume
+#ifndef CURRENT_SENSE_FIRST_BUF_WAIT_TICKS
+#define CURRENT_SENSE_FIRST_BUF_WAIT_TICKS 20
+#endif
+
+static_assert((CURRENT_SENSE_RING_SIZE & (CURRENT_SENSE_RING_SIZE - 1)) == 0,
+              "CURRENT_SENSE_RING_SIZE must be a power of two");
+static_assert(CURRENT_SENSE_RING_SIZE > 2 * CURRENT_SENSE_DMA_BUF_LEN,
+              "ring must hold more than two DMA buffers");
+
+// Never hand out the slice the reader task may be overwriting right now.
+static const uint32_t MAX_WINDOW = CURRENT_SENSE_RING_SIZE - CURRENT_SENSE_DMA_BUF_LEN;
+
+// --------- State shared with the reader task ----------
+static uint16_t g_ring[CURRENT_SENSE_RING_SIZE];
+static std::atomic<uint32_t> g_write_idx{0};   // total samples written (single writer)
+static TaskHandle_t g_readerTaskHandle = nullptr;
+static bool g_streaming = false;
+static bool g_active = false;
+static std::atomic<uint32_t> g_valid_from{0};  // first sample since the last resume
+
+// Reader task: drains I2S DMA buffers into the ring. Blocks inside i2s_read,
+// so it costs nothing between buffers.
+static void current_sense_task(void* /*param*/) {
+    uint16_t buf[CURRENT_SENSE_DMA_BUF_LEN];
+
+    for (;;) {
+        size_t bytes_read = 0;
+        if (i2s_read(I2S_NUM_0, buf, sizeof(buf), &bytes_read, portMAX_DELAY) != ESP_OK) {
+            continue;
+        }
+
+        uint32_t idx = g_write_idx.load(std::memory_order_relaxed);
+        const size_t n = bytes_read / sizeof(buf[0]);
+        for (size_t i = 0; i < n; i++) {
+            // Top 4 bits carry the channel number in I2S ADC mode
+            g_ring[idx & (CURRENT_SENSE_RING_SIZE - 1)] = buf[i] & 0x0FFF;
+            idx++;
+        }
+        g_write_idx.store(idx, std::memory_order_release);
+    }
+}
+
+bool current_sense_begin(void) {
+    if (g_readerTaskHandle) return g_streaming;
+
+    i2s_config_t cfg = {};
+    cfg.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+    cfg.sample_rate = CURRENT_SENSE_SAMPLE_RATE_HZ;
+    cfg.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    cfg.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    cfg.intr_alloc_flags = 0;
+    cfg.dma_buf_count = CURRENT_SENSE_DMA_BUF_COUNT;
+    cfg.dma_buf_len = CURRENT_SENSE_DMA_BUF_LEN;
+    cfg.use_apll = false;
+
+    if (i2s_driver_install(I2S_NUM_0, &cfg, 0, NULL) != ESP_OK) {
+        LOGW(ADC, "Current sense: I2S ADC install failed; using analogRead fallback.");
+        return false;
+    }
+
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(CURRENT_SENSE_ADC_CHANNEL, ADC_ATTEN_DB_11); // same range as analogRead
+    i2s_set_adc_mode(ADC_UNIT_1, CURRENT_SENSE_ADC_CHANNEL);
+    i2s_adc_enable(I2S_NUM_0);
+
+    // Core 0 next to audio_task, above it so DMA buffers never overflow.
+    xTaskCreatePinnedToCore(
+        current_sense_task,
+        "current_sense",
+        3072,
+        nullptr,
+        3,
+        &g_readerTaskHandle,
+        0
+    );
+
+    g_streaming = (g_readerTaskHandle != nullptr);
+    g_active = g_streaming;
+    LOGI(ADC, "Current sense: DMA ADC on GPIO%d @ %u Hz, ring=%d samples",
+              (int)CURRENT_SENSOR_PIN,
+              (unsigned)CURRENT_SENSE_SAMPLE_RATE_HZ,
+              (int)CURRENT_SENSE_RING_SIZE);
+    return g_streaming;
+}
+
+bool current_sense_is_streaming(void) {
+    return g_streaming;
+}
+
+void current_sense_set_active(bool active) {
+    if (!g_streaming || active == g_active) return;
+
+    if (active) {
+        g_valid_from.store(g_write_idx.load(std::memory_order_acquire), std::memory_order_release);
+        i2s_adc_enable(I2S_NUM_0);   // restarts I2S (and takes its PM lock)
+    } else {
+        i2s_adc_disable(I2S_NUM_0);
+        i2s_stop(I2S_NUM_0);         // drops the PM lock
+    }
+    g_active = active;
+}
+
+bool current_sense_window(uint16_t samples, uint16_t zero_counts, current_window_t* out) {
+    if (!out) return false;
+    if (samples == 0) samples = 1;
+
+    uint32_t sum = 0;
+    uint64_t sum_sq = 0;
+    uint16_t lo = 0xFFFF;
+    uint16_t hi = 0;
+    uint32_t n = 0;
+
+    if (g_streaming) {
+        // Just started/resumed with no DMA buffer yet: report nothing (n stays 0).
+        // Neither wait nor fall back to analogRead(), which would block on the ADC1
+        // lock the I2S driver holds; the motor tick reads 0 A for that one window.
+        const uint32_t end = g_write_idx.load(std::memory_order_acquire);
+        uint32_t fresh = end - g_valid_from.load(std::memory_order_acquire);
+        if (fresh == 0 && !g_active) fresh = end;   // paused: last samples taken
+
+        n = samples;
+        if (n > MAX_WINDOW) n = MAX_WINDOW;
+        if (n > fresh) n = fresh;
+        for (uint32_t i = end - n; i != end; i++) {
+            const uint16_t s = g_ring[i & (CURRENT_SENSE_RING_SIZE - 1)];
+            const int32_t d = (int32_t)s - (int32_t)zero_counts;
+            sum += s;
+            sum_sq += (uint64_t)(d * d);
+            if (s < lo) lo = s;
+            if (s > hi) hi = s;
+        }
+    }
+
+    if (n == 0 && !g_streaming) {
+        // Blocking fallback: same as the old averaged analogRead path
+        n = samples;
+        if (n > CURRENT_SENSE_FALLBACK_MAX_SAMPLES) n = CURRENT_SENSE_FALLBACK_MAX_SAMPLES;
+        for (uint32_t i = 0; i < n; i++) {
+            const uint16_t s = (uint16_t)analogRead(CURRENT_SENSOR_PIN);
+            const int32_t d = (int32_t)s - (int32_t)zero_counts;
+            sum += s;
+            sum_sq += (uint64_t)(d * d);
+            if (s < lo) lo = s;
+            if (s > hi) hi = s;
+        }
+    }
+
+    if (n == 0) {
+        *out = current_window_t{};
+        return false;
+    }
+
+    out->mean  = (uint16_t)(sum / n);
+    out->min   = lo;
+    out->peak  = hi;
+    out->rms   = (uint16_t)sqrtf((float)sum_sq / (float)n);
+    out->count = (uint16_t)n;
+    return true;
+}
+
+int current_sense_read_adc(uint16_t samples) {
+    current_window_t w;
+    for (int tries = 0; !current_sense_window(samples, 0, &w); tries++) {
+        if (!g_streaming || tries >= CURRENT_SENSE_FIRST_BUF_WAIT_TICKS) break;
+        vTaskDelay(1);
+    }
+    return w.mean;
+}
+
+uint16_t current_sense_read_since(uint32_t* cursor, uint16_t* out, uint16_t max) {
+    if (!g_streaming || !cursor || !out) return 0;
+
+    const uint32_t end = g_write_idx.load(std::memory_order_acquire);
+    const uint32_t valid_from = g_valid_from.load(std::memory_order_acquire);
+    uint32_t start = *cursor;
+    if ((int32_t)(start - valid_from) < 0) start = valid_from;
+    if ((uint32_t)(end - start) > MAX_WINDOW) start = end - MAX_WINDOW;
+
+    uint16_t n = 0;
+    while (start != end && n < max) {
+        out[n++] = g_ring[start & (CURRENT_SENSE_RING_SIZE - 1)];
+        start++;
+    }
+    *cursor = start;
+    return n;
+}
+
+uint32_t current_sense_sample_rate_hz(void) {
+    return g_streaming ? CURRENT_SENSE_SAMPLE_RATE_HZ : 0;
+}
+
+uint32_t current_sense_total_samples(void) {
+    return g_write_idx.load(std::memory_order_acquire);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Continuous motor-current acquisition.
+// I2S0 in built-in ADC mode streams ADC1 (GPIO35) by DMA at CURRENT_SENSE_SAMPLE_RATE_HZ
+// into a ring buffer; consumers read window statistics without blocking.
+// If the DMA path cannot start, every call falls back to blocking analogRead().
+
+typedef struct {
+    uint16_t mean;     // ADC counts
+    uint16_t min;
+    uint16_t peak;     // max ADC counts in window
+    uint16_t rms;      // RMS of (sample - zero_counts); see current_sense_window()
+    uint16_t count;    // samples actually used
+} current_window_t;
+
+bool current_sense_begin(void);
+bool current_sense_is_streaming(void);
+
+// Stats over the most recent `samples` samples (clamped to the ring size).
+// zero_counts is the sensor's 0 A level, so rms is the AC+DC current magnitude.
+// Never waits: returns false (out zeroed) if the stream has produced no samples yet,
+// or was started/resumed and its first DMA buffer has not landed.
+bool current_sense_window(uint16_t samples, uint16_t zero_counts, current_window_t* out);
+
+// Mean of the most recent `samples` samples (ADC counts). Blocking: right after a
+// start/resume it waits up to CURRENT_SENSE_FIRST_BUF_WAIT_TICKS for the first buffer.
+int current_sense_read_adc(uint16_t samples);
+
+// Streaming read: copies samples written since *cursor (at most max) and advances it.
+// A cursor that fell more than a ring behind skips to the oldest safe sample.
+// Returns 0 when not streaming.
+uint16_t current_sense_read_since(uint32_t* cursor, uint16_t* out, uint16_t max);
+
+// Pause/resume the DMA stream. While paused the I2S power lock is released (the
+// system may light-sleep) and window stats see the last samples taken.
+// After resume, windows and cursors only cover samples taken since.
+void current_sense_set_active(bool active);
+
+uint32_t current_sense_sample_rate_hz(void);
+uint32_t current_sense_total_samples(void);  // monotonically increasing
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,185 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Fixed-point streaming filters for raw ADC counts.
+// Every stage has step(x) -> y and reset(); stages compose at compile time with
+// dsp::Chain<...> so each unit's filter chain is a single inlined specialization.
+// All arithmetic is int32 (ADC counts are 12-bit), no floats on the sample path.
+
+namespace dsp {
+
+// Integer square root (floor) for 32-bit values.
+static inline uint32_t isqrt32(uint32_t v) {
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+// ---------------------------
+// Median-of-N spike rejection
+// ---------------------------
+template <int N>
+struct MedianN {
+    static_assert(N >= 3 && (N & 1), "MedianN needs an odd N >= 3");
+
+    int32_t hist[N];
+    int     idx;
+    int     filled;
+
+    MedianN() { reset(); }
+    void reset() { idx = 0; filled = 0; }
+
+    int32_t step(int32_t x) {
+        hist[idx] = x;
+        idx = (idx + 1) % N;
+        if (filled < N) filled++;
+
+        // Insertion sort of a tiny copy is cheaper than a heap for N <= 7
+        int32_t s[N];
+        for (int i = 0; i < filled; i++) {
+            int32_t v = hist[i];
+            int j = i;
+            while (j > 0 && s[j - 1] > v) { s[j] = s[j - 1]; j--; }
+            s[j] = v;
+        }
+        return s[filled / 2];
+    }
+};
+
+// ---------------------------
+// First-order IIR low-pass: y += (x - y) / 2^SHIFT
+// State is kept with FRAC fractional bits so small steps are not lost.
+// Time constant ~= 2^SHIFT samples.
+// ---------------------------
+template <int SHIFT, int FRAC = 8>
+struct IirLowpass {
+    static_assert(SHIFT >= 1 && SHIFT <= 15, "IirLowpass SHIFT out of range");
+    static_assert(FRAC + 13 < 31, "IirLowpass state would overflow int32 for 12-bit input");
+
+    int32_t acc;
+    bool    primed;
+
+    IirLowpass() { reset(); }
+    void reset() { acc = 0; primed = false; }
+
+    int32_t step(int32_t x) {
+        const int32_t xq = x << FRAC;
+        if (!primed) { acc = xq; primed = true; }   // start at the first sample, no ramp
+        acc += (xq - acc) >> SHIFT;
+        return acc >> FRAC;
+    }
+};
+
+// ---------------------------
+// Windowed RMS over the last 2^LOG2 samples (running sum of squares)
+// ---------------------------
+template <int LOG2>
+struct WindowRms {
+    static_assert(LOG2 >= 1 && LOG2 <= 8, "WindowRms window out of range");
+    static const int LEN = 1 << LOG2;
+
+    uint32_t sq[LEN];
+    uint32_t sum;
+    int      idx;
+
+    WindowRms() { reset(); }
+    void reset() {
+        for (int i = 0; i < LEN; i++) sq[i] = 0;
+        sum = 0;
+        idx = 0;
+    }
+
+    int32_t step(int32_t x) {
+        // Clamp so 2^LOG2 * x^2 always fits in 32 bits
+        if (x < 0) x = -x;
+        if (x > 4095) x = 4095;
+        const uint32_t s = (uint32_t)(x * x);
+        sum += s - sq[idx];
+        sq[idx] = s;
+        idx = (idx + 1) & (LEN - 1);
+        return (int32_t)isqrt32(sum >> LOG2);
+    }
+};
+
+// ---------------------------
+// Slope: x[n] - x[n - LAG] (counts per LAG samples)
+// ---------------------------
+template <int LAG>
+struct Slope {
+    static_assert(LAG >= 1, "Slope LAG must be >= 1");
+
+    int32_t hist[LAG];
+    int     idx;
+    bool    primed;
+
+    Slope() { reset(); }
+    void reset() { idx = 0; primed = false; }
+
+    int32_t step(int32_t x) {
+        if (!primed) {
+            for (int i = 0; i < LAG; i++) hist[i] = x;
+            primed = true;
+        }
+        const int32_t old = hist[idx];
+        hist[idx] = x;
+        idx = (idx + 1) % LAG;
+        return x - old;
+    }
+};
+
+// ---------------------------
+// Hysteresis comparator: turns on at >= ON, off at < OFF
+// ---------------------------
+template <int32_t ON, int32_t OFF>
+struct Hysteresis {
+    static_assert(OFF <= ON, "Hysteresis OFF threshold must not exceed ON");
+
+    bool on;
+
+    Hysteresis() { reset(); }
+    void reset() { on = false; }
+
+    bool step(int32_t x) {
+        if (on) {
+            if (x < OFF) on = false;
+        } else {
+            if (x >= ON) on = true;
+        }
+        return on;
+    }
+    bool state() const { return on; }
+};
+
+// ---------------------------
+// Compile-time composition: Chain<A, B, C>::step(x) == C.step(B.step(A.step(x)))
+// ---------------------------
+template <typename... Stages>
+struct Chain;
+
+template <>
+struct Chain<> {
+    void reset() {}
+    int32_t step(int32_t x) { return x; }
+};
+
+template <typename Head, typename... Tail>
+struct Chain<Head, Tail...> {
+    Head head;
+    Chain<Tail...> tail;
+
+    void reset() { head.reset(); tail.reset(); }
+    int32_t step(int32_t x) { return tail.step(head.step(x)); }
+};
+
+} // namespace dsp
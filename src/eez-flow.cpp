@@ -54,35 +54,171 @@ void executeActionFunction(int actionId) {
 #endif
 namespace eez {
 #if defined(EEZ_FOR_LVGL)
-void initAllocHeap(uint8_t *heap, size_t heapSize) {
-}
-void *alloc(size_t size, uint32_t id) {
+// Small objects (Value refs, strings, component execution states) come from slabs
+// carved into per-size-class free lists, so they are O(1) to allocate and free and
+// never fragment the system heap they share with LVGL, Wi-Fi and FreeRTOS. Slabs are
+// kept once taken: the pool settles at the flow's peak. Anything larger than the
+// biggest class (FlowState, big arrays) goes to lv_malloc as before.
+//
+// Every block carries a header naming its size class and its allocation id's stats
+// entry, which getAllocInfo(index, info) reports. Like lv_malloc with LV_OS_NONE,
+// this is for the UI task only.
+#if !defined(EEZ_ALLOC_SLAB_SIZE)
+#define EEZ_ALLOC_SLAB_SIZE 1024
+#endif
+#if !defined(EEZ_ALLOC_STATS_SIZE)
+#define EEZ_ALLOC_STATS_SIZE 64
+#endif
+static const uint16_t SIZE_CLASSES[] = { 8, 16, 24, 32, 48, 64, 96, 128 };
+static const unsigned NUM_SIZE_CLASSES = sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]);
+static const uint8_t LARGE_BLOCK = 0xFF;
+struct AllocHeader {
+    uint8_t sizeClass;
+    uint8_t reserved;
+    uint16_t stats;
+    uint32_t size;
+};
+struct FreeBlock {
+    FreeBlock *next;
+};
+struct SizeClass {
+    FreeBlock *free;
+    uint32_t slabs;
+    uint32_t freeBlocks;
+};
+static SizeClass g_sizeClasses[NUM_SIZE_CLASSES];
+// Open-addressed by id; the extra last entry collects ids that did not fit
+static AllocIdInfo g_allocStats[EEZ_ALLOC_STATS_SIZE + 1];
+static uint32_t g_allocBytes;
+static inline void *sysAlloc(size_t size) {
 #if LVGL_VERSION_MAJOR >= 9
     return lv_malloc(size);
 #else
     return lv_mem_alloc(size);
 #endif
 }
-void free(void *ptr) {
+static inline void sysFree(void *ptr) {
 #if LVGL_VERSION_MAJOR >= 9
     lv_free(ptr);
 #else
     lv_mem_free(ptr);
 #endif
 }
+static inline unsigned sizeClassFor(size_t size) {
+    for (unsigned i = 0; i < NUM_SIZE_CLASSES; i++) {
+        if (size <= SIZE_CLASSES[i]) {
+            return i;
+        }
+    }
+    return LARGE_BLOCK;
+}
+static uint16_t statsFor(uint32_t id) {
+    unsigned i = ((id * 2654435761u) >> 16) % EEZ_ALLOC_STATS_SIZE;
+    for (unsigned n = 0; n < EEZ_ALLOC_STATS_SIZE; n++) {
+        auto &entry = g_allocStats[i];
+        if (entry.id == id && entry.allocs > 0) {
+            return i;
+        }
+        if (entry.allocs == 0) {
+            entry.id = id;
+            return i;
+        }
+        i = (i + 1) % EEZ_ALLOC_STATS_SIZE;
+    }
+    return EEZ_ALLOC_STATS_SIZE;
+}
+static bool addSlab(unsigned sizeClass) {
+    const size_t stride = sizeof(AllocHeader) + SIZE_CLASSES[sizeClass];
+    auto slab = (uint8_t *)sysAlloc(EEZ_ALLOC_SLAB_SIZE);
+    if (!slab) {
+        return false;
+    }
+    auto &sc = g_sizeClasses[sizeClass];
+    for (size_t offset = 0; offset + stride <= EEZ_ALLOC_SLAB_SIZE; offset += stride) {
+        auto block = (FreeBlock *)(slab + offset + sizeof(AllocHeader));
+        block->next = sc.free;
+        sc.free = block;
+        sc.freeBlocks++;
+    }
+    sc.slabs++;
+    return true;
+}
+void initAllocHeap(uint8_t *heap, size_t heapSize) {
+}
+void *alloc(size_t size, uint32_t id) {
+    if (size == 0) {
+        return nullptr;
+    }
+    AllocHeader *header;
+    auto sizeClass = sizeClassFor(size);
+    if (sizeClass != LARGE_BLOCK) {
+        auto &sc = g_sizeClasses[sizeClass];
+        if (!sc.free && !addSlab(sizeClass)) {
+            return nullptr;
+        }
+        auto block = sc.free;
+        sc.free = block->next;
+        sc.freeBlocks--;
+        header = (AllocHeader *)block - 1;
+    } else {
+        header = (AllocHeader *)sysAlloc(sizeof(AllocHeader) + size);
+        if (!header) {
+            return nullptr;
+        }
+    }
+    header->sizeClass = sizeClass;
+    header->stats = statsFor(id);
+    header->size = size;
+    auto &stats = g_allocStats[header->stats];
+    stats.allocs++;
+    stats.count++;
+    stats.bytes += size;
+    if (stats.bytes > stats.peakBytes) {
+        stats.peakBytes = stats.bytes;
+    }
+    g_allocBytes += size;
+    return header + 1;
+}
+void free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto header = (AllocHeader *)ptr - 1;
+    auto &stats = g_allocStats[header->stats];
+    stats.count--;
+    stats.bytes -= header->size;
+    g_allocBytes -= header->size;
+    if (header->sizeClass != LARGE_BLOCK) {
+        auto &sc = g_sizeClasses[header->sizeClass];
+        auto block = (FreeBlock *)ptr;
+        block->next = sc.free;
+        sc.free = block;
+        sc.freeBlocks++;
+    } else {
+        sysFree(header);
+    }
+}
 template<typename T> void freeObject(T *ptr) {
 	ptr->~T();
-#if LVGL_VERSION_MAJOR >= 9
-    lv_free(ptr);
-#else
-	lv_mem_free(ptr);
-#endif
+    free(ptr);
 }
 void getAllocInfo(uint32_t &free, uint32_t &alloc) {
     lv_mem_monitor_t mon;
     lv_mem_monitor(&mon);
 	free = mon.free_size;
-	alloc = mon.total_size - mon.free_size;
+    for (unsigned i = 0; i < NUM_SIZE_CLASSES; i++) {
+        free += g_sizeClasses[i].freeBlocks * SIZE_CLASSES[i];
+    }
+	alloc = g_allocBytes;
+}
+bool getAllocInfo(unsigned index, AllocIdInfo &info) {
+    for (unsigned i = 0; i <= EEZ_ALLOC_STATS_SIZE; i++) {
+        if (g_allocStats[i].allocs > 0 && index-- == 0) {
+            info = g_allocStats[i];
+            return true;
+        }
+    }
+    return false;
 }
 #elif defined(EEZ_DASHBOARD_API)
 #include <emscripten/heap.h>
@@ -3645,6 +3781,7 @@ void executeLineChartWidgetComponent(FlowState *flowState, unsigned componentInd
             executionState->numPoints = 0;
             for (uint32_t elementIndex = 0; elementIndex < array->arraySize; elementIndex++) {
                 flowState->values[valueInputIndexInFlow] = array->values[elementIndex];
+                watchListValueChanged(&flowState->values[valueInputIndexInFlow]);
                 if (executionState->onInputValue(flowState, componentIndex)) {
                     updated = true;
                 } else {
@@ -6318,6 +6455,7 @@ void onRemoveFromQueue() {
     }
 }
 void onValueChanged(const Value *pValue) {
+    watchListValueChanged(pValue);
     if (isSubscribedTo(MESSAGE_TO_DEBUGGER_VALUE_CHANGED)) {
         char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%p\t",
@@ -6605,6 +6743,60 @@ using namespace eez::gui;
 namespace eez {
 namespace flow {
 EvalStack g_stack;
+void evalArrayElement() {
+    auto elementIndexValue = g_stack.pop().getValue();
+    auto arrayValue = g_stack.pop().getValue();
+    if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
+        g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
+    } else {
+        if (arrayValue.isArray()) {
+            auto array = arrayValue.getArray();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
+                    g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                } else {
+                    g_stack.push(Value::makeError());
+                    g_stack.setErrorMessage("Array element index out of bounds\n");
+                }
+            } else {
+                g_stack.push(Value::makeError());
+                g_stack.setErrorMessage("Integer value expected for array element index\n");
+            }
+        } else if (arrayValue.isBlob()) {
+            auto blobRef = arrayValue.getBlob();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
+                    g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                } else {
+                    g_stack.push(Value::makeError());
+                    g_stack.setErrorMessage("Blob element index out of bounds\n");
+                }
+            } else {
+                g_stack.push(Value::makeError());
+                g_stack.setErrorMessage("Integer value expected for blob element index\n");
+            }
+        } else {
+            g_stack.push(Value::makeError());
+            g_stack.setErrorMessage("Array value expected\n");
+        }
+    }
+}
+void setResultDstValueType(uint32_t dstValueType) {
+    if (g_stack.sp == 1) {
+        auto finalResult = g_stack.pop();
+        if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
+            finalResult.dstValueType = dstValueType;
+        } else if (finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
+            auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
+            arrayElementValue->dstValueType = dstValueType;
+        }
+        g_stack.push(finalResult);
+    }
+}
 static void evalExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes) {
 	auto flowDefinition = flowState->flowDefinition;
 	auto flow = flowState->flow;
@@ -6632,62 +6824,13 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
 			g_stack.push(Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT));
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
-			auto elementIndexValue = g_stack.pop().getValue();
-			auto arrayValue = g_stack.pop().getValue();
-            if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
-                g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
-            } else {
-                if (arrayValue.isArray()) {
-                    auto array = arrayValue.getArray();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Array element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for array element index\n");
-                    }
-                } else if (arrayValue.isBlob()) {
-                    auto blobRef = arrayValue.getBlob();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Blob element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for blob element index\n");
-                    }
-                } else {
-                    g_stack.push(Value::makeError());
-                    g_stack.setErrorMessage("Array value expected\n");
-                }
-            }
+            evalArrayElement();
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
 			g_evalOperations[instructionArg](g_stack);
 		} else {
             if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
     			i += 2;
-                if (g_stack.sp == 1) {
-                    auto finalResult = g_stack.pop();
-                    #define VALUE_TYPE (instructions[i] + (instructions[i + 1] << 8) + (instructions[i + 2] << 16) + (instructions[i + 3] << 24))
-                    if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
-                        finalResult.dstValueType = VALUE_TYPE;
-                    } else if (finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
-                        auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
-                        arrayElementValue->dstValueType = VALUE_TYPE;
-                    }
-                    g_stack.push(finalResult);
-                }
+                setResultDstValueType(instructions[i] + (instructions[i + 1] << 8) + (instructions[i + 2] << 16) + (instructions[i + 3] << 24));
                 i += 4;
                 break;
             } else {
@@ -6769,6 +6912,38 @@ bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *ins
     throwError(flowState, componentIndex, flowError);
 	return false;
 }
+static bool evalProgram(FlowState *flowState, int componentIndex, const ExprProgram *program, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
+	if (numInstructionBytes) {
+		*numInstructionBytes = program->numInstructionBytes;
+	}
+    if (program->constant) {
+        result = *program->constant;
+        return true;
+    }
+    size_t savedSp = g_stack.sp;
+    FlowState *savedFlowState = g_stack.flowState;
+	int savedComponentIndex = g_stack.componentIndex;
+	const int32_t *savedIterators = g_stack.iterators;
+    const char *savedErrorMessage = g_stack.errorMessage;
+	g_stack.flowState = flowState;
+	g_stack.componentIndex = componentIndex;
+	g_stack.iterators = iterators;
+    g_stack.errorMessage = nullptr;
+	runExprProgram(flowState, program);
+	g_stack.flowState = savedFlowState;
+	g_stack.componentIndex = savedComponentIndex;
+	g_stack.iterators = savedIterators;
+    g_stack.errorMessage = savedErrorMessage;
+    if (g_stack.sp == savedSp + 1) {
+        result = g_stack.pop().getValue();
+        if (!result.isError()) {
+            return true;
+        }
+    }
+    FlowError flowError = errorMessage.setDescription(g_stack.errorMessage);
+    throwError(flowState, componentIndex, flowError);
+	return false;
+}
 bool evalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes, const int32_t *iterators) {
     FlowState *savedFlowState = g_stack.flowState;
 	int savedComponentIndex = g_stack.componentIndex;
@@ -6820,9 +6995,16 @@ bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, V
         throwError(flowState, componentIndex, flowError);
         return false;
     }
+    auto program = getPropertyProgram(flowState, componentIndex, propertyIndex);
 #if EEZ_OPTION_GUI
+    if (program && operation == DATA_OPERATION_GET) {
+        return evalProgram(flowState, componentIndex, program, result, errorMessage, numInstructionBytes, iterators);
+    }
     return evalExpression(flowState, componentIndex, component->properties[propertyIndex]->evalInstructions, result, errorMessage, numInstructionBytes, iterators, operation);
 #else
+    if (program) {
+        return evalProgram(flowState, componentIndex, program, result, errorMessage, numInstructionBytes, iterators);
+    }
     return evalExpression(flowState, componentIndex, component->properties[propertyIndex]->evalInstructions, result, errorMessage, numInstructionBytes, iterators);
 #endif
 }
@@ -6883,6 +7065,9 @@ int16_t getNativeVariableId(const WidgetCursor &widgetCursor) {
 // flow/flow.cpp
 // -----------------------------------------------------------------------------
 #include <stdio.h>
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#endif
 #if EEZ_OPTION_GUI
 using namespace eez::gui;
 #endif
@@ -6898,6 +7083,12 @@ uint32_t g_wasmModuleId = 0;
 #endif
 static const uint32_t FLOW_TICK_MAX_DURATION_MS = EEZ_FLOW_TICK_MAX_DURATION_MS;
 static unsigned g_tick_max_duration_count = 0;
+// Tick budgets are in microseconds; millis() is the LVGL tick here, too coarse for them
+#if defined(ESP_PLATFORM)
+static inline uint32_t tickTimeUs() { return (uint32_t)esp_timer_get_time(); }
+#else
+static inline uint32_t tickTimeUs() { return millis() * 1000; }
+#endif
 int g_selectedLanguage = 0;
 FlowState *g_firstFlowState;
 FlowState *g_lastFlowState;
@@ -6912,21 +7103,26 @@ unsigned start(Assets *assets) {
     g_isStopped = false;
     g_isStopping = false;
     initGlobalVariables(assets);
-	queueReset();
+    compileExpressions(assets);
+	queueInit(assets);
     watchListReset();
 	scpiComponentInitHook();
 	onStarted(assets);
 	return 1;
 }
 void tick() {
+    tick(FLOW_TICK_MAX_DURATION_MS * 1000);
+}
+bool tick(uint32_t budgetUs) {
 	if (isFlowStopped()) {
-		return;
+		return false;
 	}
     if (g_isStopping) {
         doStop();
-        return;
+        return false;
     }
-	uint32_t startTickCount = millis();
+	uint32_t startTickUs = tickTimeUs();
+    bool heldByDebugger = false;
     visitWatchList();
     auto queueSizeAtTickStart = getQueueSize();
     for (size_t i = 0; i < queueSizeAtTickStart || g_numNonContinuousTaskInQueue > 0; i++) {
@@ -6941,6 +7137,7 @@ void tick() {
             continue;
         }
 		if (!continuousTask && !canExecuteStep(flowState, componentIndex)) {
+            heldByDebugger = true;
 			break;
 		}
 		removeNextTaskFromQueue();
@@ -6965,11 +7162,10 @@ void tick() {
         if (canFreeFlowState(flowState)) {
             freeFlowState(flowState);
         }
-        if ((i + 1) % 5 == 0) {
-            if (millis() - startTickCount >= FLOW_TICK_MAX_DURATION_MS) {
-                g_tick_max_duration_count++;
-                break;
-            }
+        // Out of budget: what is left stays queued for the next tick
+        if (tickTimeUs() - startTickUs >= budgetUs) {
+            g_tick_max_duration_count++;
+            break;
         }
 	}
 	finishToDebuggerMessageHook();
@@ -6978,6 +7174,8 @@ void tick() {
             freeFlowState(flowState);
         }
     }
+    // Work the debugger holds back is not "carried": nothing runs until it resumes
+    return !heldByDebugger && g_numNonContinuousTaskInQueue > 0;
 }
 void stop() {
     g_isStopping = true;
@@ -6990,7 +7188,8 @@ void doStop() {
     g_firstFlowState = nullptr;
     g_lastFlowState = nullptr;
     g_isStopped = true;
-	queueReset();
+	queueFree();
+    freeExpressions();
     watchListReset();
 }
 bool isFlowStopped() {
@@ -7082,6 +7281,7 @@ void setGlobalVariable(Assets *assets, uint32_t globalVariableIndex, const Value
     if (globalVariableIndex >= 0 && globalVariableIndex < assets->flowDefinition->globalVariables.count) {
         if (g_globalVariables) {
             g_globalVariables->values[globalVariableIndex] = value;
+            watchListValueChanged(g_globalVariables->values + globalVariableIndex);
         } else {
             *assets->flowDefinition->globalVariables[globalVariableIndex] = value;
         }
@@ -7639,6 +7839,12 @@ void eez_flow_init_style_names(const char **styleNames, size_t numStyles) {
 extern "C" void eez_flow_tick() {
     eez::flow::tick();
 }
+extern "C" bool eez_flow_tick_budget(uint32_t budget_us) {
+    return eez::flow::tick(budget_us);
+}
+extern "C" bool eez_flow_has_timed_work() {
+    return eez::flow::getQueueSize() > 0;
+}
 extern "C" bool eez_flow_is_stopped() {
     return eez::flow::isFlowStopped();
 }
@@ -10169,6 +10375,361 @@ EvalOperation g_evalOperations[] = {
 } 
 } 
 // -----------------------------------------------------------------------------
+// flow/expression_program.cpp
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+#if !defined(EEZ_FLOW_EXPR_MAX_OPS)
+#define EEZ_FLOW_EXPR_MAX_OPS 64
+#endif
+static const unsigned NUM_EVAL_OPERATIONS = sizeof(g_evalOperations) / sizeof(g_evalOperations[0]);
+// Operations that depend only on their operands, and how many they pop. Others
+// (Date.now, System.getTick, Flow.*, events, variadic ones) are never folded.
+static const struct {
+    EvalOperation operation;
+    uint8_t numArgs;
+} PURE_OPERATIONS[] = {
+    { do_OPERATION_TYPE_ADD, 2 },
+    { do_OPERATION_TYPE_SUB, 2 },
+    { do_OPERATION_TYPE_MUL, 2 },
+    { do_OPERATION_TYPE_DIV, 2 },
+    { do_OPERATION_TYPE_MOD, 2 },
+    { do_OPERATION_TYPE_LEFT_SHIFT, 2 },
+    { do_OPERATION_TYPE_RIGHT_SHIFT, 2 },
+    { do_OPERATION_TYPE_BINARY_AND, 2 },
+    { do_OPERATION_TYPE_BINARY_OR, 2 },
+    { do_OPERATION_TYPE_BINARY_XOR, 2 },
+    { do_OPERATION_TYPE_EQUAL, 2 },
+    { do_OPERATION_TYPE_NOT_EQUAL, 2 },
+    { do_OPERATION_TYPE_LESS, 2 },
+    { do_OPERATION_TYPE_GREATER, 2 },
+    { do_OPERATION_TYPE_LESS_OR_EQUAL, 2 },
+    { do_OPERATION_TYPE_GREATER_OR_EQUAL, 2 },
+    { do_OPERATION_TYPE_LOGICAL_AND, 2 },
+    { do_OPERATION_TYPE_LOGICAL_OR, 2 },
+    { do_OPERATION_TYPE_UNARY_PLUS, 1 },
+    { do_OPERATION_TYPE_UNARY_MINUS, 1 },
+    { do_OPERATION_TYPE_BINARY_ONE_COMPLEMENT, 1 },
+    { do_OPERATION_TYPE_NOT, 1 },
+    { do_OPERATION_TYPE_CONDITIONAL, 3 },
+    { do_OPERATION_TYPE_MATH_SIN, 1 },
+    { do_OPERATION_TYPE_MATH_COS, 1 },
+    { do_OPERATION_TYPE_MATH_LOG, 1 },
+    { do_OPERATION_TYPE_MATH_LOG10, 1 },
+    { do_OPERATION_TYPE_MATH_ABS, 1 },
+    { do_OPERATION_TYPE_MATH_FLOOR, 1 },
+    { do_OPERATION_TYPE_MATH_CEIL, 1 },
+    { do_OPERATION_TYPE_MATH_POW, 2 },
+};
+static void exprPushConstant(FlowState *flowState, const ExprOp &op) {
+    g_stack.push(*op.value);
+}
+// Same as exprPushConstant, for values the compiler made and frees
+static void exprPushFolded(FlowState *flowState, const ExprOp &op) {
+    g_stack.push(*op.value);
+}
+static void exprPushInput(FlowState *flowState, const ExprOp &op) {
+    g_stack.push(flowState->values[op.arg]);
+}
+static void exprPushLocalVar(FlowState *flowState, const ExprOp &op) {
+    g_stack.push(&flowState->values[op.arg]);
+}
+static void exprPushGlobalVar(FlowState *flowState, const ExprOp &op) {
+    if (g_globalVariables) {
+        g_stack.push(g_globalVariables->values + op.arg);
+    } else {
+        g_stack.push(flowState->flowDefinition->globalVariables[op.arg]);
+    }
+}
+static void exprPushNativeVar(FlowState *flowState, const ExprOp &op) {
+    g_stack.push(Value((int)op.arg, VALUE_TYPE_NATIVE_VARIABLE));
+}
+static void exprPushOutput(FlowState *flowState, const ExprOp &op) {
+    g_stack.push(Value((uint16_t)op.arg, VALUE_TYPE_FLOW_OUTPUT));
+}
+static void exprArrayElement(FlowState *flowState, const ExprOp &op) {
+    evalArrayElement();
+}
+static void exprOperation(FlowState *flowState, const ExprOp &op) {
+    op.operation(g_stack);
+}
+static FlowDefinition *g_exprFlowDefinition;
+static uint32_t *g_exprFlowBase;       // per flow: index of its first component below
+static uint32_t *g_exprComponentBase;  // per component: index of its first property program
+static ExprProgram *g_exprPrograms;
+static uint32_t g_exprNumPrograms;
+static inline bool isConstantPush(const ExprOp &op) {
+    return op.handler == exprPushConstant || op.handler == exprPushFolded;
+}
+static void freeFoldedValue(const Value *value) {
+    ObjectAllocator<Value>::deallocate(const_cast<Value *>(value));
+}
+static int getPureOperationArgs(EvalOperation operation) {
+    for (auto &pure : PURE_OPERATIONS) {
+        if (pure.operation == operation) {
+            return pure.numArgs;
+        }
+    }
+    return -1;
+}
+// Evaluates operation over the constants pushed by the last numArgs ops and, if that
+// gives a value, replaces them with it. Only the operands are on the stack here.
+static bool foldOperation(ExprOp *ops, unsigned &numOps, EvalOperation operation, int numArgs) {
+    if (numArgs < 0 || (unsigned)numArgs > numOps) {
+        return false;
+    }
+    for (unsigned i = numOps - numArgs; i < numOps; i++) {
+        if (!isConstantPush(ops[i])) {
+            return false;
+        }
+    }
+    auto savedSp = g_stack.sp;
+    for (unsigned i = numOps - numArgs; i < numOps; i++) {
+        g_stack.push(*ops[i].value);
+    }
+    operation(g_stack);
+    Value value;
+    bool folded = false;
+    if (g_stack.sp == savedSp + 1) {
+        value = g_stack.pop();
+        folded = !value.isError();
+    }
+    g_stack.sp = savedSp;
+    g_stack.errorMessage = nullptr;
+    if (!folded) {
+        return false;
+    }
+    auto foldedValue = ObjectAllocator<Value>::allocate(0x6c1e90b4);
+    if (!foldedValue) {
+        return false;
+    }
+    *foldedValue = value;
+    for (unsigned i = numOps - numArgs; i < numOps; i++) {
+        if (ops[i].handler == exprPushFolded) {
+            freeFoldedValue(ops[i].value);
+        }
+    }
+    numOps -= numArgs;
+    ops[numOps].handler = exprPushFolded;
+    ops[numOps].value = foldedValue;
+    numOps++;
+    return true;
+}
+static void freeProgramOps(ExprOp *ops, unsigned numOps) {
+    for (unsigned i = 0; i < numOps; i++) {
+        if (ops[i].handler == exprPushFolded) {
+            freeFoldedValue(ops[i].value);
+        }
+    }
+}
+// Decodes instructions as evalExpression() would run them. False leaves the
+// property to the interpreter (unknown operand, program too long, out of memory).
+static bool compileExpression(FlowDefinition *flowDefinition, Flow *flow, const uint8_t *instructions, ExprProgram &program) {
+    ExprOp ops[EEZ_FLOW_EXPR_MAX_OPS + 1];
+    unsigned numOps = 0;
+    int i = 0;
+    while (true) {
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+		auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+        if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+            if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
+                program.hasDstValueType = true;
+                program.dstValueType = instructions[i + 2] + (instructions[i + 3] << 8) + (instructions[i + 4] << 16) + (instructions[i + 5] << 24);
+                i += 6;
+            } else {
+                i += 2;
+            }
+            break;
+        }
+        if (numOps == EEZ_FLOW_EXPR_MAX_OPS) {
+            freeProgramOps(ops, numOps);
+            return false;
+        }
+        auto &op = ops[numOps];
+		if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
+            if ((uint32_t)instructionArg >= flowDefinition->constants.count) {
+                freeProgramOps(ops, numOps);
+                return false;
+            }
+            op.handler = exprPushConstant;
+            op.value = flowDefinition->constants[instructionArg];
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+            op.handler = exprPushInput;
+            op.arg = instructionArg;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+            op.handler = exprPushLocalVar;
+            op.arg = flow->componentInputs.count + instructionArg;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+			if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
+                op.handler = exprPushGlobalVar;
+                op.arg = instructionArg;
+            } else {
+                op.handler = exprPushNativeVar;
+                op.arg = instructionArg - flowDefinition->globalVariables.count + 1;
+            }
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
+            op.handler = exprPushOutput;
+            op.arg = instructionArg;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
+            op.handler = exprArrayElement;
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+            if ((unsigned)instructionArg >= NUM_EVAL_OPERATIONS) {
+                freeProgramOps(ops, numOps);
+                return false;
+            }
+            auto operation = g_evalOperations[instructionArg];
+            if (foldOperation(ops, numOps, operation, getPureOperationArgs(operation))) {
+                i += 2;
+                continue;
+            }
+            op.handler = exprOperation;
+            op.operation = operation;
+		}
+        numOps++;
+		i += 2;
+    }
+    program.numInstructionBytes = i;
+    if (numOps == 1 && isConstantPush(ops[0]) && !program.hasDstValueType) {
+        program.constant = ops[0].value;
+        program.ownsConstant = ops[0].handler == exprPushFolded;
+        return true;
+    }
+    program.ops = (ExprOp *)alloc((numOps + 1) * sizeof(ExprOp), 0x3f0b7d52);
+    if (!program.ops) {
+        freeProgramOps(ops, numOps);
+        return false;
+    }
+    ops[numOps].handler = nullptr;
+    memcpy(program.ops, ops, (numOps + 1) * sizeof(ExprOp));
+    return true;
+}
+// Only expressions that are constant outright are evaluated here; other results are
+// not cached between runs. Writes are change-stamped (see watchListValueChanged()),
+// but a program is shared by every FlowState of its flow and every list iteration,
+// so a cache would need a slot per instance. And it would rarely hit: watches are
+// already skipped on the same stamps when nothing they read changed, and any other
+// property is evaluated when its component runs, just after an input write has
+// bumped g_valuesVersion. (The per-tick _eval*Property() bindings would gain, but
+// this UI's screens bind through LVGL subjects and never call them.)
+void compileExpressions(Assets *assets) {
+    freeExpressions();
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    uint32_t numComponents = 0;
+    uint32_t numPrograms = 0;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        auto flow = flowDefinition->flows[flowIndex];
+        numComponents += flow->components.count;
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            numPrograms += flow->components[componentIndex]->properties.count;
+        }
+    }
+    g_exprFlowBase = (uint32_t *)alloc(flowDefinition->flows.count * sizeof(uint32_t), 0x3f0b7d53);
+    g_exprComponentBase = (uint32_t *)alloc(numComponents * sizeof(uint32_t), 0x3f0b7d54);
+    g_exprPrograms = (ExprProgram *)alloc(numPrograms * sizeof(ExprProgram), 0x3f0b7d55);
+    if (!g_exprFlowBase || (numComponents && !g_exprComponentBase) || (numPrograms && !g_exprPrograms)) {
+        freeExpressions();
+        return;
+    }
+    memset(g_exprPrograms, 0, numPrograms * sizeof(ExprProgram));
+    g_exprNumPrograms = numPrograms;
+    g_exprFlowDefinition = flowDefinition;
+    // Folding runs operations on g_stack, which is otherwise idle at start()
+    auto savedFlowState = g_stack.flowState;
+    g_stack.flowState = nullptr;
+    uint32_t componentBase = 0;
+    uint32_t programIndex = 0;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        auto flow = flowDefinition->flows[flowIndex];
+        g_exprFlowBase[flowIndex] = componentBase;
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            auto component = flow->components[componentIndex];
+            g_exprComponentBase[componentBase++] = programIndex;
+            for (uint32_t propertyIndex = 0; propertyIndex < component->properties.count; propertyIndex++) {
+                auto &program = g_exprPrograms[programIndex++];
+                if (!compileExpression(flowDefinition, flow, component->properties[propertyIndex]->evalInstructions, program)) {
+                    memset(&program, 0, sizeof(program));
+                }
+            }
+        }
+    }
+    g_stack.flowState = savedFlowState;
+}
+void freeExpressions() {
+    for (uint32_t i = 0; i < g_exprNumPrograms; i++) {
+        auto &program = g_exprPrograms[i];
+        if (program.ops) {
+            unsigned numOps = 0;
+            while (program.ops[numOps].handler) {
+                numOps++;
+            }
+            freeProgramOps(program.ops, numOps);
+            free(program.ops);
+        }
+        if (program.ownsConstant) {
+            freeFoldedValue(program.constant);
+        }
+    }
+    free(g_exprPrograms);
+    free(g_exprComponentBase);
+    free(g_exprFlowBase);
+    g_exprPrograms = nullptr;
+    g_exprComponentBase = nullptr;
+    g_exprFlowBase = nullptr;
+    g_exprNumPrograms = 0;
+    g_exprFlowDefinition = nullptr;
+}
+const ExprProgram *getPropertyProgram(FlowState *flowState, int componentIndex, int propertyIndex) {
+    if (!g_exprPrograms || flowState->flowDefinition != g_exprFlowDefinition) {
+        return nullptr;
+    }
+    auto &program = g_exprPrograms[g_exprComponentBase[g_exprFlowBase[flowState->flowIndex] + componentIndex] + propertyIndex];
+    return program.ops || program.constant ? &program : nullptr;
+}
+void getExprProgramReads(FlowDefinition *flowDefinition, const ExprProgram *program, ExprReads &reads) {
+    memset(&reads, 0, sizeof(reads));
+    if (!program->ops) {
+        return;
+    }
+    for (auto op = program->ops; op->handler; op++) {
+        if (op->handler == exprPushInput || op->handler == exprPushLocalVar || op->handler == exprArrayElement) {
+            reads.values = true;
+        } else if (op->handler == exprPushNativeVar) {
+            reads.anything = true;
+        } else if (op->handler == exprOperation) {
+            if (getPureOperationArgs(op->operation) < 0) {
+                reads.anything = true;
+            }
+        } else if (op->handler == exprPushGlobalVar) {
+            // Arrays and blobs can change in place, through writes that are not to the variable
+            auto defaultValue = flowDefinition->globalVariables[op->arg];
+            if (defaultValue->isArray() || defaultValue->isBlob() || defaultValue->isUndefinedOrNull()) {
+                reads.values = true;
+            }
+            unsigned i;
+            for (i = 0; i < reads.numGlobals && reads.globals[i] != op->arg; i++) {
+            }
+            if (i == reads.numGlobals) {
+                if (reads.numGlobals == EXPR_READS_MAX_GLOBALS) {
+                    reads.anything = true;
+                } else {
+                    reads.globals[reads.numGlobals++] = op->arg;
+                }
+            }
+        }
+    }
+}
+void runExprProgram(FlowState *flowState, const ExprProgram *program) {
+    for (auto op = program->ops; op->handler; op++) {
+        op->handler(flowState, *op);
+    }
+    if (program->hasDstValueType) {
+        setResultDstValueType(program->dstValueType);
+    }
+}
+} 
+} 
+// -----------------------------------------------------------------------------
 // flow/private.cpp
 // -----------------------------------------------------------------------------
 #include <stdio.h>
@@ -10273,6 +10834,7 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 			sizeof(FlowState) +
 			nValues * sizeof(Value) +
 			flow->components.count * sizeof(ComponenentExecutionState *) +
+			flow->components.count * sizeof(uint16_t) +
 			flow->components.count * sizeof(bool),
 			0x4c3b6ef5
 		)
@@ -10322,7 +10884,10 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
     flowState->nextSibling = nullptr;
 	flowState->values = (Value *)(flowState + 1);
 	flowState->componenentExecutionStates = (ComponenentExecutionState **)(flowState->values + nValues);
-    flowState->componenentAsyncStates = (bool *)(flowState->componenentExecutionStates + flow->components.count);
+    flowState->componentQueueCounts = (uint16_t *)(flowState->componenentExecutionStates + flow->components.count);
+    flowState->componenentAsyncStates = (bool *)(flowState->componentQueueCounts + flow->components.count);
+    flowState->firstQueueTask = NO_QUEUE_TASK;
+    flowState->lastQueueTask = NO_QUEUE_TASK;
 	for (unsigned i = 0; i < nValues; i++) {
 		new (flowState->values + i) Value();
 	}
@@ -10336,6 +10901,7 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 	}
 	for (unsigned i = 0; i < flow->components.count; i++) {
 		flowState->componenentExecutionStates[i] = nullptr;
+		flowState->componentQueueCounts[i] = 0;
 		flowState->componenentAsyncStates[i] = false;
 	}
 	onFlowStateCreated(flowState);
@@ -10854,53 +11420,127 @@ namespace flow {
 #if !defined(EEZ_FLOW_QUEUE_SIZE)
 #define EEZ_FLOW_QUEUE_SIZE 1000
 #endif
-static const unsigned QUEUE_SIZE = EEZ_FLOW_QUEUE_SIZE;
-static struct {
+#if !defined(EEZ_FLOW_QUEUE_MIN_SIZE)
+#define EEZ_FLOW_QUEUE_MIN_SIZE 32
+#endif
+// Tasks live in a pool sized from the flow definition at start() and doubled, up
+// to EEZ_FLOW_QUEUE_SIZE, if a project needs more. They are linked twice: into the
+// execution order and into a chain per flow state, so freeing a flow state only
+// visits its own tasks. Each flow state also counts queued tasks per component,
+// which makes isInQueue() a lookup.
+static const unsigned QUEUE_MAX_SIZE = EEZ_FLOW_QUEUE_SIZE < NO_QUEUE_TASK ? EEZ_FLOW_QUEUE_SIZE : NO_QUEUE_TASK;
+struct QueueTask {
 	FlowState *flowState;
 	unsigned componentIndex;
+    uint16_t next;
+    uint16_t nextInFlowState;
     bool continuousTask;
-} g_queue[QUEUE_SIZE];
-static unsigned g_queueHead;
-static unsigned g_queueTail;
+};
+static QueueTask *g_queue;
+static unsigned g_queueCapacity;
+static uint16_t g_queueHead;
+static uint16_t g_queueTail;
+static uint16_t g_queueFree;
+static unsigned g_queueSize;
 static unsigned g_queueMax;
-static bool g_queueIsFull = false;
 unsigned g_numNonContinuousTaskInQueue;
+static void queueLinkFree(unsigned from, unsigned to) {
+    for (unsigned i = from; i < to; i++) {
+        g_queue[i].next = i + 1 < to ? i + 1 : g_queueFree;
+    }
+    if (from < to) {
+        g_queueFree = from;
+    }
+}
+static bool queueGrow() {
+    if (g_queueCapacity >= QUEUE_MAX_SIZE) {
+        return false;
+    }
+    unsigned capacity = g_queueCapacity ? 2 * g_queueCapacity : EEZ_FLOW_QUEUE_MIN_SIZE;
+    if (capacity > QUEUE_MAX_SIZE) {
+        capacity = QUEUE_MAX_SIZE;
+    }
+    auto queue = (QueueTask *)alloc(capacity * sizeof(QueueTask), 0x5d1e47a3);
+    if (!queue) {
+        return false;
+    }
+    if (g_queue) {
+        memcpy(queue, g_queue, g_queueCapacity * sizeof(QueueTask));
+        free(g_queue);
+    }
+    g_queue = queue;
+    queueLinkFree(g_queueCapacity, capacity);
+    g_queueCapacity = capacity;
+    return true;
+}
+void queueInit(Assets *assets) {
+    queueFree();
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    unsigned components = 0;
+    for (unsigned i = 0; i < flowDefinition->flows.count; i++) {
+        components += flowDefinition->flows[i]->components.count;
+    }
+    // One pending task per component of every flow is the common worst case
+    unsigned capacity = components < EEZ_FLOW_QUEUE_MIN_SIZE ? EEZ_FLOW_QUEUE_MIN_SIZE : components;
+    if (capacity > QUEUE_MAX_SIZE) {
+        capacity = QUEUE_MAX_SIZE;
+    }
+    g_queue = (QueueTask *)alloc(capacity * sizeof(QueueTask), 0x5d1e47a3);
+    g_queueCapacity = g_queue ? capacity : 0;
+    queueReset();
+}
 void queueReset() {
-	g_queueHead = 0;
-	g_queueTail = 0;
+	g_queueHead = NO_QUEUE_TASK;
+	g_queueTail = NO_QUEUE_TASK;
+    g_queueFree = NO_QUEUE_TASK;
+    queueLinkFree(0, g_queueCapacity);
+    g_queueSize = 0;
 	g_queueMax  = 0;
-	g_queueIsFull = false;
     g_numNonContinuousTaskInQueue = 0;
 }
+void queueFree() {
+    free(g_queue);
+    g_queue = nullptr;
+    g_queueCapacity = 0;
+    queueReset();
+}
 size_t getQueueSize() {
-	if (g_queueHead == g_queueTail) {
-		if (g_queueIsFull) {
-			return QUEUE_SIZE;
-		}
-		return 0;
-	}
-	if (g_queueHead < g_queueTail) {
-		return g_queueTail - g_queueHead;
-	}
-	return QUEUE_SIZE - g_queueHead + g_queueTail;
+	return g_queueSize;
 }
 size_t getMaxQueueSize() {
 	return g_queueMax;
 }
+size_t getQueueCapacity() {
+	return g_queueCapacity;
+}
 bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex, bool continuousTask) {
-	if (g_queueIsFull) {
+	if (g_queueFree == NO_QUEUE_TASK && !queueGrow()) {
         throwError(flowState, componentIndex, "Execution queue is full\n");
 		return false;
 	}
-	g_queue[g_queueTail].flowState = flowState;
-	g_queue[g_queueTail].componentIndex = componentIndex;
-    g_queue[g_queueTail].continuousTask = continuousTask;
-	g_queueTail = (g_queueTail + 1) % QUEUE_SIZE;
-	if (g_queueHead == g_queueTail) {
-		g_queueIsFull = true;
-	}
-	size_t queueSize = getQueueSize();
-	g_queueMax = g_queueMax < queueSize ? queueSize : g_queueMax;
+    auto index = g_queueFree;
+    auto &task = g_queue[index];
+    g_queueFree = task.next;
+	task.flowState = flowState;
+	task.componentIndex = componentIndex;
+    task.continuousTask = continuousTask;
+    task.next = NO_QUEUE_TASK;
+    task.nextInFlowState = NO_QUEUE_TASK;
+    if (g_queueTail != NO_QUEUE_TASK) {
+        g_queue[g_queueTail].next = index;
+    } else {
+        g_queueHead = index;
+    }
+    g_queueTail = index;
+    if (flowState->lastQueueTask != NO_QUEUE_TASK) {
+        g_queue[flowState->lastQueueTask].nextInFlowState = index;
+    } else {
+        flowState->firstQueueTask = index;
+    }
+    flowState->lastQueueTask = index;
+    flowState->componentQueueCounts[componentIndex]++;
+	g_queueSize++;
+	g_queueMax = g_queueMax < g_queueSize ? g_queueSize : g_queueMax;
     if (!continuousTask) {
         ++g_numNonContinuousTaskInQueue;
 	    onAddToQueue(flowState, sourceComponentIndex, sourceOutputIndex, componentIndex, targetInputIndex);
@@ -10909,7 +11549,7 @@ bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceCompone
 	return true;
 }
 bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+	if (g_queueHead == NO_QUEUE_TASK) {
 		return false;
 	}
 	flowState = g_queue[g_queueHead].flowState;
@@ -10918,46 +11558,42 @@ bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool
 	return true;
 }
 void removeNextTaskFromQueue() {
-	auto flowState = g_queue[g_queueHead].flowState;
-    decRefCounterForFlowState(flowState);
-    auto continuousTask = g_queue[g_queueHead].continuousTask;
-	g_queueHead = (g_queueHead + 1) % QUEUE_SIZE;
-	g_queueIsFull = false;
+    auto index = g_queueHead;
+    auto &task = g_queue[index];
+	auto flowState = task.flowState;
+    if (flowState) {
+        // Queue order is kept per flow state too, so this is its first task
+        flowState->firstQueueTask = task.nextInFlowState;
+        if (flowState->firstQueueTask == NO_QUEUE_TASK) {
+            flowState->lastQueueTask = NO_QUEUE_TASK;
+        }
+        flowState->componentQueueCounts[task.componentIndex]--;
+        decRefCounterForFlowState(flowState);
+    }
+    auto continuousTask = task.continuousTask;
+	g_queueHead = task.next;
+    if (g_queueHead == NO_QUEUE_TASK) {
+        g_queueTail = NO_QUEUE_TASK;
+    }
+    task.next = g_queueFree;
+    g_queueFree = index;
+    g_queueSize--;
     if (!continuousTask) {
         --g_numNonContinuousTaskInQueue;
 	    onRemoveFromQueue();
     }
 }
 bool isInQueue(FlowState *flowState, unsigned componentIndex) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return false;
-	}
-    unsigned int it = g_queueHead;
-    while (true) {
-		if (g_queue[it].flowState == flowState && g_queue[it].componentIndex == componentIndex) {
-            return true;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
-            break;
-        }
-	}
-    return false;
+    return flowState->componentQueueCounts[componentIndex] > 0;
 }
 void removeTasksFromQueueForFlowState(FlowState *flowState) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return;
-	}
-    unsigned int it = g_queueHead;
-    while (true) {
-		if (g_queue[it].flowState == flowState) {
-            g_queue[it].flowState = 0;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
-            break;
-        }
-	}
+    // The tasks stay in the execution order, ownerless, until tick() pops them
+    for (auto it = flowState->firstQueueTask; it != NO_QUEUE_TASK; it = g_queue[it].nextInFlowState) {
+        flowState->componentQueueCounts[g_queue[it].componentIndex]--;
+        g_queue[it].flowState = nullptr;
+    }
+    flowState->firstQueueTask = NO_QUEUE_TASK;
+    flowState->lastQueueTask = NO_QUEUE_TASK;
 }
 } 
 } 
@@ -10967,11 +11603,22 @@ void removeTasksFromQueueForFlowState(FlowState *flowState) {
 namespace eez {
 namespace flow {
 void executeWatchVariableComponent(FlowState *flowState, unsigned componentIndex);
+// Watches re-evaluate only when something they read was written since their last
+// run. Writes to existing flow values are stamped with g_watchClock by
+// watchListValueChanged(): per global variable, or in g_valuesVersion for anything
+// else (inputs, local variables, array elements). onValueChanged() and
+// setGlobalVariable() stamp for the writes that go through them; any other in-place
+// write must call it itself (the line chart replaying array elements into its value
+// input does). Values only ever written while being created -- new flow states,
+// fresh arrays -- need no stamp. A watch whose expression could not be analysed, or
+// reads native variables or time-dependent operations, runs every tick.
 struct WatchListNode {
     FlowState *flowState;
     unsigned componentIndex;
     WatchListNode *prev;
     WatchListNode *next;
+    uint32_t seenVersion;
+    ExprReads reads;
 };
 struct WatchList {
     WatchListNode *first;
@@ -10979,6 +11626,10 @@ struct WatchList {
     unsigned       size;
 };
 static WatchList g_watchList;
+static uint32_t g_watchClock;
+static uint32_t g_valuesVersion;
+static uint32_t *g_globalVersions;
+static uint32_t g_numGlobalVersions;
 WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     auto node = (WatchListNode *)alloc(sizeof(WatchListNode), 0x00864d67);
     node->prev = g_watchList.last;
@@ -10992,6 +11643,25 @@ WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     node->next = 0;
     node->flowState = flowState;
     node->componentIndex = componentIndex;
+    node->seenVersion = g_watchClock;
+    auto flowDefinition = flowState->flowDefinition;
+    auto program = getPropertyProgram(flowState, componentIndex, defs_v3::WATCH_VARIABLE_ACTION_COMPONENT_PROPERTY_VARIABLE);
+    if (!g_globalVersions && g_globalVariables && flowDefinition->globalVariables.count > 0) {
+        g_globalVersions = (uint32_t *)alloc(flowDefinition->globalVariables.count * sizeof(uint32_t), 0x00864d68);
+        if (g_globalVersions) {
+            memset(g_globalVersions, 0, flowDefinition->globalVariables.count * sizeof(uint32_t));
+            g_numGlobalVersions = flowDefinition->globalVariables.count;
+        }
+    }
+    if (program) {
+        getExprProgramReads(flowDefinition, program, node->reads);
+        if (node->reads.numGlobals > 0 && !g_globalVersions) {
+            node->reads.anything = true;
+        }
+    } else {
+        memset(&node->reads, 0, sizeof(node->reads));
+        node->reads.anything = true;
+    }
     incRefCounterForFlowState(flowState);
     (g_watchList.size)++;
     return node;
@@ -11010,10 +11680,38 @@ void watchListRemove(WatchListNode *node) {
     free(node);
     g_watchList.size > 0 ? (g_watchList.size)-- : 0;
 }
+void watchListValueChanged(const Value *pValue) {
+    ++g_watchClock;
+    if (g_globalVersions && g_globalVariables) {
+        auto offset = (uintptr_t)pValue - (uintptr_t)g_globalVariables->values;
+        auto index = offset / sizeof(Value);
+        if ((uintptr_t)pValue >= (uintptr_t)g_globalVariables->values && index < g_numGlobalVersions) {
+            g_globalVersions[index] = g_watchClock;
+            return;
+        }
+    }
+    g_valuesVersion = g_watchClock;
+}
+static bool isWatchDirty(const WatchListNode *node) {
+    auto &reads = node->reads;
+    if (reads.anything) {
+        return true;
+    }
+    if (reads.values && (int32_t)(g_valuesVersion - node->seenVersion) > 0) {
+        return true;
+    }
+    for (unsigned i = 0; i < reads.numGlobals; i++) {
+        if ((int32_t)(g_globalVersions[reads.globals[i]] - node->seenVersion) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
 void visitWatchList() {
     for (auto node = g_watchList.first; node; ) {
         auto nextNode = node->next;
-        if (canExecuteStep(node->flowState, node->componentIndex)) {
+        if (isWatchDirty(node) && canExecuteStep(node->flowState, node->componentIndex)) {
+            node->seenVersion = g_watchClock;
             executeWatchVariableComponent(node->flowState, node->componentIndex);
         }
         decRefCounterForFlowState(node->flowState);
@@ -11032,6 +11730,9 @@ void watchListReset() {
         watchListRemove(node);
         node = nextNode;
     }
+    free(g_globalVersions);
+    g_globalVersions = nullptr;
+    g_numGlobalVersions = 0;
 }
 void removeWatchesForFlowState(FlowState *flowState) {
     for (auto node = g_watchList.first; node;) {
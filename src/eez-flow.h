@@ -211,6 +211,16 @@ template<class T> struct ObjectAllocator {
 void dumpAlloc(scpi_t *context);
 #endif
 void getAllocInfo(uint32_t &free, uint32_t &alloc);
+#if defined(EEZ_FOR_LVGL)
+struct AllocIdInfo {
+    uint32_t id;        // the alloc() id; 0 also collects ids beyond EEZ_ALLOC_STATS_SIZE
+    uint32_t allocs;    // since start
+    uint32_t count;     // live blocks
+    uint32_t bytes;     // live bytes
+    uint32_t peakBytes;
+};
+bool getAllocInfo(unsigned index, AllocIdInfo &info);
+#endif
 } 
 // -----------------------------------------------------------------------------
 // flow/flow_defs_v3.h
@@ -2320,6 +2330,9 @@ struct FlowState {
     Value *values;
 	ComponenentExecutionState **componenentExecutionStates;
     bool *componenentAsyncStates;
+    uint16_t *componentQueueCounts; // tasks queued per component, for isInQueue
+    uint16_t firstQueueTask;        // this flow state's tasks, in queue order
+    uint16_t lastQueueTask;
     unsigned executingComponentIndex;
     float timelinePosition;
 #if defined(EEZ_FOR_LVGL)
@@ -2594,6 +2607,8 @@ bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *ins
 bool evalExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
 #endif
 bool evalAssignableExpression(FlowState *flowState, int componentIndex, const uint8_t *instructions, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
+void evalArrayElement();
+void setResultDstValueType(uint32_t dstValueType);
 #if EEZ_OPTION_GUI
 bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr, eez::gui::DataOperationEnum operation = eez::gui::DATA_OPERATION_GET);
 #else
@@ -2616,6 +2631,8 @@ extern uint32_t g_wasmModuleId;
 struct FlowState;
 unsigned start(Assets *assets);
 void tick();
+// Runs queued components for up to budgetUs; true if any are still waiting
+bool tick(uint32_t budgetUs);
 void stop();
 bool isFlowStopped();
 unsigned getTickMaxDurationCounter();
@@ -2713,13 +2730,57 @@ Value op_great_eq(const Value& a1, const Value& b1);
 } 
 } 
 // -----------------------------------------------------------------------------
+// flow/expression_program.h
+// -----------------------------------------------------------------------------
+namespace eez {
+namespace flow {
+// A property expression decoded once at start(): one handler call per instruction,
+// operands resolved, pure operations on constants already folded
+struct ExprOp;
+typedef void (*ExprHandler)(FlowState *flowState, const ExprOp &op);
+struct ExprOp {
+    ExprHandler handler;
+    union {
+        const Value *value;
+        uint32_t arg;
+        EvalOperation operation;
+    };
+};
+struct ExprProgram {
+    ExprOp *ops;              // ends at a null handler
+    const Value *constant;    // set instead of ops when the whole expression folded
+    uint32_t dstValueType;
+    uint16_t numInstructionBytes;
+    bool hasDstValueType;
+    bool ownsConstant;
+};
+void compileExpressions(Assets *assets);
+void freeExpressions();
+const ExprProgram *getPropertyProgram(FlowState *flowState, int componentIndex, int propertyIndex);
+void runExprProgram(FlowState *flowState, const ExprProgram *program);
+// What a program reads, for the watch list's dependency tracking
+static const unsigned EXPR_READS_MAX_GLOBALS = 4;
+struct ExprReads {
+    uint16_t globals[EXPR_READS_MAX_GLOBALS];
+    uint8_t numGlobals;
+    bool values;      // inputs, local variables, array elements, non-scalar globals
+    bool anything;    // native variables or impure operations: no telling when it changes
+};
+void getExprProgramReads(FlowDefinition *flowDefinition, const ExprProgram *program, ExprReads &reads);
+} 
+} 
+// -----------------------------------------------------------------------------
 // flow/queue.h
 // -----------------------------------------------------------------------------
 namespace eez {
 namespace flow {
+static const uint16_t NO_QUEUE_TASK = 0xFFFF;
+void queueInit(Assets *assets);
 void queueReset();
+void queueFree();
 size_t getQueueSize();
 size_t getMaxQueueSize();
+size_t getQueueCapacity();
 extern unsigned g_numNonContinuousTaskInQueue;
 bool addToQueue(FlowState *flowState, unsigned componentIndex,
     int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex,
@@ -2742,6 +2803,7 @@ void visitWatchList();
 void watchListReset();
 void removeWatchesForFlowState(FlowState *flowState);
 unsigned getWatchListSize();
+void watchListValueChanged(const Value *pValue);
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -3051,6 +3113,8 @@ void eez_flow_init_themes(const char **themeNames, size_t numThemes, void (*chan
 void eez_flow_set_create_screen_func(void (*createScreenFunc)(int screenIndex));
 void eez_flow_set_delete_screen_func(void (*deleteScreenFunc)(int screenIndex));
 void eez_flow_tick();
+bool eez_flow_tick_budget(uint32_t budget_us);   // true: runnable work left over for the next tick
+bool eez_flow_has_timed_work();   // continuous components (Delay, animations) queued
 bool eez_flow_is_stopped();
 extern int16_t g_currentScreen;
 int16_t eez_flow_get_current_screen();
@@ -0,0 +1,159 @@
+#include "frame_sched.h"
+#include <string.h>
+#include "esp_timer.h"
+#include "log.h"
+
+struct Slice {
+    frame_slice_fn fn;
+    frame_slice_stats_t st;
+    uint32_t last_ms;    // start of the last run
+    uint32_t want_ms;    // when the slice asked to run next (valid if wants)
+    bool wants;
+    bool owed;           // deferred last frame: runs first in the next
+    bool ran_once;
+};
+
+// UI loop only
+static Slice g_slices[FRAME_SCHED_MAX_SLICES];   // registration order (= id)
+static uint8_t g_order[FRAME_SCHED_MAX_SLICES];  // ids by priority
+static uint8_t g_count = 0;
+static frame_sched_stats_t g_frame;
+
+static inline uint64_t now_us() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+int frame_sched_add(const char* name, frame_slice_fn fn, uint8_t priority,
+                    uint32_t budget_us, uint32_t period_ms) {
+    if (!fn || g_count >= FRAME_SCHED_MAX_SLICES) return -1;
+
+    const uint8_t id = g_count++;
+    Slice& s = g_slices[id];
+    memset(&s, 0, sizeof(s));
+    s.fn = fn;
+    s.st.name = name;
+    s.st.priority = priority;
+    s.st.budget_us = budget_us;
+    s.st.period_ms = period_ms;
+
+    // After every slice of the same or higher priority (stable)
+    uint8_t at = id;
+    while (at > 0 && g_slices[g_order[at - 1]].st.priority > priority) {
+        g_order[at] = g_order[at - 1];
+        at--;
+    }
+    g_order[at] = id;
+    return id;
+}
+
+static void run_slice(Slice& s, uint32_t now_ms) {
+    const uint64_t t0 = now_us();
+    const uint32_t wait = s.fn(s.st.budget_us);
+    const uint32_t took = (uint32_t)(now_us() - t0);
+
+    s.last_ms = now_ms;
+    s.ran_once = true;
+    s.owed = false;
+    s.wants = wait != FRAME_SCHED_IDLE;
+    s.want_ms = now_ms + (s.wants ? (wait ? wait : FRAME_SCHED_CARRY_MS) : 0);
+
+    s.st.runs++;
+    s.st.total_us += took;
+    if (took > s.st.max_us) s.st.max_us = took;
+    if (took > s.st.budget_us) s.st.overruns++;
+    if (wait == 0) s.st.carried++;
+}
+
+static inline bool period_elapsed(const Slice& s, uint32_t now_ms) {
+    return !s.ran_once || s.st.period_ms == 0 || (uint32_t)(now_ms - s.last_ms) >= s.st.period_ms;
+}
+
+uint32_t frame_sched_run(void) {
+    const uint64_t start = now_us();
+    const uint32_t now_ms = (uint32_t)(start / 1000ULL);
+    bool ran[FRAME_SCHED_MAX_SLICES] = {};
+    bool any = false;
+
+    // Slices held over last frame go first, whatever their priority
+    for (uint8_t k = 0; k < g_count; k++) {
+        const uint8_t i = g_order[k];
+        if (!g_slices[i].owed) continue;
+        run_slice(g_slices[i], now_ms);
+        ran[i] = any = true;
+    }
+
+    for (uint8_t k = 0; k < g_count; k++) {
+        const uint8_t i = g_order[k];
+        Slice& s = g_slices[i];
+        if (ran[i] || !period_elapsed(s, now_ms)) continue;
+        if (any && now_us() - start >= FRAME_SCHED_FRAME_BUDGET_US) {
+            s.owed = true;
+            s.st.deferred++;
+            continue;
+        }
+        run_slice(s, now_ms);
+        ran[i] = any = true;
+    }
+
+    const uint32_t took = (uint32_t)(now_us() - start);
+    g_frame.frames++;
+    g_frame.total_us += took;
+    if (took > g_frame.max_us) g_frame.max_us = took;
+    if (took > FRAME_SCHED_FRAME_BUDGET_US) g_frame.overruns++;
+
+    // Next frame: the earliest slice deadline, pushed back to its period
+    uint32_t wait = FRAME_SCHED_IDLE;
+    const uint32_t end_ms = (uint32_t)(now_us() / 1000ULL);
+    for (uint8_t i = 0; i < g_count; i++) {
+        const Slice& s = g_slices[i];
+        if (s.owed) return 0;
+        if (!s.wants) continue;
+        uint32_t due = s.want_ms;
+        if (s.st.period_ms && (int32_t)(s.last_ms + s.st.period_ms - due) > 0) due = s.last_ms + s.st.period_ms;
+        const int32_t left = (int32_t)(due - end_ms);
+        const uint32_t w = left > 0 ? (uint32_t)left : 0;
+        if (w < wait) wait = w;
+    }
+    return wait;
+}
+
+uint8_t frame_sched_count(void) {
+    return g_count;
+}
+
+bool frame_sched_slice_stats(uint8_t id, frame_slice_stats_t* out) {
+    if (id >= g_count || !out) return false;
+    *out = g_slices[id].st;
+    return true;
+}
+
+void frame_sched_stats(frame_sched_stats_t* out) {
+    if (out) *out = g_frame;
+}
+
+void frame_sched_reset_stats(void) {
+    for (uint8_t i = 0; i < g_count; i++) {
+        frame_slice_stats_t& st = g_slices[i].st;
+        st.runs = st.carried = st.overruns = st.deferred = 0;
+        st.total_us = 0;
+        st.max_us = 0;
+    }
+    memset(&g_frame, 0, sizeof(g_frame));
+}
+
+void frame_sched_log_stats(void) {
+    for (uint8_t k = 0; k < g_count; k++) {
+        const frame_slice_stats_t& st = g_slices[g_order[k]].st;
+        LOGI(SYS, "frame slice %-6s prio=%u budget=%luus runs=%lu avg=%luus max=%luus over=%lu carried=%lu deferred=%lu",
+                  st.name ? st.name : "?", (unsigned)st.priority, (unsigned long)st.budget_us,
+                  (unsigned long)st.runs,
+                  (unsigned long)(st.runs ? st.total_us / st.runs : 0),
+                  (unsigned long)st.max_us, (unsigned long)st.overruns,
+                  (unsigned long)st.carried, (unsigned long)st.deferred);
+    }
+    LOGI(SYS, "frames=%lu avg=%luus max=%luus over=%lu (budget %luus)",
+              (unsigned long)g_frame.frames,
+              (unsigned long)(g_frame.frames ? g_frame.total_us / g_frame.frames : 0),
+              (unsigned long)g_frame.max_us, (unsigned long)g_frame.overruns,
+              (unsigned long)FRAME_SCHED_FRAME_BUDGET_US);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cooperative frame scheduler for the UI loop.
+//
+// loop() runs one frame per wake-up: every registered slice whose period has come
+// round, in priority order, each told how many microseconds it may use. A slice
+// that cannot finish in its budget returns 0 and continues FRAME_SCHED_CARRY_MS
+// later, so carried work never turns the UI loop into a busy loop; in that frame
+// higher-priority slices (input, LVGL) still go first.
+// Once a frame has spent FRAME_SCHED_FRAME_BUDGET_US the remaining slices wait for
+// the next frame, ahead of everything else, so none of them can be starved.
+//
+// Slices that cannot stop early (lv_timer_handler) still get a budget: running
+// past it is counted as an overrun, which is how a slow screen shows up in stats.
+
+#ifndef FRAME_SCHED_MAX_SLICES
+#define FRAME_SCHED_MAX_SLICES 8
+#endif
+
+// Deadline given to a slice that returned 0 (work carried over): one tick at 1 kHz
+#ifndef FRAME_SCHED_CARRY_MS
+#define FRAME_SCHED_CARRY_MS 1U
+#endif
+
+#ifndef FRAME_SCHED_FRAME_BUDGET_US
+#define FRAME_SCHED_FRAME_BUDGET_US 20000UL
+#endif
+
+// Returned by a slice with no deadline of its own: it runs when a frame does
+#define FRAME_SCHED_IDLE 0xFFFFFFFFUL
+
+// Does up to budget_us of work. Returns the ms until the slice next needs a frame:
+// 0 = work left over, FRAME_SCHED_IDLE = none.
+typedef uint32_t (*frame_slice_fn)(uint32_t budget_us);
+
+typedef struct {
+    const char* name;
+    uint8_t priority;     // lower runs first
+    uint32_t budget_us;
+    uint32_t period_ms;   // runs at most this often; 0 = every frame
+    uint32_t runs;
+    uint32_t carried;     // runs that left work for the next frame
+    uint32_t overruns;    // runs longer than budget_us
+    uint32_t deferred;    // frames it was due in but held over (frame budget spent)
+    uint64_t total_us;
+    uint32_t max_us;
+} frame_slice_stats_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t overruns;    // frames longer than FRAME_SCHED_FRAME_BUDGET_US
+    uint64_t total_us;
+    uint32_t max_us;
+} frame_sched_stats_t;
+
+// Register a slice. Returns its id, or -1 when FRAME_SCHED_MAX_SLICES are in use.
+int frame_sched_add(const char* name, frame_slice_fn fn, uint8_t priority,
+                    uint32_t budget_us, uint32_t period_ms);
+
+// Run one frame. Returns the ms until the next one is needed
+// (0 = now, FRAME_SCHED_IDLE = only when woken).
+uint32_t frame_sched_run(void);
+
+uint8_t frame_sched_count(void);
+bool frame_sched_slice_stats(uint8_t id, frame_slice_stats_t* out);
+void frame_sched_stats(frame_sched_stats_t* out);
+void frame_sched_reset_stats(void);
+
+// One log line per slice and one for the frame totals
+void frame_sched_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
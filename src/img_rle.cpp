@@ -0,0 +1,160 @@
+#include "img_rle.h"
+#include <string.h>
+#include "lvgl.h"
+
+// Rows per get_area step: bigger bands mean fewer blits, more RAM (w * rows * 2 bytes)
+#ifndef IMG_RLE_BAND_ROWS
+#define IMG_RLE_BAND_ROWS 8
+#endif
+
+struct RleDecodeState {
+    const uint8_t* data;
+    uint32_t size;
+    lv_draw_buf_t* band;
+};
+
+static inline uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t rd32(const uint8_t* p) { return (uint32_t)rd16(p) | ((uint32_t)rd16(p + 2) << 16); }
+
+bool img_rle_decode_row(const uint8_t* container, uint32_t size,
+                        int32_t y, int32_t x1, int32_t x2, uint16_t* dst) {
+    if (size < sizeof(img_rle_header_t)) return false;
+    const uint16_t w = rd16(container + 4);
+    const uint16_t h = rd16(container + 6);
+    if (y < 0 || y >= h || x1 < 0 || x2 >= w || x1 > x2) return false;
+
+    const uint32_t table_end = sizeof(img_rle_header_t) + 4UL * h;
+    if (size < table_end) return false;
+
+    uint32_t pos = rd32(container + sizeof(img_rle_header_t) + 4UL * (uint32_t)y);
+    int32_t x = 0;
+
+    // Walk packets from the row start; skip columns left of x1, stop after x2
+    while (x <= x2) {
+        if (pos >= size) return false;
+        const uint8_t ctl = container[pos++];
+        const int32_t n = (ctl & 0x7F) + 1;
+
+        if (ctl & 0x80) {
+            if (pos + 2 > size) return false;
+            const uint16_t v = rd16(container + pos);
+            pos += 2;
+            int32_t a = (x > x1) ? x : x1;
+            const int32_t b = (x + n - 1 < x2) ? (x + n - 1) : x2;
+            for (; a <= b; a++) dst[a - x1] = v;
+        } else {
+            if (pos + 2UL * n > size) return false;
+            if (x + n > x1) {
+                const int32_t a = (x > x1) ? x : x1;
+                const int32_t b = (x + n - 1 < x2) ? (x + n - 1) : x2;
+                memcpy(&dst[a - x1], container + pos + 2 * (a - x), 2 * (b - a + 1));
+            }
+            pos += 2UL * n;
+        }
+        x += n;
+    }
+    return true;
+}
+
+// ---------------------------
+// LVGL decoder
+// ---------------------------
+static const img_rle_header_t* rle_header_of(const lv_image_decoder_dsc_t* dsc, uint32_t* size) {
+    if (dsc->src_type != LV_IMAGE_SRC_VARIABLE) return NULL;
+    const lv_image_dsc_t* img = (const lv_image_dsc_t*)dsc->src;
+    if (img->header.cf != LV_COLOR_FORMAT_RAW || img->data_size < sizeof(img_rle_header_t)) return NULL;
+    if (rd32(img->data) != IMG_RLE_MAGIC) return NULL;
+    if (size) *size = img->data_size;
+    return (const img_rle_header_t*)img->data;
+}
+
+static lv_result_t rle_info(lv_image_decoder_t* decoder, lv_image_decoder_dsc_t* dsc,
+                            lv_image_header_t* header) {
+    (void)decoder;
+    const img_rle_header_t* h = rle_header_of(dsc, NULL);
+    if (!h) return LV_RESULT_INVALID;
+
+    header->magic = LV_IMAGE_HEADER_MAGIC;
+    header->cf = LV_COLOR_FORMAT_RGB565;
+    header->flags = 0;
+    header->w = rd16((const uint8_t*)h + 4);
+    header->h = rd16((const uint8_t*)h + 6);
+    header->stride = header->w * 2;
+    return LV_RESULT_OK;
+}
+
+static lv_result_t rle_open(lv_image_decoder_t* decoder, lv_image_decoder_dsc_t* dsc) {
+    (void)decoder;
+    uint32_t size = 0;
+    const img_rle_header_t* h = rle_header_of(dsc, &size);
+    if (!h) return LV_RESULT_INVALID;
+
+    RleDecodeState* st = (RleDecodeState*)lv_malloc(sizeof(RleDecodeState));
+    if (!st) return LV_RESULT_INVALID;
+    st->data = (const uint8_t*)h;
+    st->size = size;
+    st->band = lv_draw_buf_create(dsc->header.w, IMG_RLE_BAND_ROWS, LV_COLOR_FORMAT_RGB565, LV_STRIDE_AUTO);
+    if (!st->band) {
+        lv_free(st);
+        return LV_RESULT_INVALID;
+    }
+
+    dsc->user_data = st;
+    dsc->decoded = NULL;   // no full frame: LVGL draws band by band via get_area
+    return LV_RESULT_OK;
+}
+
+static lv_result_t rle_get_area(lv_image_decoder_t* decoder, lv_image_decoder_dsc_t* dsc,
+                                const lv_area_t* full_area, lv_area_t* decoded_area) {
+    (void)decoder;
+    RleDecodeState* st = (RleDecodeState*)dsc->user_data;
+    if (!st) return LV_RESULT_INVALID;
+
+    if (decoded_area->y1 == LV_COORD_MIN) {
+        *decoded_area = *full_area;
+        decoded_area->y2 = full_area->y1 - 1;
+    }
+    decoded_area->y1 = decoded_area->y2 + 1;
+    decoded_area->y2 = decoded_area->y1 + IMG_RLE_BAND_ROWS - 1;
+    if (decoded_area->y1 > full_area->y2) return LV_RESULT_INVALID;
+    if (decoded_area->y2 > full_area->y2) decoded_area->y2 = full_area->y2;
+
+    lv_draw_buf_t* band = st->band;
+    const uint32_t stride = band->header.stride;
+    const int32_t rows = decoded_area->y2 - decoded_area->y1 + 1;
+    for (int32_t r = 0; r < rows; r++) {
+        uint16_t* dst = (uint16_t*)(band->data + r * stride);
+        if (!img_rle_decode_row(st->data, st->size, decoded_area->y1 + r,
+                                full_area->x1, full_area->x2, dst)) {
+            return LV_RESULT_INVALID;
+        }
+    }
+
+    // Present the band as an image of exactly the decoded area
+    band->header.w = lv_area_get_width(full_area);
+    band->header.h = rows;
+    dsc->decoded = band;
+    return LV_RESULT_OK;
+}
+
+static void rle_close(lv_image_decoder_t* decoder, lv_image_decoder_dsc_t* dsc) {
+    (void)decoder;
+    RleDecodeState* st = (RleDecodeState*)dsc->user_data;
+    if (!st) return;
+    if (st->band) lv_draw_buf_destroy(st->band);
+    lv_free(st);
+    dsc->user_data = NULL;
+    dsc->decoded = NULL;
+}
+
+void img_rle_init(void) {
+    static bool done = false;
+    if (done) return;
+    done = true;
+
+    lv_image_decoder_t* dec = lv_image_decoder_create();
+    lv_image_decoder_set_info_cb(dec, rle_info);
+    lv_image_decoder_set_open_cb(dec, rle_open);
+    lv_image_decoder_set_get_area_cb(dec, rle_get_area);
+    lv_image_decoder_set_close_cb(dec, rle_close);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming decoder for RLE RGB565 images produced by tools/img_assets.py.
+// Such images are lv_image_dsc_t with cf = LV_COLOR_FORMAT_RAW whose data starts
+// with img_rle_header_t. They are never decoded whole: LVGL pulls IMG_RLE_BAND_ROWS
+// rows at a time, clipped to the area being drawn, into one small band buffer.
+//
+// Container layout (little-endian):
+//   img_rle_header_t
+//   uint32_t row_offset[h]      from the start of the container
+//   row packets: ctl & 0x80 -> run of (ctl & 0x7F) + 1 copies of the next pixel,
+//                otherwise (ctl + 1) literal pixels follow. Rows never share a packet.
+
+#define IMG_RLE_MAGIC 0x36454C52UL  // "RLE6"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t w;
+    uint16_t h;
+    uint32_t flags;      // reserved, 0
+    uint32_t reserved;
+} img_rle_header_t;
+
+// Register the LVGL image decoder. Call once after lv_init().
+void img_rle_init(void);
+
+// Decode columns [x1, x2] of row y into dst (x2 - x1 + 1 pixels).
+// Returns false on a malformed container.
+bool img_rle_decode_row(const uint8_t* container, uint32_t size,
+                        int32_t y, int32_t x1, int32_t x2, uint16_t* dst);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,199 @@
+#pragma once
+#include <stdint.h>
+#include "dsp_pipeline.h"
+
+// Jam detection for one motor run, shared by motor_task (actions.cpp) and the host
+// replay tool (tools/trace_replay.cpp). No Arduino dependencies: time is passed in
+// as milliseconds and current as raw 12-bit ADC counts.
+//
+//   Path A (primary):   no rotary edge for JAM_NO_MOTION_TIMEOUT_MS, until a treat is seen
+//   Path B (secondary): filtered current over JAM_FILTERED_THRESHOLD_AMPS (with hysteresis)
+//                       for JAM_FILTERED_CONFIRM_MS
+// Both are blanked for JAM_NO_MOTION_STARTUP_MS after each (re)start and for
+// MOTOR_JAM_REARM_MS after an unjam reverse.
+
+// -----------------------------
+// Sensor
+// -----------------------------
+#ifndef CURRENT_SENSOR_ADC_FS_VOLTS
+#define CURRENT_SENSOR_ADC_FS_VOLTS 3.3f
+#endif
+
+// ACS712-30A = 66 mV/A
+#ifndef SENSITIVITY
+#define SENSITIVITY 0.066f
+#endif
+
+// -----------------------------
+// Primary jam detection: rotary no-motion
+// -----------------------------
+#ifndef JAM_NO_MOTION_STARTUP_MS
+#define JAM_NO_MOTION_STARTUP_MS 400UL
+#endif
+
+#ifndef JAM_NO_MOTION_TIMEOUT_MS
+#define JAM_NO_MOTION_TIMEOUT_MS 1500UL
+#endif
+
+#ifndef MOTOR_JAM_REARM_MS
+#define MOTOR_JAM_REARM_MS 150UL
+#endif
+
+// -----------------------------
+// Secondary jam detection: filtered current
+// Tuned conservatively to avoid normal-start false positives.
+// -----------------------------
+#ifndef JAM_FILTERED_THRESHOLD_AMPS
+#define JAM_FILTERED_THRESHOLD_AMPS 0.85f
+#endif
+
+// Hysteresis release level; comparator stays ON until the level falls below it
+#ifndef JAM_FILTERED_RELEASE_AMPS
+#define JAM_FILTERED_RELEASE_AMPS 0.70f
+#endif
+
+// Median + IIR at 8 kHz is far less noisy than the old per-tick EMA, so this
+// hold could likely be shorter; keep 250 ms until replayed motor traces
+// (tools/trace_replay.cpp) show a lower value neither misses nor invents jams.
+#ifndef JAM_FILTERED_CONFIRM_MS
+#define JAM_FILTERED_CONFIRM_MS 250UL
+#endif
+
+// -----------------------------
+// Current DSP chain (runs on every DMA sample, integer ADC counts)
+// Time constants assume CURRENT_SENSE_SAMPLE_RATE_HZ = 8 kHz.
+// -----------------------------
+#ifndef JAM_DSP_MEDIAN_N
+#define JAM_DSP_MEDIAN_N 5      // spike rejection
+#endif
+
+#ifndef JAM_DSP_IIR_SHIFT
+#define JAM_DSP_IIR_SHIFT 6     // tau ~ 64 samples = 8 ms
+#endif
+
+#ifndef JAM_DSP_RMS_LOG2
+#define JAM_DSP_RMS_LOG2 7      // 128 samples = 16 ms
+#endif
+
+#ifndef JAM_DSP_SLOPE_LAG
+#define JAM_DSP_SLOPE_LAG 40    // 5 ms
+#endif
+
+// Current <-> |ADC counts from zero|; constexpr so thresholds are template arguments
+static constexpr int32_t amps_to_counts(float amps) {
+    return (int32_t)(amps * SENSITIVITY * 4095.0f / CURRENT_SENSOR_ADC_FS_VOLTS + 0.5f);
+}
+
+static inline float counts_to_amps(int32_t counts) {
+    return ((float)counts * CURRENT_SENSOR_ADC_FS_VOLTS / 4095.0f) / SENSITIVITY;
+}
+
+static inline int32_t volts_to_zero_counts(float zero_volts) {
+    return (int32_t)((zero_volts / CURRENT_SENSOR_ADC_FS_VOLTS) * 4095.0f + 0.5f);
+}
+
+// Jam-detector chain, specialised at compile time for this unit's constants.
+// level = IIR(median(|adc - zero|)); comparator on level with hysteresis.
+typedef dsp::Chain<dsp::MedianN<JAM_DSP_MEDIAN_N>,
+                   dsp::IirLowpass<JAM_DSP_IIR_SHIFT> > JamLevelChain;
+typedef dsp::Hysteresis<amps_to_counts(JAM_FILTERED_THRESHOLD_AMPS),
+                        amps_to_counts(JAM_FILTERED_RELEASE_AMPS)> JamComparator;
+
+enum JamVerdict {
+    JAM_NONE = 0,
+    JAM_NO_MOTION,        // path A
+    JAM_FILTERED_CURRENT  // path B
+};
+
+struct JamDetector {
+    // DSP state; level/rms follow the last sample, max_slope covers the whole run
+    int32_t zero_counts = 0;
+    int32_t level_counts = 0;
+    int32_t rms_counts = 0;
+    int32_t max_slope_counts = 0;      // steepest rise of level per JAM_DSP_SLOPE_LAG
+    JamLevelChain level;
+    dsp::WindowRms<JAM_DSP_RMS_LOG2> rms;
+    dsp::Slope<JAM_DSP_SLOPE_LAG> slope;
+    JamComparator over;
+
+    // Motion / blanking
+    uint32_t last_motion_ms = 0;
+    uint32_t motion_arm_after_ms = 0;
+    uint32_t rearm_after_ms = 0;
+    uint32_t filtered_start_ms = 0;    // 0 = path B comparator currently off
+    bool saw_motion = false;
+
+    // Start of a run
+    void begin(uint32_t now_ms, int32_t zero) {
+        max_slope_counts = 0;
+        rearm_after_ms = 0;
+        arm(now_ms, zero);
+    }
+
+    // Forward running again after an unjam reverse
+    void resume(uint32_t now_ms, int32_t zero) {
+        rearm_after_ms = now_ms + MOTOR_JAM_REARM_MS;
+        arm(now_ms, zero);   // don't feed reverse-phase samples into the forward chain
+    }
+
+    // A jam was acted on: reverse starts now
+    void reversing(uint32_t now_ms) {
+        filtered_start_ms = 0;
+        last_motion_ms = now_ms;
+    }
+
+    void reset_dsp(int32_t zero) {
+        zero_counts = zero;
+        level_counts = 0;
+        rms_counts = 0;
+        level.reset();
+        rms.reset();
+        slope.reset();
+        over.reset();
+    }
+
+    // Push one sample (raw ADC counts) through the DSP chain.
+    void step(int32_t adc) {
+        int32_t dev = adc - zero_counts;
+        if (dev < 0) dev = -dev;
+
+        level_counts = level.step(dev);
+        const int32_t s = slope.step(level_counts);
+        (void)over.step(level_counts);
+        rms_counts = rms.step(dev);
+        if (s > max_slope_counts) max_slope_counts = s;
+    }
+
+    void motion(uint32_t now_ms) {
+        last_motion_ms = now_ms;
+        saw_motion = true;
+    }
+
+    // Once per tick, after this tick's samples and motion. Path A runs first.
+    JamVerdict check(uint32_t now_ms, bool treat_dispensed) {
+        if (now_ms < rearm_after_ms || now_ms < motion_arm_after_ms) return JAM_NONE;
+
+        if (!treat_dispensed && (now_ms - last_motion_ms) >= JAM_NO_MOTION_TIMEOUT_MS) {
+            return JAM_NO_MOTION;
+        }
+
+        if (over.state()) {
+            if (filtered_start_ms == 0) filtered_start_ms = now_ms;
+        } else {
+            filtered_start_ms = 0;
+        }
+        if (filtered_start_ms != 0 && (now_ms - filtered_start_ms) >= JAM_FILTERED_CONFIRM_MS) {
+            return JAM_FILTERED_CURRENT;
+        }
+        return JAM_NONE;
+    }
+
+private:
+    void arm(uint32_t now_ms, int32_t zero) {
+        last_motion_ms = now_ms;
+        motion_arm_after_ms = now_ms + JAM_NO_MOTION_STARTUP_MS;
+        saw_motion = false;
+        filtered_start_ms = 0;
+        reset_dsp(zero);
+    }
+};
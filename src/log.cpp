@@ -0,0 +1,341 @@
+#include "log.h"
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// -----------------------------
+// Configuration
+// -----------------------------
+// Ring shared by every caller; power of two. A typical record is 16-40 bytes.
+#ifndef LOG_RING_BYTES
+#define LOG_RING_BYTES 4096
+#endif
+
+// 1 = write records to Serial as binary frames for tools/log_decode.py
+#ifndef LOG_SERIAL_BINARY
+#define LOG_SERIAL_BINARY 0
+#endif
+
+#ifndef LOG_TASK_PRIORITY
+#define LOG_TASK_PRIORITY 1
+#endif
+
+#ifndef LOG_TASK_STACK
+#define LOG_TASK_STACK 3072   // snprintf with doubles
+#endif
+
+#ifndef LOG_TASK_CORE
+#define LOG_TASK_CORE 0
+#endif
+
+#define LOG_LINE_MAX 256
+
+static_assert((LOG_RING_BYTES & (LOG_RING_BYTES - 1)) == 0, "LOG_RING_BYTES must be a power of two");
+#if LOG_SERIAL_BINARY
+static_assert(sizeof(uintptr_t) == 4, "binary log frames carry 32-bit format addresses");
+#endif
+
+// -----------------------------
+// Ring
+// -----------------------------
+// Producers reserve whole records by advancing g_head with a CAS, fill them in place
+// and publish them by storing the header word last. A record never straddles the
+// end of the buffer: the gap before it becomes a PAD record. log_task consumes in
+// order, stops at the first unpublished header, and zeroes what it consumed so the
+// next lap finds cleared header words.
+//
+// Record: u32 header (length incl. header | flags), uintptr fmt, u32 t_us,
+// u8 level<<4 | module, u8 nargs, then per argument a type tag and its value.
+#define LOG_REC_READY 0x80000000UL
+#define LOG_REC_PAD   0x40000000UL
+#define LOG_REC_LEN   0x0000FFFFUL
+#define LOG_RING_MASK (LOG_RING_BYTES - 1)
+
+static uint8_t g_buf[LOG_RING_BYTES] __attribute__((aligned(4)));
+static std::atomic<uint32_t> g_head{0};
+static std::atomic<uint32_t> g_tail{0};
+static std::atomic<uint32_t> g_dropped{0};
+static TaskHandle_t g_task = nullptr;
+
+static inline uint32_t* header_at(uint32_t pos) {
+    return (uint32_t*)&g_buf[pos & LOG_RING_MASK];
+}
+
+static inline void publish(uint32_t pos, uint32_t word) {
+    __atomic_store_n(header_at(pos), word, __ATOMIC_RELEASE);
+}
+
+// Claims len bytes (multiple of 4); returns false when the ring is full.
+static bool reserve(uint32_t len, uint32_t* at, bool* was_empty) {
+    uint32_t head = g_head.load(std::memory_order_relaxed);
+    uint32_t pad;
+    for (;;) {
+        const uint32_t room = LOG_RING_BYTES - (head & LOG_RING_MASK);
+        pad = room < len ? room : 0;
+        const uint32_t tail = g_tail.load(std::memory_order_acquire);
+        if (head - tail + pad + len > LOG_RING_BYTES) return false;
+        if (g_head.compare_exchange_weak(head, head + pad + len)) break;
+    }
+    if (pad) publish(head, pad | LOG_REC_READY | LOG_REC_PAD);
+    *at = head + pad;
+    // Read after the CAS, paired with log_task's tail store then head load: either
+    // this sees the ring drained up to our record, or log_task sees our head.
+    *was_empty = g_tail.load() == head;
+    return true;
+}
+
+static inline void put(uint8_t*& p, const void* v, size_t n) {
+    memcpy(p, v, n);
+    p += n;
+}
+
+static size_t arg_bytes(const log_arg_t& a) {
+    switch (a.type) {
+    case LOG_ARG_I64:
+    case LOG_ARG_U64:
+    case LOG_ARG_F64: return 1 + 8;
+    case LOG_ARG_STR: {
+        size_t n = a.str ? strnlen(a.str, LOG_MAX_STR) : 0;
+        return 1 + 1 + n;
+    }
+    case LOG_ARG_PTR: return 1 + sizeof(uintptr_t);
+    default:          return 1 + 4;
+    }
+}
+
+void log_emit(uint8_t module, uint8_t level, const char* fmt, const log_arg_t* args, uint8_t count) {
+    const size_t fixed = 4 + sizeof(uintptr_t) + 4 + 2;
+    size_t len = fixed;
+    for (uint8_t i = 0; i < count; i++) len += arg_bytes(args[i]);
+    len = (len + 3) & ~(size_t)3;
+
+    uint32_t at;
+    bool was_empty;
+    if (!reserve((uint32_t)len, &at, &was_empty)) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint8_t* p = &g_buf[(at & LOG_RING_MASK) + 4];
+    const uintptr_t id = (uintptr_t)fmt;
+    const uint32_t t_us = (uint32_t)esp_timer_get_time();
+    const uint8_t tag = (uint8_t)((level << 4) | (module & 0x0F));
+    put(p, &id, sizeof(id));
+    put(p, &t_us, 4);
+    *p++ = tag;
+    *p++ = count;
+    for (uint8_t i = 0; i < count; i++) {
+        const log_arg_t& a = args[i];
+        *p++ = a.type;
+        switch (a.type) {
+        case LOG_ARG_I64:
+        case LOG_ARG_U64: put(p, &a.u64, 8); break;
+        case LOG_ARG_F64: put(p, &a.f64, 8); break;
+        case LOG_ARG_STR: {
+            const uint8_t n = (uint8_t)(a.str ? strnlen(a.str, LOG_MAX_STR) : 0);
+            *p++ = n;
+            put(p, a.str, n);
+            break;
+        }
+        case LOG_ARG_PTR: put(p, &a.ptr, sizeof(uintptr_t)); break;
+        default:          put(p, &a.u32, 4); break;
+        }
+    }
+    publish(at, (uint32_t)len | LOG_REC_READY);
+
+    if (was_empty && g_task) {
+        if (xPortInIsrContext()) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(g_task, &woken);
+            if (woken) portYIELD_FROM_ISR();
+        } else {
+            xTaskNotifyGive(g_task);
+        }
+    }
+}
+
+// -----------------------------
+// Output (log_task only)
+// -----------------------------
+#if LOG_SERIAL_BINARY
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), as in run_log.cpp
+static uint16_t crc16(const uint8_t* p, size_t n) {
+    uint16_t crc = 0xFFFF;
+    while (n--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// Frame: A5 5A, u16 payload length, the record minus its header word, u16 CRC of the payload
+static void output_record(const uint8_t* rec, uint32_t len) {
+    const uint8_t* payload = rec + 4;
+    const uint16_t n = (uint16_t)(len - 4);
+    const uint16_t crc = crc16(payload, n);
+    const uint8_t head[4] = { 0xA5, 0x5A, (uint8_t)(n & 0xFF), (uint8_t)(n >> 8) };
+    const uint8_t tail[2] = { (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) };
+    Serial.write(head, sizeof(head));
+    Serial.write(payload, n);
+    Serial.write(tail, sizeof(tail));
+}
+#else
+struct line_t {
+    char buf[LOG_LINE_MAX];
+    size_t n;
+};
+
+static void line_printf(line_t& l, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void line_printf(line_t& l, const char* fmt, ...) {
+    if (l.n >= sizeof(l.buf)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    const int w = vsnprintf(l.buf + l.n, sizeof(l.buf) - l.n, fmt, ap);
+    va_end(ap);
+    if (w > 0) l.n += (size_t)w;
+    if (l.n > sizeof(l.buf) - 3) l.n = sizeof(l.buf) - 3;   // room for "\r\n"
+}
+
+static void line_putc(line_t& l, char c) {
+    if (l.n < sizeof(l.buf) - 3) l.buf[l.n++] = c;
+}
+
+// Formats one record with the call site's format string. Each conversion is
+// re-emitted with its length modifier rebuilt from the stored argument type, so
+// "%lu" of a 32-bit value and "%llu" of a 64-bit one both print right.
+static void output_record(const uint8_t* rec, uint32_t len) {
+    (void)len;
+    const uint8_t* p = rec + 4;
+    uintptr_t id;
+    memcpy(&id, p, sizeof(id));
+    p += sizeof(id) + 4;   // skip t_us: the text stream is read live
+    const uint8_t level = p[0] >> 4;
+    uint8_t nargs = p[1];
+    p += 2;
+
+    line_t l;
+    l.n = 0;
+    if (level == LOG_LEVEL_ERROR) line_printf(l, "[ERROR] ");
+    else if (level == LOG_LEVEL_WARN) line_printf(l, "[WARN] ");
+
+    const char* f = (const char*)id;
+    while (*f) {
+        if (*f != '%') { line_putc(l, *f++); continue; }
+        if (f[1] == '%') { line_putc(l, '%'); f += 2; continue; }
+
+        // %[flags][width][.precision][length]conv, length dropped
+        char spec[24];
+        size_t k = 0;
+        spec[k++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && k < sizeof(spec) - 4) spec[k++] = *f++;
+        while (*f && strchr("hlLqjzt", *f)) f++;
+        const char conv = *f;
+        if (!conv) break;
+        f++;
+        if (!nargs) { line_putc(l, '?'); continue; }
+        nargs--;
+
+        const uint8_t type = *p++;
+        uint32_t u32 = 0;
+        uint64_t u64 = 0;
+        double f64 = 0.0;
+        uintptr_t ptr = 0;
+        char str[LOG_MAX_STR + 1];
+        switch (type) {
+        case LOG_ARG_I32: case LOG_ARG_U32: memcpy(&u32, p, 4); p += 4; break;
+        case LOG_ARG_I64: case LOG_ARG_U64: memcpy(&u64, p, 8); p += 8; break;
+        case LOG_ARG_F64: memcpy(&f64, p, 8); p += 8; break;
+        case LOG_ARG_STR: { const uint8_t n = *p++; memcpy(str, p, n); str[n] = '\0'; p += n; break; }
+        case LOG_ARG_PTR: memcpy(&ptr, p, sizeof(ptr)); p += sizeof(ptr); break;
+        default: return;   // corrupt record; drop the rest of the line
+        }
+
+        if (strchr("fFeEgGaA", conv)) {
+            if (type == LOG_ARG_I32) f64 = (double)(int32_t)u32;
+            else if (type == LOG_ARG_U32) f64 = (double)u32;
+            else if (type != LOG_ARG_F64) { line_putc(l, '?'); continue; }
+            spec[k++] = conv; spec[k] = '\0';
+            line_printf(l, spec, f64);
+        } else if (conv == 's') {
+            if (type != LOG_ARG_STR) { line_putc(l, '?'); continue; }
+            spec[k++] = conv; spec[k] = '\0';
+            line_printf(l, spec, str);
+        } else if (conv == 'p') {
+            line_printf(l, "%p", (void*)(type == LOG_ARG_PTR ? ptr : (uintptr_t)u32));
+        } else if (type == LOG_ARG_I64 || type == LOG_ARG_U64) {
+            spec[k++] = 'l'; spec[k++] = 'l'; spec[k++] = conv; spec[k] = '\0';
+            if (conv == 'd' || conv == 'i') line_printf(l, spec, (long long)u64);
+            else line_printf(l, spec, (unsigned long long)u64);
+        } else if (type == LOG_ARG_I32 || type == LOG_ARG_U32) {
+            spec[k++] = conv; spec[k] = '\0';
+            if (conv == 'd' || conv == 'i') line_printf(l, spec, (int)(int32_t)u32);
+            else line_printf(l, spec, (unsigned)u32);
+        } else {
+            line_putc(l, '?');
+        }
+    }
+    l.buf[l.n++] = '\r';
+    l.buf[l.n++] = '\n';
+    Serial.write((const uint8_t*)l.buf, l.n);
+}
+#endif
+
+static void drain(void) {
+    for (;;) {
+        const uint32_t tail = g_tail.load(std::memory_order_relaxed);
+        const uint32_t word = __atomic_load_n(header_at(tail), __ATOMIC_ACQUIRE);
+        if (!(word & LOG_REC_READY)) return;
+        const uint32_t len = word & LOG_REC_LEN;
+        uint8_t* rec = &g_buf[tail & LOG_RING_MASK];
+        if (!(word & LOG_REC_PAD)) output_record(rec, len);
+        memset(rec, 0, len);
+        g_tail.store(tail + len);
+    }
+}
+
+static void log_task(void* param) {
+    (void)param;
+    uint32_t reported = 0;
+    for (;;) {
+        drain();
+
+        const uint32_t dropped = g_dropped.load(std::memory_order_relaxed);
+        if (dropped != reported) {
+            LOGW(SYS, "log: %lu records dropped", (unsigned long)(dropped - reported));
+            reported = dropped;
+            continue;
+        }
+
+        if (g_head.load() == g_tail.load()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } else {
+            // Reserved but not yet published; the writer finishes within a tick
+            vTaskDelay(1);
+        }
+    }
+}
+
+// -----------------------------
+// API
+// -----------------------------
+void log_init(void) {
+    if (g_task) return;
+    xTaskCreatePinnedToCore(
+        log_task,
+        "log",
+        LOG_TASK_STACK,
+        nullptr,
+        LOG_TASK_PRIORITY,
+        &g_task,
+        LOG_TASK_CORE
+    );
+}
+
+uint32_t log_dropped(void) {
+    return g_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,199 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Deferred binary logging.
+//
+// LOGI(MOTOR, "Motor ON (CW)") does not format or touch the UART. The call site's
+// format string pointer (its ID), a timestamp and the raw arguments are copied into a
+// lock-free multi-producer ring, and log_task formats and writes them at low priority.
+// A hot path pays a few hundred ns per call instead of waiting ~90 us per byte once
+// the UART FIFO is full. Calls are safe from any task or ISR; a full ring drops the
+// record and counts it.
+//
+// Levels are filtered at compile time per module: a call above LOG_LEVEL_<MODULE>
+// (default LOG_LEVEL) is dead code, argument evaluation included.
+//   -D LOG_LEVEL=LOG_LEVEL_WARN -D LOG_LEVEL_MOTOR=LOG_LEVEL_DEBUG
+//
+// Output is one text line per record (WARN/ERROR prefixed "[WARN] "/"[ERROR] "). With
+// -D LOG_SERIAL_BINARY=1 the records themselves go out as CRC'd frames instead;
+// tools/log_decode.py turns a capture back into text using the firmware ELF, since
+// a format ID is the string's address.
+//
+// Format strings must be literals. Arguments may be integers up to 64 bits, float,
+// double, C strings (copied, up to LOG_MAX_STR bytes) and pointers; at most
+// LOG_MAX_ARGS of them.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Modules, in record order (tools/log_decode.py keeps the same list)
+#define LOG_MODULES(X) \
+    X(SYS)             \
+    X(MOTOR)           \
+    X(JAM)             \
+    X(PCF)             \
+    X(SCHED)           \
+    X(TRAIN)           \
+    X(AUDIO)           \
+    X(UI)              \
+    X(RUNLOG)          \
+    X(TOUCH)           \
+    X(ADC)             \
+    X(TRACE)
+
+#ifndef LOG_LEVEL_SYS
+#define LOG_LEVEL_SYS LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_MOTOR
+#define LOG_LEVEL_MOTOR LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_JAM
+#define LOG_LEVEL_JAM LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_PCF
+#define LOG_LEVEL_PCF LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_SCHED
+#define LOG_LEVEL_SCHED LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_TRAIN
+#define LOG_LEVEL_TRAIN LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_AUDIO
+#define LOG_LEVEL_AUDIO LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_UI
+#define LOG_LEVEL_UI LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_RUNLOG
+#define LOG_LEVEL_RUNLOG LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_TOUCH
+#define LOG_LEVEL_TOUCH LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_ADC
+#define LOG_LEVEL_ADC LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_TRACE
+#define LOG_LEVEL_TRACE LOG_LEVEL
+#endif
+
+#define LOG_MODULE_ENUM(name) LOG_MOD_##name,
+enum log_module_t { LOG_MODULES(LOG_MODULE_ENUM) LOG_MOD_COUNT };
+#undef LOG_MODULE_ENUM
+
+#ifdef __cplusplus
+static_assert(LOG_MOD_COUNT <= 16, "a record stores the module in 4 bits");
+#endif
+
+#define LOG_MAX_ARGS 16
+#define LOG_MAX_STR  32
+
+// Argument type tags, as stored in records
+enum {
+    LOG_ARG_I32 = 1,
+    LOG_ARG_U32,
+    LOG_ARG_I64,
+    LOG_ARG_U64,
+    LOG_ARG_F64,
+    LOG_ARG_STR,   // u8 length, then the bytes (no NUL)
+    LOG_ARG_PTR,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start log_task. Records logged before this wait in the ring.
+void log_init(void);
+
+uint32_t log_dropped(void);   // records lost to a full ring since boot
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+struct log_arg_t {
+    uint8_t type;
+    union {
+        uint32_t u32;
+        uint64_t u64;
+        double f64;
+        const char* str;
+        uintptr_t ptr;
+    };
+};
+
+template <typename T>
+static inline log_arg_t log_int(T v) {
+    log_arg_t a;
+    const bool is_signed = (T)-1 < (T)0;
+    if (sizeof(T) <= 4) {
+        a.type = is_signed ? LOG_ARG_I32 : LOG_ARG_U32;
+        a.u32 = (uint32_t)v;
+    } else {
+        a.type = is_signed ? LOG_ARG_I64 : LOG_ARG_U64;
+        a.u64 = (uint64_t)v;
+    }
+    return a;
+}
+
+// bool, char, short and unscoped enums promote to int; float to double
+static inline log_arg_t log_arg(int v)                { return log_int(v); }
+static inline log_arg_t log_arg(unsigned v)           { return log_int(v); }
+static inline log_arg_t log_arg(long v)               { return log_int(v); }
+static inline log_arg_t log_arg(unsigned long v)      { return log_int(v); }
+static inline log_arg_t log_arg(long long v)          { return log_int(v); }
+static inline log_arg_t log_arg(unsigned long long v) { return log_int(v); }
+static inline log_arg_t log_arg(double v)             { log_arg_t a; a.type = LOG_ARG_F64; a.f64 = v; return a; }
+static inline log_arg_t log_arg(const char* s)        { log_arg_t a; a.type = LOG_ARG_STR; a.str = s; return a; }
+static inline log_arg_t log_arg(const void* p)        { log_arg_t a; a.type = LOG_ARG_PTR; a.ptr = (uintptr_t)p; return a; }
+
+void log_emit(uint8_t module, uint8_t level, const char* fmt, const log_arg_t* args, uint8_t count);
+
+template <typename... Args>
+static inline void log_write(uint8_t module, uint8_t level, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    const log_arg_t a[sizeof...(Args) + 1] = { log_arg(args)... };
+    log_emit(module, level, fmt, a, (uint8_t)sizeof...(Args));
+}
+
+// Never called: lets the compiler check format strings against their arguments
+static inline void log_format_check(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+static inline void log_format_check(const char* fmt, ...) { (void)fmt; }
+
+#define LOG_AT(mod, lvl, fmt, ...)                                                   \
+    do {                                                                             \
+        if ((lvl) <= LOG_LEVEL_##mod) {                                              \
+            if (0) log_format_check(fmt, ##__VA_ARGS__);                             \
+            log_write(LOG_MOD_##mod, (lvl), "" fmt, ##__VA_ARGS__);                  \
+        }                                                                            \
+    } while (0)
+
+#define LOGE(mod, fmt, ...) LOG_AT(mod, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOGW(mod, fmt, ...) LOG_AT(mod, LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOGI(mod, fmt, ...) LOG_AT(mod, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOGD(mod, fmt, ...) LOG_AT(mod, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif // __cplusplus
@@ -16,41 +16,44 @@
 
 // Include all libraries
 #include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include "sdkconfig.h"
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
 #include <Wire.h>
 #include <lvgl.h>
 #include <main.h>
 #include "lv_conf.h"
 #include <TFT_eSPI.h>
-#include <XPT2046_Touchscreen.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
 #include "FS.h"
 #include "SD.h"
 #include "SPI.h"
 #include "ui.h"
-extern const lv_img_dsc_t ui_img_splashy;
 #include "eez-flow.h"
 #include "actions.h"
 #include "pcf8574_control.h"
+#include "current_sense.h"
+#include "touch_input.h"
+#include "img_rle.h"
+#include "schedule_state.h"
+#include "run_log.h"
+#include "motor_trace.h"
+#include "log.h"
+#include "frame_sched.h"
 
 // ✅ Add this so actions_init() resolves even if actions.h doesn’t declare it yet
 extern "C" void actions_init(void);
 
-// Touch Screen pins
-#define XPT2046_IRQ 36
-#define XPT2046_MOSI 32
-#define XPT2046_MISO 39
-#define XPT2046_CLK 25
-#define XPT2046_CS 33
-
 // Global variables
-SPIClass touchscreenSpi = SPIClass(VSPI);
-XPT2046_Touchscreen touchscreen(TOUCH_CS, 255);
-uint16_t touchScreenMinimumX = 200, touchScreenMaximumX = 3700;
-uint16_t touchScreenMinimumY = 240, touchScreenMaximumY = 3800;
 lv_indev_t *indev;
+static bool touch_read_paused = false;
 uint8_t *draw_buf;
-uint32_t lastTick = 0;
+uint8_t *draw_buf2;
+static bool tft_dma_ok = false;
 float ZERO_CURRENT_VOLTAGE = 2.50f;
 
 TFT_eSPI tft = TFT_eSPI();
@@ -65,6 +68,52 @@ TFT_eSPI tft = TFT_eSPI();
 
 #define SD_CS 5
 
+// Longest the UI loop sleeps when LVGL reports nothing due (backstop only)
+#ifndef UI_LOOP_MAX_SLEEP_MS
+#define UI_LOOP_MAX_SLEEP_MS 500U
+#endif
+
+// Hold a finger on the screen this long at boot to run touch calibration
+#ifndef TOUCH_CAL_HOLD_MS
+#define TOUCH_CAL_HOLD_MS 1500U
+#endif
+
+// Automatic light sleep when every task is blocked (needs PM + tickless idle in sdkconfig)
+#ifndef UI_LIGHT_SLEEP
+#define UI_LIGHT_SLEEP 1
+#endif
+
+// Per-frame budgets of the UI loop's slices (see frame_sched.h)
+#ifndef UI_EVENTS_BUDGET_US
+#define UI_EVENTS_BUDGET_US 1000UL
+#endif
+
+#ifndef UI_LVGL_BUDGET_US
+#define UI_LVGL_BUDGET_US 12000UL   // a full-screen flush fits
+#endif
+
+#ifndef UI_FLOW_BUDGET_US
+#define UI_FLOW_BUDGET_US 4000UL
+#endif
+
+// Delay/animation components in the flow are polled at this rate while queued
+#ifndef UI_FLOW_POLL_MS
+#define UI_FLOW_POLL_MS 10U
+#endif
+
+#ifndef UI_SCREEN_TICK_BUDGET_US
+#define UI_SCREEN_TICK_BUDGET_US 1000UL
+#endif
+
+#ifndef UI_SCREEN_TICK_MS
+#define UI_SCREEN_TICK_MS 50U
+#endif
+
+// Log frame scheduler and flow heap stats this often; 0 = never
+#ifndef UI_FRAME_STATS_MS
+#define UI_FRAME_STATS_MS 0
+#endif
+
 // ------------------------
 // FIX 1 + P7 input release
 // ------------------------
@@ -111,10 +160,25 @@ void scanI2CDevices() {
     Serial.println("=== Scan Complete ===\n");
 }
 
+// ------------------------
+// Display flush
+// ------------------------
+// With DMA the flush only queues the band and returns; LVGL renders the next
+// band into the other draw buffer meanwhile. LVGL calls my_disp_flush_wait()
+// before it reuses a buffer, which blocks on DMA completion and completes the
+// flush. The HSPI bus is dedicated to the panel, so it stays claimed (one
+// startWrite() in setup) and each band costs a single queued transaction.
 void my_disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
     uint32_t w = lv_area_get_width(area);
     uint32_t h = lv_area_get_height(area);
 
+    if (tft_dma_ok) {
+        // Panel wants big-endian RGB565; swap in place, LVGL redraws the buffer anyway
+        lv_draw_sw_rgb565_swap(px_map, w * h);
+        tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)px_map);
+        return;
+    }
+
     tft.startWrite();
     tft.setAddrWindow(area->x1, area->y1, w, h);
     tft.pushColors((uint16_t *)px_map, w * h, true);
@@ -123,22 +187,64 @@ void my_disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
     lv_disp_flush_ready(disp);
 }
 
-void my_touchpad_read(lv_indev_t *indev, lv_indev_data_t *data) {
-    (void)indev;
+void my_disp_flush_wait(lv_display_t *disp) {
+    (void)disp;
+    tft.dmaWait();
+}
+
+// ------------------------
+// Event-driven UI loop
+// ------------------------
+// loop() runs one scheduler frame (LVGL, flow, screen ticks, app events), then
+// sleeps on a task notification until a slice is next due.
+// Touch IRQ and motor events notify it, so input is handled immediately.
+static TaskHandle_t ui_task_handle = nullptr;
+
+extern "C" void ui_loop_wake(void) {
+    if (ui_task_handle) xTaskNotifyGive(ui_task_handle);
+}
 
-    if (touchscreen.touched()) {
-        TS_Point p = touchscreen.getPoint();
+extern "C" void IRAM_ATTR ui_loop_wake_from_isr(void) {
+    if (!ui_task_handle) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(ui_task_handle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+// LVGL time base: esp_timer keeps counting across light sleep
+static uint32_t lv_tick_from_esp_timer(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
 
-        if (p.x < touchScreenMinimumX) touchScreenMinimumX = p.x;
-        if (p.x > touchScreenMaximumX) touchScreenMaximumX = p.x;
-        if (p.y < touchScreenMinimumY) touchScreenMinimumY = p.y;
-        if (p.y > touchScreenMaximumY) touchScreenMaximumY = p.y;
+static void configure_power_management() {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t pm = {};
+    pm.max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ;
+    pm.min_freq_mhz = 80;   // keeps APB at 80 MHz for SPI/I2C/timers
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pm.light_sleep_enable = UI_LIGHT_SLEEP;
+#endif
+    const esp_err_t err = esp_pm_configure(&pm);
+    LOGI(SYS, "Power management: %s (light sleep %s)",
+              err == ESP_OK ? "on" : esp_err_to_name(err),
+              pm.light_sleep_enable ? "enabled" : "unavailable");
+#else
+    LOGI(SYS, "Power management: not enabled in this build (idle = WFI only)");
+#endif
+}
 
-        data->point.x = constrain(map(p.x, touchScreenMinimumX, touchScreenMaximumX, 0, TFT_HOR_RES - 1), 0, TFT_HOR_RES - 1);
-        data->point.y = constrain(map(p.y, touchScreenMinimumY, touchScreenMaximumY, 0, TFT_VER_RES - 1), 0, TFT_VER_RES - 1);
+// Touch is only sampled while the pen is down. After reporting the release the
+// read timer is paused; loop() resumes it when PENIRQ fires.
+void my_touchpad_read(lv_indev_t *indev, lv_indev_data_t *data) {
+    touch_point_t p;
+    if (touch_input_read(&p)) {
+        data->point.x = p.x;
+        data->point.y = p.y;
         data->state = LV_INDEV_STATE_PRESSED;
     } else {
         data->state = LV_INDEV_STATE_RELEASED;
+        lv_timer_pause(lv_indev_get_read_timer(indev));
+        touch_read_paused = true;
     }
 }
 
@@ -158,6 +264,49 @@ void splash_to_manual_cb(lv_timer_t * timer) {
     }
 }
 
+// ------------------------
+// UI loop frame slices
+// ------------------------
+// Motor completions and other application events from the task side
+static uint32_t slice_events(uint32_t budget_us) {
+    (void)budget_us;
+    actions_poll_events();
+    return FRAME_SCHED_IDLE;
+}
+
+static uint32_t slice_lvgl(uint32_t budget_us) {
+    (void)budget_us;   // timers and redraws run to completion
+    if (touch_read_paused && touch_input_pending()) {
+        lv_timer_t *t = lv_indev_get_read_timer(indev);
+        lv_timer_resume(t);
+        lv_timer_ready(t);
+        touch_read_paused = false;
+    }
+    const uint32_t wait_ms = lv_timer_handler();
+    return wait_ms == LV_NO_TIMER_READY ? FRAME_SCHED_IDLE : wait_ms;
+}
+
+// Flow queue and watch list. Unfinished work carries into the next frame; work a
+// paused debugger holds back is polled like timed work until it resumes.
+static uint32_t slice_flow(uint32_t budget_us) {
+    if (eez_flow_tick_budget(budget_us)) return 0;
+    return eez_flow_has_timed_work() ? UI_FLOW_POLL_MS : FRAME_SCHED_IDLE;
+}
+
+static uint32_t slice_screen_tick(uint32_t budget_us) {
+    (void)budget_us;
+    // g_currentScreen is a ScreensEnum - 1; -1 before the first screen loads
+    if (g_currentScreen >= 0 && g_currentScreen < SCREEN_ID_SETTINGS) tick_screen(g_currentScreen);
+    return FRAME_SCHED_IDLE;
+}
+
+static void ui_frame_init() {
+    frame_sched_add("events", slice_events, 0, UI_EVENTS_BUDGET_US, 0);
+    frame_sched_add("lvgl", slice_lvgl, 10, UI_LVGL_BUDGET_US, 0);
+    frame_sched_add("flow", slice_flow, 20, UI_FLOW_BUDGET_US, 0);
+    frame_sched_add("screen", slice_screen_tick, 30, UI_SCREEN_TICK_BUDGET_US, UI_SCREEN_TICK_MS);
+}
+
 void setup() {
     // ------------------------------------------------------------
     // FIX 1: Force PCF8574 safe outputs BEFORE ANY delays/scans
@@ -166,6 +315,7 @@ void setup() {
 
     Serial.begin(115200);
     delay(100);
+    log_init();
 
     String LVGL_Arduino = "Pup Button Firmware\nVersion 2.16\n";
     Serial.println("Pup Button Firmware");
@@ -185,7 +335,8 @@ void setup() {
     // PCF init
     initPCF8574Pins();
 
-    // Re-assert safe states via helper API (post-init)
+    // Re-assert safe states via helper API (post-init), one port write
+    beginPCF8574Outputs();
     setPCF8574Pin(0, false); // motor off
     setPCF8574Pin(1, false); // motor off
     setPCF8574Pin(4, true);  // LED off (active-low)
@@ -195,6 +346,7 @@ void setup() {
     // Most PCF8574 libraries require writing HIGH to a pin to use it as an input.
     // If your wrapper uses inverted semantics, adjust here to match "released/high".
     setPCF8574Pin(7, false); // release/high (input)  <-- matches our actions.cpp assumption
+    commitPCF8574Outputs();
 
     Serial.println("PCF initialized + outputs forced safe (motor off, LED/IR off, P7 released)");
 
@@ -216,21 +368,44 @@ void setup() {
     tft.begin();
     tft.setRotation(1);
 
-    touchscreenSpi.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
-    touchscreen.begin(touchscreenSpi);
-    touchscreen.setRotation(1);
+    touch_input_begin(TFT_HOR_RES, TFT_VER_RES);
+    if (touch_input_held(TOUCH_CAL_HOLD_MS)) {
+        // Panel must be lit and not yet owned by LVGL/DMA
+        pinMode(21, OUTPUT);
+        digitalWrite(21, HIGH);
+        touch_input_calibrate(tft);
+    }
 
     lv_init();
-
-    draw_buf = new uint8_t[DRAW_BUF_SIZE];
-    lv_display_t *disp = lv_tft_espi_create(TFT_HOR_RES, TFT_VER_RES, draw_buf, DRAW_BUF_SIZE);
+    lv_tick_set_cb(lv_tick_from_esp_timer);
+    img_rle_init();   // splash is an RLE asset from tools/img_assets.py
+
+    // Two DMA-capable bands: one on the wire while LVGL renders the other
+    draw_buf = (uint8_t *)heap_caps_malloc(DRAW_BUF_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    draw_buf2 = (uint8_t *)heap_caps_malloc(DRAW_BUF_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    tft_dma_ok = (draw_buf != nullptr) && (draw_buf2 != nullptr) && tft.initDMA();
+
+    lv_display_t *disp = lv_display_create(TFT_HOR_RES, TFT_VER_RES);
+    if (tft_dma_ok) {
+        tft.startWrite();
+        lv_display_set_buffers(disp, draw_buf, draw_buf2, DRAW_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        lv_display_set_flush_wait_cb(disp, my_disp_flush_wait);
+        LOGI(UI, "Display: DMA flush, 2 draw buffers");
+    } else {
+        if (draw_buf2) { heap_caps_free(draw_buf2); draw_buf2 = nullptr; }
+        if (!draw_buf) draw_buf = new uint8_t[DRAW_BUF_SIZE];
+        lv_display_set_buffers(disp, draw_buf, NULL, DRAW_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        LOGW(UI, "Display: DMA unavailable; blocking flush");
+    }
     lv_display_set_flush_cb(disp, my_disp_flush);
-    tft.setRotation(1);
 
     indev = lv_indev_create();
     lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(indev, my_touchpad_read);
 
+    // setup() and loop() share the Arduino loop task
+    ui_task_handle = xTaskGetCurrentTaskHandle();
+
     // Backlighting
     pinMode(21, OUTPUT);
     digitalWrite(21, HIGH);
@@ -239,7 +414,9 @@ void setup() {
     ledcWrite(0, 255);
 
     Serial.println("LVGL Setup done");
+    schedule_state_init();   // subjects must exist before screens bind to them
     ui_init();
+    ui_frame_init();
 
     Serial.println("display splash screen");
     lv_timer_create(splash_to_manual_cb, 3000, NULL);
@@ -251,7 +428,8 @@ void setup() {
     float sum = 0;
 
 for(int i=0;i<10;i++){
-    int a = analogRead(35);
+    // ADC1 is owned by the DMA stream after actions_init(); read through it
+    int a = current_sense_read_adc(64);
     float v = (a / 4095.0f) * 3.3f;
 
     sum += v;
@@ -265,17 +443,49 @@ for(int i=0;i<10;i++){
     ZERO_CURRENT_VOLTAGE = sum / 10.0f;
 
     Serial.printf("Calibrated ZERO_CURRENT_VOLTAGE = %.4f V\n", ZERO_CURRENT_VOLTAGE);
+    run_log_init(ZERO_CURRENT_VOLTAGE);
+    motor_trace_init();
+
+    // Motor jobs resume the ADC stream; idle, it would hold off light sleep
+    current_sense_set_active(false);
+    configure_power_management();
+}
 
-    lastTick = millis();
+#if UI_FRAME_STATS_MS
+// Live flow heap use per allocation id (the hex ids in eez-flow.cpp)
+static void log_flow_alloc_stats() {
+    uint32_t free_bytes, alloc_bytes;
+    eez::getAllocInfo(free_bytes, alloc_bytes);
+    LOGI(SYS, "flow heap: %lu B in use, %lu B free", (unsigned long)alloc_bytes, (unsigned long)free_bytes);
+
+    eez::AllocIdInfo info;
+    for (unsigned i = 0; eez::getAllocInfo(i, info); i++) {
+        if (info.count == 0) continue;
+        LOGI(SYS, "  id %08lx: %lu live, %lu B (peak %lu B, %lu allocs)",
+                  (unsigned long)info.id, (unsigned long)info.count, (unsigned long)info.bytes,
+                  (unsigned long)info.peakBytes, (unsigned long)info.allocs);
+    }
 }
+#endif
 
 void loop() {
-    uint32_t now = millis();
-    uint32_t delta = now - lastTick;
-    lastTick = now;
+    uint32_t wait_ms = frame_sched_run();
+
+#if UI_FRAME_STATS_MS
+    static uint32_t last_stats_ms = 0;
+    if (millis() - last_stats_ms >= UI_FRAME_STATS_MS) {
+        last_stats_ms = millis();
+        frame_sched_log_stats();
+        log_flow_alloc_stats();
+    }
+    if (wait_ms > UI_FRAME_STATS_MS) wait_ms = UI_FRAME_STATS_MS;
+#endif
 
-    lv_tick_inc(delta);
-    lv_timer_handler();
+    if (wait_ms > UI_LOOP_MAX_SLEEP_MS) wait_ms = UI_LOOP_MAX_SLEEP_MS;
 
-    delay(5);
+    // Block until the next slice deadline or an early wake-up. Always at least one
+    // tick, even when something is already due: a loop that never blocks starves
+    // IDLE1 and with it the automatic light sleep.
+    TickType_t ticks = pdMS_TO_TICKS(wait_ms);
+    ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "motor_trace.h"
+
+#if MOTOR_TRACE
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <atomic>
+#include "jam_detect.h"
+#include "current_sense.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "log.h"
+
+// -----------------------------
+// Configuration
+// -----------------------------
+// ~17 KB per second of forward running at 8 kHz; runs longer than this are truncated
+#ifndef MOTOR_TRACE_BUF_BYTES
+#define MOTOR_TRACE_BUF_BYTES (64UL * 1024UL)
+#endif
+
+#ifndef MOTOR_TRACE_MAX_FILES
+#define MOTOR_TRACE_MAX_FILES 500
+#endif
+
+#ifndef MOTOR_TRACE_WRITE_CHUNK
+#define MOTOR_TRACE_WRITE_CHUNK 4096
+#endif
+
+#ifndef MOTOR_TRACE_TASK_PRIORITY
+#define MOTOR_TRACE_TASK_PRIORITY 1
+#endif
+
+#ifndef MOTOR_TRACE_TASK_CORE
+#define MOTOR_TRACE_TASK_CORE 0
+#endif
+
+#define MOTOR_TRACE_DIR "/traces"
+
+static_assert(sizeof(motor_trace_entry_t) == 8, "trace entries are 8 bytes");
+static_assert(sizeof(motor_trace_samples_t) == 8, "trace entries are 8 bytes");
+static_assert(sizeof(motor_trace_header_t) == 64, "trace header is 64 bytes");
+
+static const uint32_t CAPACITY = MOTOR_TRACE_BUF_BYTES / 8;
+
+// Buffer ownership: motor_task while RECORDING, the writer while WRITING
+enum { BUF_FREE = 0, BUF_RECORDING, BUF_WRITING };
+static std::atomic<uint8_t> g_buf_state{BUF_FREE};
+static std::atomic<uint32_t> g_skipped{0};   // runs not traced: writer still busy
+
+static uint8_t* g_buf = nullptr;
+static TaskHandle_t g_task = nullptr;
+static motor_trace_header_t g_hdr;
+
+// --------- motor_task only ----------
+static bool g_recording = false;
+static uint32_t g_count = 0;
+static int32_t g_last_tick = -1;
+static uint16_t g_stage[4];
+static uint8_t g_stage_n = 0;
+static uint32_t g_run_seq = 0;
+
+// --------- Writer task only ----------
+static uint32_t g_file_no = 0;
+static uint32_t g_oldest_no = 0;
+static uint32_t g_file_count = 0;
+
+// -----------------------------
+// Recording (motor_task)
+// -----------------------------
+// The last slot is kept for TRACE_EV_FINISH
+static inline uint8_t* next_slot(bool final_entry) {
+    if (g_count >= CAPACITY - (final_entry ? 0 : 1)) {
+        g_hdr.truncated = 1;
+        return nullptr;
+    }
+    return g_buf + 8 * g_count++;
+}
+
+static void flush_samples() {
+    if (g_stage_n == 0) return;
+    uint8_t* slot = next_slot(false);
+    if (slot) {
+        motor_trace_samples_t e;
+        memset(&e, 0, sizeof(e));
+        e.kind = TRACE_SAMPLES;
+        e.count = g_stage_n;
+        // s0 | s1 << 12 | s2 << 24 | s3 << 36
+        uint64_t bits = 0;
+        for (uint8_t i = 0; i < g_stage_n; i++) bits |= (uint64_t)(g_stage[i] & 0x0FFF) << (12 * i);
+        for (int b = 0; b < 6; b++) e.packed[b] = (uint8_t)(bits >> (8 * b));
+        memcpy(slot, &e, sizeof(e));
+    }
+    g_stage_n = 0;
+}
+
+static void put_entry(uint8_t kind, uint8_t code, uint16_t arg, uint64_t now_us, bool final_entry) {
+    flush_samples();
+    uint8_t* slot = next_slot(final_entry);
+    if (!slot) return;
+    motor_trace_entry_t e;
+    e.kind = kind;
+    e.code = code;
+    e.arg = arg;
+    e.t_us = (uint32_t)(now_us - g_hdr.start_us);
+    memcpy(slot, &e, sizeof(e));
+    if (kind == TRACE_TICK) g_last_tick = (int32_t)(g_count - 1);
+}
+
+void motor_trace_begin(uint64_t start_us, int32_t zero_counts, uint16_t tick_ms) {
+    g_recording = false;
+    if (!g_buf) return;
+    uint8_t expected = BUF_FREE;
+    if (!g_buf_state.compare_exchange_strong(expected, BUF_RECORDING)) {
+        g_skipped.fetch_add(1);
+        return;
+    }
+
+    memset(&g_hdr, 0, sizeof(g_hdr));
+    memcpy(g_hdr.magic, "NPTR", 4);
+    g_hdr.version = MOTOR_TRACE_VERSION;
+    g_hdr.entry_bytes = 8;
+    g_hdr.start_us = start_us;
+    g_hdr.sample_rate_hz = current_sense_is_streaming() ? current_sense_sample_rate_hz() : 0;
+    g_hdr.tick_ms = tick_ms;
+    g_hdr.zero_counts = (uint16_t)zero_counts;
+    g_hdr.run_seq = g_run_seq++;
+    g_hdr.jam_on_counts = (uint16_t)amps_to_counts(JAM_FILTERED_THRESHOLD_AMPS);
+    g_hdr.jam_off_counts = (uint16_t)amps_to_counts(JAM_FILTERED_RELEASE_AMPS);
+    g_hdr.no_motion_startup_ms = JAM_NO_MOTION_STARTUP_MS;
+    g_hdr.no_motion_timeout_ms = JAM_NO_MOTION_TIMEOUT_MS;
+    g_hdr.filtered_confirm_ms = JAM_FILTERED_CONFIRM_MS;
+    g_hdr.rearm_ms = MOTOR_JAM_REARM_MS;
+
+    g_count = 0;
+    g_last_tick = -1;
+    g_stage_n = 0;
+    g_recording = true;
+}
+
+void motor_trace_tick(uint64_t now_us, uint8_t flags, uint16_t win_mean) {
+    if (g_recording) put_entry(TRACE_TICK, flags, win_mean, now_us, false);
+}
+
+void motor_trace_tick_inputs(uint8_t flags) {
+    if (!g_recording || g_last_tick < 0) return;
+    g_buf[8 * g_last_tick + 1] |= flags;
+}
+
+void motor_trace_samples(const uint16_t* s, uint16_t n) {
+    if (!g_recording) return;
+    for (uint16_t i = 0; i < n; i++) {
+        g_stage[g_stage_n++] = s[i];
+        if (g_stage_n == 4) flush_samples();
+    }
+}
+
+void motor_trace_event(uint64_t now_us, uint8_t code, uint16_t arg) {
+    if (g_recording) put_entry(TRACE_EVENT, code, arg, now_us, code == TRACE_EV_FINISH);
+}
+
+void motor_trace_end(uint8_t reason) {
+    if (!g_recording) return;
+    g_recording = false;
+    flush_samples();
+    g_hdr.reason = reason;
+    g_hdr.entry_count = g_count;
+    g_buf_state.store(BUF_WRITING);
+    xTaskNotifyGive(g_task);
+}
+
+// -----------------------------
+// Writer task
+// -----------------------------
+static void file_path(uint32_t no, char* out, size_t len) {
+    snprintf(out, len, MOTOR_TRACE_DIR "/%05lu.trc", (unsigned long)no);
+}
+
+static void scan_files() {
+    File dir = SD.open(MOTOR_TRACE_DIR);
+    if (!dir || !dir.isDirectory()) {
+        SD.mkdir(MOTOR_TRACE_DIR);
+        return;
+    }
+    bool any = false;
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        const char* base = strrchr(f.name(), '/');
+        base = base ? base + 1 : f.name();
+        char* end = nullptr;
+        const unsigned long no = strtoul(base, &end, 10);
+        if (!f.isDirectory() && end != base && strcmp(end, ".trc") == 0) {
+            if (!any || no >= g_file_no) g_file_no = no + 1;
+            if (!any || no < g_oldest_no) g_oldest_no = no;
+            g_file_count++;
+            any = true;
+        }
+        f.close();
+    }
+    dir.close();
+}
+
+static void write_trace() {
+    char path[32];
+    file_path(g_file_no, path, sizeof(path));
+    File f = SD.open(path, FILE_WRITE);
+    if (!f) {
+        LOGW(TRACE, "cannot create %s", path);
+        return;
+    }
+    bool ok = f.write((const uint8_t*)&g_hdr, sizeof(g_hdr)) == sizeof(g_hdr);
+    const uint32_t bytes = g_hdr.entry_count * 8;
+    for (uint32_t off = 0; ok && off < bytes; off += MOTOR_TRACE_WRITE_CHUNK) {
+        const uint32_t n = bytes - off < MOTOR_TRACE_WRITE_CHUNK ? bytes - off : MOTOR_TRACE_WRITE_CHUNK;
+        ok = f.write(g_buf + off, n) == n;
+    }
+    f.close();
+    if (!ok) {
+        LOGW(TRACE, "write to %s failed", path);
+        return;
+    }
+    LOGI(TRACE, "%s: %lu entries%s", path, (unsigned long)g_hdr.entry_count,
+                 g_hdr.truncated ? " (truncated)" : "");
+
+    if (g_file_count++ == 0) g_oldest_no = g_file_no;
+    g_file_no++;
+    while (g_file_count > MOTOR_TRACE_MAX_FILES && g_oldest_no < g_file_no) {
+        file_path(g_oldest_no++, path, sizeof(path));
+        if (SD.remove(path)) g_file_count--;
+    }
+}
+
+static void motor_trace_task(void* param) {
+    (void)param;
+    uint32_t skipped_seen = 0;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (g_buf_state.load() != BUF_WRITING) continue;
+        write_trace();
+        const uint32_t skipped = g_skipped.load();
+        if (skipped != skipped_seen) {
+            LOGW(TRACE, "%lu run(s) not traced (writer busy)",
+                         (unsigned long)(skipped - skipped_seen));
+            skipped_seen = skipped;
+        }
+        g_buf_state.store(BUF_FREE);
+    }
+}
+
+// -----------------------------
+// API
+// -----------------------------
+void motor_trace_init(void) {
+    if (g_task) return;
+    if (SD.cardType() == CARD_NONE) {
+        LOGW(TRACE, "no SD card; motor traces disabled.");
+        return;
+    }
+    g_buf = (uint8_t*)malloc(MOTOR_TRACE_BUF_BYTES);
+    if (!g_buf) {
+        LOGW(TRACE, "cannot allocate %lu bytes; motor traces disabled.",
+                     (unsigned long)MOTOR_TRACE_BUF_BYTES);
+        return;
+    }
+    scan_files();
+
+    xTaskCreatePinnedToCore(
+        motor_trace_task,
+        "motor_trace",
+        4096,           // SD/FS file access
+        nullptr,
+        MOTOR_TRACE_TASK_PRIORITY,
+        &g_task,
+        MOTOR_TRACE_TASK_CORE
+    );
+    if (!g_task) {
+        free(g_buf);
+        g_buf = nullptr;
+        return;
+    }
+    LOGI(TRACE, "recording motor runs (%lu KB buffer) to " MOTOR_TRACE_DIR,
+                 (unsigned long)(MOTOR_TRACE_BUF_BYTES / 1024));
+}
+
+#endif // MOTOR_TRACE
@@ -0,0 +1,112 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-run sensor trace for jam-detector tuning (opt-in: build with -D MOTOR_TRACE=1).
+//
+// During a motor job, motor_task appends everything jam detection sees to a RAM
+// buffer allocated once at boot: every raw ADC sample fed to the DSP chain, and per
+// tick the rotary / beam inputs and a microsecond timestamp, plus the state
+// transitions it acted on. After the job a low-priority task writes the buffer to
+// /traces/NNNNN.trc on SD; a run that starts while the previous one is still being
+// written is not traced. tools/trace_replay.cpp runs traces back through
+// jam_detect.h on a PC.
+//
+// File: motor_trace_header_t, then entry_count 8-byte entries (kind in byte 0).
+
+#ifndef MOTOR_TRACE
+#define MOTOR_TRACE 0
+#endif
+
+#define MOTOR_TRACE_VERSION 1
+
+enum {
+    TRACE_TICK = 1,      // one motor_job_tick()
+    TRACE_SAMPLES,       // 1..4 raw ADC samples fed to the DSP chain this tick
+    TRACE_EVENT
+};
+
+// TRACE_TICK flags
+#define TRACE_F_REVERSE   0x01   // tick spent in unjam reverse (no samples, no checks)
+#define TRACE_F_CHECKED   0x02   // IR settled: inputs read and jam paths evaluated
+#define TRACE_F_ROTARY    0x04   // rotary level (HIGH = safe to stop)
+#define TRACE_F_BEAM      0x08   // beam broken
+#define TRACE_F_MOTION    0x10   // rotary changed since the last checked tick
+
+// TRACE_EVENT codes
+enum {
+    TRACE_EV_JAM_NO_MOTION = 1,   // path A fired; arg = retry number
+    TRACE_EV_JAM_FILTERED,        // path B fired; arg = retry number
+    TRACE_EV_REVERSE_END,         // forward again
+    TRACE_EV_TREAT,               // beam broken: treat dispensed
+    TRACE_EV_ROTARY_LH,           // rotary LOW->HIGH before a treat; arg = count
+    TRACE_EV_FINISH               // arg = MotorStopReason
+};
+
+typedef struct __attribute__((packed)) {
+    uint8_t  kind;       // TRACE_TICK / TRACE_EVENT
+    uint8_t  code;       // tick: TRACE_F_*; event: TRACE_EV_*
+    uint16_t arg;        // tick: window mean (ADC counts); event: see codes
+    uint32_t t_us;       // since motor_trace_header_t.start_us
+} motor_trace_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  kind;       // TRACE_SAMPLES
+    uint8_t  count;      // 1..4
+    uint8_t  packed[6];  // 4 x 12-bit, little-endian bit order
+} motor_trace_samples_t;
+
+typedef struct __attribute__((packed)) {
+    char     magic[4];          // "NPTR"
+    uint8_t  version;           // MOTOR_TRACE_VERSION
+    uint8_t  entry_bytes;       // 8
+    uint8_t  reason;            // MotorStopReason
+    uint8_t  truncated;         // buffer filled before the run ended
+    uint64_t start_us;          // esp_timer time of job start (millis() = us / 1000)
+    uint32_t entry_count;
+    uint32_t sample_rate_hz;
+    uint16_t tick_ms;
+    uint16_t zero_counts;
+    uint32_t run_seq;           // traces since boot
+    // Detector build the trace was taken with, for reference
+    uint16_t jam_on_counts;
+    uint16_t jam_off_counts;
+    uint16_t no_motion_startup_ms;
+    uint16_t no_motion_timeout_ms;
+    uint16_t filtered_confirm_ms;
+    uint16_t rearm_ms;
+    uint8_t  reserved[20];
+} motor_trace_header_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MOTOR_TRACE
+
+// Allocate the buffer and start the writer. Call once, after SD.begin().
+void motor_trace_init(void);
+
+// motor_task only
+void motor_trace_begin(uint64_t start_us, int32_t zero_counts, uint16_t tick_ms);
+void motor_trace_tick(uint64_t now_us, uint8_t flags, uint16_t win_mean);
+void motor_trace_tick_inputs(uint8_t flags);   // OR into the current tick's flags
+void motor_trace_samples(const uint16_t* s, uint16_t n);
+void motor_trace_event(uint64_t now_us, uint8_t code, uint16_t arg);
+void motor_trace_end(uint8_t reason);
+
+#else
+
+static inline void motor_trace_init(void) {}
+static inline void motor_trace_begin(uint64_t start_us, int32_t zero_counts, uint16_t tick_ms) { (void)start_us; (void)zero_counts; (void)tick_ms; }
+static inline void motor_trace_tick(uint64_t now_us, uint8_t flags, uint16_t win_mean) { (void)now_us; (void)flags; (void)win_mean; }
+static inline void motor_trace_tick_inputs(uint8_t flags) { (void)flags; }
+static inline void motor_trace_samples(const uint16_t* s, uint16_t n) { (void)s; (void)n; }
+static inline void motor_trace_event(uint64_t now_us, uint8_t code, uint16_t arg) { (void)now_us; (void)code; (void)arg; }
+static inline void motor_trace_end(uint8_t reason) { (void)reason; }
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
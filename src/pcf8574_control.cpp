@@ -1,23 +1,117 @@
 #include "pcf8574_control.h"
 #include <Wire.h>
+#include "log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #define PCF8574_ADDRESS 0x20
 // Keep currentPinState accurate; never read the expander just to modify
 static uint8_t currentPinState = 0xFF;  // 1 = released (input/high), 0 = driven low
 
+// ---------------------------
+// Bus lock
+// ---------------------------
+// The motor task and the LVGL thread both use the expander. A recursive mutex
+// serialises Wire access and is held for the whole of an output transaction,
+// so begin/commit pairs from different tasks never interleave.
+// Created by initPCF8574Pins(), which setup() calls before any other use.
+static SemaphoreHandle_t busMutex = NULL;
+
+static inline void busLock() {
+    xSemaphoreTakeRecursive(busMutex, portMAX_DELAY);
+}
+
+static inline void busUnlock() {
+    xSemaphoreGiveRecursive(busMutex);
+}
+
 // Define which pins are inputs (mask) so we only force those back to input.
 static constexpr uint8_t INPUT_PINS_MASK =
     (1 << PIN_BUTTON) | (1 << PIN_ROT_DETECT) | (1 << PIN_IR_RX) | (1 << PIN_REMOTE_RX);
 
+// ---------------------------
+// Input snapshot cache
+// ---------------------------
+// One bus read serves every pin read until the snapshot is older than
+// PCF8574_SNAPSHOT_MAX_AGE_US (or, with PCF8574_INT_PIN wired, until INT falls).
+// Output bits are taken from currentPinState, so writes never stale the cache.
+// snapshotSeq moves only when a refresh sees an input bit change, so pollers can
+// skip their work while the inputs sit still.
+static uint8_t snapshotPort = 0xFF;
+static uint32_t snapshotStampUs = 0;
+static volatile bool snapshotDirty = true;
+static uint32_t snapshotSeq = 0;
+static uint32_t busReadCount = 0;
+
+#if PCF8574_INT_PIN >= 0
+static bool intAttached = false;
+
+static void IRAM_ATTR pcf8574IntIsr() {
+    snapshotDirty = true;
+}
+#endif
+
+// Forward: live bus read of the whole port
+bool readPCF8574Port(uint8_t &portValue);
+
+static void refreshSnapshot(uint32_t nowUs) {
+    // Clear before reading: an edge during the transfer re-dirties the cache.
+    snapshotDirty = false;
+    uint8_t live;
+    if (!readPCF8574Port(live)) {
+        snapshotDirty = true;  // retry on next read; keep last good inputs
+        return;
+    }
+    if ((live ^ snapshotPort) & INPUT_PINS_MASK) snapshotSeq++;
+    snapshotPort = live;
+    snapshotStampUs = nowUs;
+}
+
+// ---------------------------
+// Output interlocks
+// ---------------------------
+// Each entry is a group of output bits that must never be HIGH together.
+// IN1+IN2 both HIGH is brake/shoot-through on the H-bridge; a commit that
+// requests it is resolved to both LOW (coast) before it reaches the bus.
+static constexpr uint8_t HBRIDGE_INTERLOCK_MASK = (1 << PIN_MOTOR_IN1) | (1 << PIN_MOTOR_IN2);
+static constexpr uint8_t OUTPUT_INTERLOCKS[] = { HBRIDGE_INTERLOCK_MASK };
+static constexpr size_t OUTPUT_INTERLOCK_COUNT = sizeof(OUTPUT_INTERLOCKS) / sizeof(OUTPUT_INTERLOCKS[0]);
+
+static constexpr bool violatesInterlock(uint8_t port, size_t i = 0) {
+    return i < OUTPUT_INTERLOCK_COUNT &&
+           (((port & OUTPUT_INTERLOCKS[i]) == OUTPUT_INTERLOCKS[i]) || violatesInterlock(port, i + 1));
+}
+
+static constexpr uint8_t applyInterlocks(uint8_t port, size_t i = 0) {
+    return i >= OUTPUT_INTERLOCK_COUNT ? port
+         : applyInterlocks(((port & OUTPUT_INTERLOCKS[i]) == OUTPUT_INTERLOCKS[i])
+                               ? (uint8_t)(port & ~OUTPUT_INTERLOCKS[i]) : port,
+                           i + 1);
+}
+
+static_assert((HBRIDGE_INTERLOCK_MASK & INPUT_PINS_MASK) == 0, "interlocked pins must be outputs");
+static_assert(!violatesInterlock(applyInterlocks(0xFF)), "interlock resolution must be safe");
+static_assert(applyInterlocks(0xFF) == (uint8_t)~HBRIDGE_INTERLOCK_MASK, "release-all must coast the motor");
+
+// Pending byte for an open output transaction (valid while txnDepth > 0)
+static uint8_t pendingPinState = 0xFF;
+static uint8_t txnDepth = 0;
+
 // Ensure input pins cannot be latched LOW
 static void writePort(uint8_t newState) {
     uint8_t requested = newState;
     // Force all input bits HIGH (released)
     newState |= INPUT_PINS_MASK;
 
+    if (violatesInterlock(newState)) {
+        newState = applyInterlocks(newState);
+        LOGW(PCF, "Output interlock: 0x%02X -> 0x%02X (IN1+IN2 never both HIGH)",
+                  requested, newState);
+    }
+
     // If caller tried to clear button bit, note it
     if ((requested & (1 << PIN_BUTTON)) == 0 && (currentPinState & (1 << PIN_BUTTON)) != 0) {
-        Serial.println("[WARN] Attempt to latch BUTTON (P3) LOW blocked; forcing HIGH.");
+        LOGW(PCF, "Attempt to latch BUTTON (P3) LOW blocked; forcing HIGH.");
     }
 
     if (newState == currentPinState) return;
@@ -37,28 +131,71 @@ static inline void ensureButtonReleased() {
         Wire.write(newState);
         Wire.endTransmission();
         currentPinState = newState;
-        Serial.println("[FIX] P3 latch re‑released (set HIGH).");
+        LOGI(PCF, "[FIX] P3 latch re‑released (set HIGH).");
     }
 }
 
 void initPCF8574Pins() {
-    writePort(0xFF); // release all pins once
+    if (!busMutex) busMutex = xSemaphoreCreateRecursiveMutex();
+#if PCF8574_INT_PIN >= 0
+    if (!intAttached) {
+        pinMode(PCF8574_INT_PIN, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(PCF8574_INT_PIN), pcf8574IntIsr, FALLING);
+        intAttached = true;
+        LOGI(PCF, "PCF8574 INT on GPIO%d -> input snapshot refreshed on change", PCF8574_INT_PIN);
+    }
+#endif
+    busLock();
+    snapshotDirty = true;
+    writePort(applyInterlocks(0xFF)); // release all pins once (motor IN1/IN2 stay LOW)
     ensureButtonReleased(); // make sure P3 is not stuck low
-    Serial.println("PCF8574 initialized (all pins HIGH, P3 input)");
+    busUnlock();
+    LOGI(PCF, "PCF8574 initialized (all pins HIGH, P3 input)");
+}
+
+static uint8_t readPortWithin(uint32_t maxAgeUs, uint32_t *ageUs) {
+    busLock();
+    const uint32_t nowUs = micros();
+    if (snapshotDirty || (uint32_t)(nowUs - snapshotStampUs) >= maxAgeUs) {
+        refreshSnapshot(nowUs);
+    }
+    if (ageUs) *ageUs = (uint32_t)(nowUs - snapshotStampUs);
+    const uint8_t port = (snapshotPort & INPUT_PINS_MASK) | (currentPinState & (uint8_t)~INPUT_PINS_MASK);
+    busUnlock();
+    return port;
+}
+
+uint8_t readPCF8574PortCached(uint32_t *ageUs) {
+    return readPortWithin(PCF8574_SNAPSHOT_MAX_AGE_US, ageUs);
+}
+
+// For slow pollers: any snapshot younger than their own period is as good as a
+// bus read, and while a motor job runs its tick keeps one that fresh.
+uint8_t readPCF8574PortMaxAge(uint32_t maxAgeUs) {
+    return readPortWithin(maxAgeUs, NULL);
+}
+
+uint32_t getPCF8574InputSeq() {
+    return snapshotSeq;
+}
+
+void invalidatePCF8574Snapshot() {
+    snapshotDirty = true;
+}
+
+uint32_t getPCF8574BusReadCount() {
+    return busReadCount;
 }
 
 // Update: do NOT write the port after reading; just return the bit.
+// Served from the snapshot cache; see readPCF8574PortCached().
 bool readPCF8574Pin(uint8_t pin) {
-    Wire.requestFrom(PCF8574_ADDRESS, 1);
-    if (Wire.available()) {
-        uint8_t value = Wire.read();
-        return (value & (1 << pin)) != 0;
-    }
-    return true;  // default HIGH if read fails
+    return (readPCF8574PortCached(NULL) & (1 << pin)) != 0;
 }
 
 // Add this helper to read the whole port (for debug)
 bool readPCF8574Port(uint8_t &portValue) {
+    busReadCount++;
     Wire.requestFrom(PCF8574_ADDRESS, 1);
     if (Wire.available()) {
         portValue = Wire.read();
@@ -71,61 +208,88 @@ bool readPCF8574Port(uint8_t &portValue) {
 // Debug helper: dump cached vs live
 void debugDumpPCF(const char *tag) {
     uint8_t live;
-    bool ok = readPCF8574Port(live);
-    Serial.print("[PCF] "); Serial.print(tag);
-    Serial.print(" cached=0x"); Serial.print(currentPinState, HEX);
-    Serial.print(" live=");
-    if (ok) { Serial.print("0x"); Serial.print(live, HEX); }
-    else Serial.print("READ_FAIL");
-    Serial.print(" BTNbit(live)=");
-    Serial.println( (live >> PIN_BUTTON) & 1 );
+    busLock();
+    const bool ok = readPCF8574Port(live);
+    const uint8_t cached = currentPinState;
+    busUnlock();
+    if (ok) {
+        LOGI(PCF, "%s cached=0x%X live=0x%X BTNbit(live)=%d",
+                  tag, cached, live, (live >> PIN_BUTTON) & 1);
+    } else {
+        LOGI(PCF, "%s cached=0x%X live=READ_FAIL", tag, cached);
+    }
 }
 
 // Optional combined read (returns bit and also live byte via ref)
 bool readPCF8574PinDebug(uint8_t pin, uint8_t &liveByte) {
-    Wire.requestFrom(PCF8574_ADDRESS, 1);
-    if (Wire.available()) {
-        liveByte = Wire.read();
-        return (liveByte & (1 << pin)) != 0;
-    }
-    liveByte = 0xFF;
-    return true;
+    busLock();
+    readPCF8574Port(liveByte);   // 0xFF (pin reads HIGH) on failure
+    busUnlock();
+    return (liveByte & (1 << pin)) != 0;
 }
 
 // Optional: explicit restore (call if you ever suspect latch corruption)
 void restoreInputPinsHigh() {
-    uint8_t forced = currentPinState | INPUT_PINS_MASK;
-    if (forced != currentPinState) {
-        writePort(forced);
-        Serial.println("[FIX] Restored input latch bits HIGH.");
-    }
+    busLock();
+    const uint8_t forced = currentPinState | INPUT_PINS_MASK;
+    const bool changed = forced != currentPinState;
+    if (changed) writePort(forced);
+    busUnlock();
+    if (changed) LOGI(PCF, "[FIX] Restored input latch bits HIGH.");
+}
+
+void beginPCF8574Outputs() {
+    busLock();  // released by the matching commit
+    if (txnDepth++ == 0) pendingPinState = currentPinState;
+}
+
+void commitPCF8574Outputs() {
+    if (txnDepth == 0) return;
+    if (--txnDepth == 0) writePort(pendingPinState);
+    busUnlock();
+}
+
+void setPCF8574Pins(uint8_t mask, uint8_t values) {
+    beginPCF8574Outputs();
+    pendingPinState = (pendingPinState & ~mask) | (values & mask);
+    commitPCF8574Outputs();
 }
 
 // Safe single-pin set (leave rest of file same, but make sure it calls writePort)
+// Inside a begin/commit transaction the change is staged, not written.
 void setPCF8574Pin(uint8_t pin, bool highRelease) {
     if (!highRelease && (INPUT_PINS_MASK & (1 << pin))) {
         static bool warned = false;
         if (!warned) {
-            Serial.print("[WARN] Ignored drive LOW on input pin "); Serial.println(pin);
+            LOGW(PCF, "Ignored drive LOW on input pin %d", pin);
             warned = true;
         }
         return;
     }
+    busLock();
+    const uint8_t base = txnDepth ? pendingPinState : currentPinState;
     uint8_t newState = highRelease
-        ? (currentPinState |  (1 << pin))
-        : (currentPinState & ~(1 << pin));
+        ? (base |  (1 << pin))
+        : (base & ~(1 << pin));
 
-    writePort(newState);
+    if (txnDepth) {
+        pendingPinState = newState;
+    } else {
+        writePort(newState);
+    }
+    busUnlock();
 }
 
 // Optional helper you can call from train_dispense_tick:
 void logPCFPortP3() {
+    busLock();
     ensureButtonReleased(); // auto-fix before logging / reading
     uint8_t portByte;
-    if (readPCF8574Port(portByte)) {
-        Serial.print("PORT=0x"); Serial.print(portByte, HEX);
-        Serial.print(" P3(bit3)="); Serial.println( (portByte >> 3) & 1 );
+    const bool ok = readPCF8574Port(portByte);
+    busUnlock();
+    if (ok) {
+        LOGI(PCF, "PORT=0x%X P3(bit3)=%d", portByte, (portByte >> 3) & 1);
     } else {
-        Serial.println("PORT READ FAIL");
+        LOGI(PCF, "PORT READ FAIL");
     }
 }
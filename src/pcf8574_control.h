@@ -13,6 +13,26 @@
 #define PIN_IR_RX        6  // Input: IR receiver signal
 #define PIN_REMOTE_RX    7  // Input: Remote control IR receiver
 
+// PCF8574 /INT (open-drain, active-low) -> ESP32 GPIO.
+// The CYD board does NOT wire /INT (its only free header pins carry SDA/SCL), so
+// the default is -1 and the input snapshot is purely age-based: refreshed at most
+// once per PCF8574_SNAPSHOT_MAX_AGE_US. Set this only on a board with /INT routed
+// to a GPIO; GPIO34..39 have no internal pull-up, fit an external 10k to 3V3.
+#ifndef PCF8574_INT_PIN
+#define PCF8574_INT_PIN  -1
+#endif
+
+// Max age of the cached port byte before a read goes back to the bus.
+// Without INT this is the effective poll rate; keep it below MOTOR_JOB_TICK_MS
+// so each motor tick sees one fresh snapshot shared by all pin reads.
+#ifndef PCF8574_SNAPSHOT_MAX_AGE_US
+#if PCF8574_INT_PIN >= 0
+#define PCF8574_SNAPSHOT_MAX_AGE_US 100000UL  // safety refresh only
+#else
+#define PCF8574_SNAPSHOT_MAX_AGE_US 2000UL
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -23,6 +43,19 @@ bool readPCF8574Pin(uint8_t pin);
 void setPCF8574Pin(uint8_t pin, bool state);
 void logPCFPortP3();  // optional debug
 
+// Output transactions: pin changes between begin/commit go out as ONE port write.
+// Nestable; only the outermost commit touches the bus.
+void beginPCF8574Outputs();
+void commitPCF8574Outputs();
+void setPCF8574Pins(uint8_t mask, uint8_t values);  // one write, bits in mask only
+
+// Input snapshot cache: whole port read at most once per max age (or per INT edge).
+uint8_t readPCF8574PortCached(uint32_t *ageUs);  // ageUs may be NULL
+uint8_t readPCF8574PortMaxAge(uint32_t maxAgeUs); // reuse any snapshot younger than maxAgeUs
+uint32_t getPCF8574InputSeq();                   // bumps when a refresh sees input bits change
+void invalidatePCF8574Snapshot();                // force next read to hit the bus
+uint32_t getPCF8574BusReadCount();               // I2C reads since boot (tuning)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,316 @@
+#include "run_log.h"
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <LittleFS.h>
+#include <atomic>
+#include "spsc_queue.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "log.h"
+
+// -----------------------------
+// Configuration
+// -----------------------------
+// Records held between motor_task and the writer; power of two
+#ifndef RUN_LOG_RING_LEN
+#define RUN_LOG_RING_LEN 32
+#endif
+
+// Unit of every write: one SD sector
+#ifndef RUN_LOG_PAGE_BYTES
+#define RUN_LOG_PAGE_BYTES 512
+#endif
+
+// A part-filled page is written at most this long after its first unwritten record
+#ifndef RUN_LOG_FLUSH_MS
+#define RUN_LOG_FLUSH_MS 60000UL
+#endif
+
+#ifndef RUN_LOG_FILE_BYTES
+#define RUN_LOG_FILE_BYTES (256UL * 1024UL)   // ~8k runs per file
+#endif
+
+#ifndef RUN_LOG_MAX_FILES
+#define RUN_LOG_MAX_FILES 64
+#endif
+
+// Cap when logging to the internal flash partition (~1.5 MB)
+#ifndef RUN_LOG_LFS_MAX_FILES
+#define RUN_LOG_LFS_MAX_FILES 4
+#endif
+
+// No card: fall back to the internal flash partition
+#ifndef RUN_LOG_LITTLEFS_FALLBACK
+#define RUN_LOG_LITTLEFS_FALLBACK 1
+#endif
+
+#define RUN_LOG_DIR "/runlog"
+
+#ifndef RUN_LOG_TASK_PRIORITY
+#define RUN_LOG_TASK_PRIORITY 1
+#endif
+
+#ifndef RUN_LOG_TASK_STACK
+#define RUN_LOG_TASK_STACK 4096   // FS calls
+#endif
+
+#ifndef RUN_LOG_TASK_CORE
+#define RUN_LOG_TASK_CORE 0
+#endif
+
+static_assert(sizeof(run_log_record_t) == RUN_LOG_SLOT_BYTES, "run_log_record_t must fill one slot");
+static_assert(sizeof(run_log_header_t) == RUN_LOG_SLOT_BYTES, "run_log_header_t must fill one slot");
+static_assert(RUN_LOG_PAGE_BYTES % RUN_LOG_SLOT_BYTES == 0, "pages hold whole slots");
+static_assert(RUN_LOG_FILE_BYTES % RUN_LOG_PAGE_BYTES == 0, "files hold whole pages");
+
+// --------- Shared with motor_task ----------
+static SpscQueue<run_log_record_t, RUN_LOG_RING_LEN> g_ring;
+static std::atomic<uint32_t> g_dropped{0};
+static TaskHandle_t g_task = nullptr;
+
+// --------- Writer task only ----------
+// FATFS serializes access per volume, so this and audio_task's WAV reads share the
+// card safely; a page write holds it for a few ms at a time.
+static fs::FS* g_fs = nullptr;
+static uint16_t g_max_files = RUN_LOG_MAX_FILES;
+static File g_file;
+static uint32_t g_file_no = 0;      // current file
+static uint32_t g_oldest_no = 0;
+static uint32_t g_file_count = 0;
+static uint32_t g_page_off = 0;     // file offset of g_page
+static uint16_t g_page_used = 0;    // bytes of g_page holding slots
+static uint8_t  g_page[RUN_LOG_PAGE_BYTES];
+static uint16_t g_boot = 0;
+static uint32_t g_seq = 0;
+static uint16_t g_zero_mv = 0;
+
+// -----------------------------
+// Helpers
+// -----------------------------
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF); bitwise, runs on the writer only
+static uint16_t crc16(const uint8_t* p, size_t n) {
+    uint16_t crc = 0xFFFF;
+    while (n--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void file_path(uint32_t no, char* out, size_t len) {
+    snprintf(out, len, RUN_LOG_DIR "/%05lu.bin", (unsigned long)no);
+}
+
+// Number from "/runlog/00042.bin" or "00042.bin"; false for anything else
+static bool parse_file_no(const char* name, uint32_t* no) {
+    const char* base = strrchr(name, '/');
+    base = base ? base + 1 : name;
+    char* end = nullptr;
+    const unsigned long v = strtoul(base, &end, 10);
+    if (end == base || strcmp(end, ".bin") != 0) return false;
+    *no = (uint32_t)v;
+    return true;
+}
+
+static bool read_header(uint32_t no, run_log_header_t* hdr) {
+    char path[32];
+    file_path(no, path, sizeof(path));
+    File f = g_fs->open(path, FILE_READ);
+    if (!f) return false;
+    const bool ok = f.read((uint8_t*)hdr, sizeof(*hdr)) == sizeof(*hdr) &&
+                    memcmp(hdr->magic, "NPRL", 4) == 0 &&
+                    hdr->crc == crc16((const uint8_t*)hdr, offsetof(run_log_header_t, crc));
+    f.close();
+    return ok;
+}
+
+// -----------------------------
+// Files
+// -----------------------------
+static void scan_files() {
+    bool any = false;
+    File dir = g_fs->open(RUN_LOG_DIR);
+    if (!dir || !dir.isDirectory()) {
+        g_fs->mkdir(RUN_LOG_DIR);
+        return;
+    }
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        uint32_t no;
+        if (!f.isDirectory() && parse_file_no(f.name(), &no)) {
+            if (!any || no > g_file_no) g_file_no = no;
+            if (!any || no < g_oldest_no) g_oldest_no = no;
+            g_file_count++;
+            any = true;
+        }
+        f.close();
+    }
+    dir.close();
+
+    run_log_header_t hdr;
+    if (any && read_header(g_file_no, &hdr)) g_boot = (uint16_t)(hdr.boot + 1);
+    if (any) g_file_no++;
+}
+
+static void write_page();
+
+static bool open_file() {
+    char path[32];
+    file_path(g_file_no, path, sizeof(path));
+    // "w", not "a": pages are rewritten in place as they fill
+    g_file = g_fs->open(path, FILE_WRITE);
+    if (!g_file) {
+        LOGW(RUNLOG, "Run log: cannot create %s", path);
+        return false;
+    }
+    if (g_file_count++ == 0) g_oldest_no = g_file_no;
+
+    run_log_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, "NPRL", 4);
+    hdr.version = RUN_LOG_VERSION;
+    hdr.slot_bytes = RUN_LOG_SLOT_BYTES;
+    hdr.boot = g_boot;
+    hdr.first_seq = g_seq;
+    hdr.uptime_ms = millis();
+    hdr.zero_mv = g_zero_mv;
+    hdr.crc = crc16((const uint8_t*)&hdr, offsetof(run_log_header_t, crc));
+
+    memset(g_page, 0xFF, sizeof(g_page));
+    memcpy(g_page, &hdr, sizeof(hdr));
+    g_page_off = 0;
+    g_page_used = sizeof(hdr);
+    LOGI(RUNLOG, "Run log: %s (boot %u)", path, (unsigned)g_boot);
+    write_page();
+
+    // Rotation: drop the oldest files beyond the cap
+    while (g_file_count > g_max_files && g_oldest_no < g_file_no) {
+        file_path(g_oldest_no++, path, sizeof(path));
+        if (g_fs->remove(path)) g_file_count--;
+    }
+    return (bool)g_file;
+}
+
+// Write g_page where it belongs; once full, move on to the next page (or file)
+static void write_page() {
+    if (!g_file) return;
+    if (!g_file.seek(g_page_off) || g_file.write(g_page, sizeof(g_page)) != sizeof(g_page)) {
+        // Never reopen this file: "w" would truncate it. The next record starts a new one.
+        LOGW(RUNLOG, "Run log: page write failed; closing file.");
+        g_file.close();
+        g_file_no++;
+        return;
+    }
+    g_file.flush();
+
+    if (g_page_used < sizeof(g_page)) return;
+    memset(g_page, 0xFF, sizeof(g_page));
+    g_page_used = 0;
+    g_page_off += sizeof(g_page);
+    if (g_page_off >= RUN_LOG_FILE_BYTES) {
+        g_file.close();
+        g_file_no++;
+        (void)open_file();
+    }
+}
+
+// -----------------------------
+// Writer task
+// -----------------------------
+static void run_log_task(void* param) {
+    (void)param;
+    bool dirty = false;
+    uint32_t dirty_since = 0;
+    uint32_t dropped_seen = 0;
+
+    for (;;) {
+        // Asleep until a record arrives or a part-filled page is due
+        TickType_t wait = portMAX_DELAY;
+        if (dirty) {
+            const uint32_t age = millis() - dirty_since;
+            wait = age >= RUN_LOG_FLUSH_MS ? 0 : pdMS_TO_TICKS(RUN_LOG_FLUSH_MS - age);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        run_log_record_t rec;
+        while (g_ring.pop(rec)) {
+            if (!g_file && !open_file()) continue;   // card gone: records are lost
+
+            rec.magic = RUN_LOG_RECORD_MAGIC;
+            rec.seq = g_seq++;
+            rec.crc = crc16((const uint8_t*)&rec, offsetof(run_log_record_t, crc));
+            memcpy(g_page + g_page_used, &rec, sizeof(rec));
+            g_page_used += sizeof(rec);
+
+            if (g_page_used == sizeof(g_page)) {
+                write_page();
+                dirty = false;
+            } else if (!dirty) {
+                dirty = true;
+                dirty_since = millis();
+            }
+        }
+
+        if (dirty && millis() - dirty_since >= RUN_LOG_FLUSH_MS) {
+            write_page();
+            dirty = false;
+        }
+
+        const uint32_t dropped = g_dropped.load(std::memory_order_relaxed);
+        if (dropped != dropped_seen) {
+            LOGW(RUNLOG, "Run log: %lu record(s) dropped (ring full)",
+                         (unsigned long)(dropped - dropped_seen));
+            dropped_seen = dropped;
+        }
+    }
+}
+
+// -----------------------------
+// API
+// -----------------------------
+void run_log_init(float zero_current_volts) {
+    if (g_task) return;
+
+    if (SD.cardType() != CARD_NONE) {
+        g_fs = &SD;
+        g_max_files = RUN_LOG_MAX_FILES;
+    }
+#if RUN_LOG_LITTLEFS_FALLBACK
+    else if (LittleFS.begin(true)) {
+        g_fs = &LittleFS;
+        g_max_files = RUN_LOG_LFS_MAX_FILES;
+    }
+#endif
+    if (!g_fs) {
+        LOGW(RUNLOG, "Run log: no filesystem; runs are not logged.");
+        return;
+    }
+
+    g_zero_mv = (uint16_t)lroundf(zero_current_volts * 1000.0f);
+    scan_files();
+    if (!open_file()) return;
+
+    xTaskCreatePinnedToCore(
+        run_log_task,
+        "run_log",
+        RUN_LOG_TASK_STACK,
+        nullptr,
+        RUN_LOG_TASK_PRIORITY,
+        &g_task,
+        RUN_LOG_TASK_CORE
+    );
+}
+
+bool run_log_append(const run_log_record_t* rec) {
+    if (!g_task || !rec) return false;
+    if (!g_ring.push(*rec)) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    xTaskNotifyGive(g_task);
+    return true;
+}
+
+uint32_t run_log_dropped(void) {
+    return g_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Append-only binary log of every motor run, for tuning jam thresholds from field data.
+//
+// The motor task fills one fixed 32-byte record per run and pushes it into a lock-free
+// ring (run_log_append never blocks or touches the filesystem). A low-priority writer
+// task stamps the sequence number and CRC and writes whole 512-byte pages to
+// /runlog/NNNNN.bin on SD (LittleFS if no card is mounted). Files rotate at
+// RUN_LOG_FILE_BYTES and the oldest are deleted past RUN_LOG_MAX_FILES.
+//
+// File layout: 32-byte slots. Slot 0 is a run_log_header_t, every other slot a
+// run_log_record_t or 0xFF padding (a page written before it filled up).
+// tools/run_log_decode.py turns a card's worth of files into CSV.
+
+#define RUN_LOG_RECORD_MAGIC 0xA5
+#define RUN_LOG_VERSION      1
+#define RUN_LOG_SLOT_BYTES   32
+
+typedef struct __attribute__((packed)) {
+    uint8_t  magic;          // RUN_LOG_RECORD_MAGIC
+    uint8_t  reason;         // MotorStopReason
+    uint8_t  retries;        // unjam attempts
+    uint8_t  flags;          // RUN_LOG_FLAG_*
+    uint32_t seq;            // per boot, from 0
+    uint32_t uptime_ms;      // when the run finished
+    uint32_t run_ms;         // excluding reverse time
+    uint16_t reverse_ms;     // saturating
+    uint16_t no_motion_ms;   // saturating
+    uint16_t transitions;    // rotary L->H
+    uint16_t peak_ma;
+    uint16_t filtered_ma;
+    uint16_t rms_ma;
+    uint16_t max_slope_ma;   // steepest rise over JAM_DSP_SLOPE_LAG
+    uint16_t crc;            // CRC-16/CCITT-FALSE over the bytes above
+} run_log_record_t;
+
+#define RUN_LOG_FLAG_TREAT       0x01
+#define RUN_LOG_FLAG_SAW_MOTION  0x02
+
+typedef struct __attribute__((packed)) {
+    char     magic[4];       // "NPRL"
+    uint8_t  version;        // RUN_LOG_VERSION
+    uint8_t  slot_bytes;     // RUN_LOG_SLOT_BYTES
+    uint16_t boot;           // increments each power-up
+    uint32_t first_seq;      // seq of the first record in this file
+    uint32_t uptime_ms;      // when the file was opened
+    uint16_t zero_mv;        // calibrated 0 A sensor voltage for this boot
+    uint8_t  reserved[12];
+    uint16_t crc;
+} run_log_header_t;
+
+// Mount the log and start the writer task. Call once, after SD.begin() and after the
+// current sensor is calibrated (the zero level goes into each file header).
+void run_log_init(float zero_current_volts);
+
+// Queue a record (magic, seq and crc are filled in by the writer). Single producer:
+// motor_task. Returns false if the ring is full or the log isn't running.
+bool run_log_append(const run_log_record_t* rec);
+
+uint32_t run_log_dropped(void);   // records lost to a full ring since boot
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,207 @@
+#include "schedule_planner.h"
+#include <Arduino.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variable-interval gaps are uniform in mean * (1 +/- this / 100)
+#ifndef PLAN_VI_SPREAD_PCT
+#define PLAN_VI_SPREAD_PCT 50
+#endif
+
+#define SECONDS_PER_HOUR 3600UL
+
+// ---------------------------
+// RNG (xorshift32): small, fast, and the same sequence on every build for a given seed
+// ---------------------------
+struct PlanRng {
+    uint32_t s;
+};
+
+static void rng_seed(PlanRng* r, uint32_t seed) {
+    // splitmix-style scramble so nearby seeds give unrelated streams; state must be non-zero
+    uint32_t z = seed + 0x9E3779B9UL;
+    z = (z ^ (z >> 16)) * 0x85EBCA6BUL;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35UL;
+    z ^= z >> 16;
+    r->s = z ? z : 0x6D2B79F5UL;
+}
+
+static inline uint32_t rng_next(PlanRng* r) {
+    uint32_t x = r->s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return r->s = x;
+}
+
+// Uniform in [0, n) without modulo bias worth caring about
+static inline uint32_t rng_below(PlanRng* r, uint32_t n) {
+    return (uint32_t)(((uint64_t)rng_next(r) * n) >> 32);
+}
+
+// Uniform in (0, 1]
+static inline float rng_unit(PlanRng* r) {
+    return (float)((rng_next(r) >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+// ---------------------------
+// Distributions
+// Each writes at most cap times into out, in ascending order, and returns how many
+// it wrote. The spacing pass in schedule_plan_build() relies on that order.
+// ---------------------------
+struct PlanDist {
+    const char* name;
+    uint32_t (*capacity)(const plan_params_t* p);
+    uint16_t (*generate)(const plan_params_t* p, PlanRng* rng, uint32_t* out, uint16_t cap);
+};
+
+static uint32_t exact_capacity(const plan_params_t* p) {
+    return (uint32_t)p->treats_per_hour * p->hours;
+}
+
+// Random-count processes: mean + 6 sigma + slack covers any realistic draw
+static uint32_t process_capacity(const plan_params_t* p) {
+    const float mean = (float)p->treats_per_hour * p->hours;
+    return (uint32_t)(mean + 6.0f * sqrtf(mean) + 8.0f);
+}
+
+static uint16_t gen_fixed(const plan_params_t* p, PlanRng* rng, uint32_t* out, uint16_t cap) {
+    (void)rng;
+    const uint32_t interval = SECONDS_PER_HOUR / p->treats_per_hour;
+    const uint32_t total = exact_capacity(p);
+    uint16_t n = 0;
+    for (uint32_t k = 0; k < total && n < cap; k++) out[n++] = k * interval;
+    return n;
+}
+
+// Evenly spaced "reliable" treats plus stratified random ones: each random treat gets
+// its own slice of the hour and a uniform offset inside it (O(1) per treat, already
+// ascending). The two ascending runs are then merged.
+static uint32_t mixed_capacity(const plan_params_t* p) {
+    const uint32_t tph = p->treats_per_hour < 2 ? 2 : p->treats_per_hour;
+    return tph * p->hours;
+}
+
+static uint16_t gen_mixed(const plan_params_t* p, PlanRng* rng, uint32_t* out, uint16_t cap) {
+    const uint32_t tph = p->treats_per_hour < 2 ? 2 : p->treats_per_hour;
+    const uint32_t reliable = (tph + 1) / 2;
+    const uint32_t random = tph / 2;
+    uint32_t hours = p->hours;
+    if (hours * tph > cap) hours = cap / tph;
+
+    uint32_t* jittered = (uint32_t*)malloc(sizeof(uint32_t) * (random * hours + 1));
+    if (!jittered) return 0;
+
+    uint32_t a = 0, b = 0;
+    const uint32_t spacing = SECONDS_PER_HOUR / reliable;
+    const uint32_t stratum = SECONDS_PER_HOUR / random;
+    for (uint32_t h = 0; h < hours; h++) {
+        const uint32_t base = h * SECONDS_PER_HOUR;
+        for (uint32_t k = 0; k < reliable; k++) out[a++] = base + k * spacing;
+        for (uint32_t r = 0; r < random; r++) jittered[b++] = base + r * stratum + rng_below(rng, stratum);
+    }
+
+    // Merge from the back: out[0, a) and jittered[0, b) -> out[0, a + b)
+    uint32_t i = a, j = b, k = a + b;
+    while (j > 0) {
+        if (i > 0 && out[i - 1] > jittered[j - 1]) out[--k] = out[--i];
+        else out[--k] = jittered[--j];
+    }
+    free(jittered);
+    return (uint16_t)(a + b);
+}
+
+static uint16_t gen_gaps(const plan_params_t* p, PlanRng* rng, uint32_t* out, uint16_t cap, bool poisson) {
+    const float mean = (float)SECONDS_PER_HOUR / p->treats_per_hour;
+    const float spread = PLAN_VI_SPREAD_PCT / 100.0f;
+    const float duration = (float)p->hours * SECONDS_PER_HOUR;
+    float t = 0.0f;
+    uint16_t n = 0;
+    while (n < cap && t < duration) {
+        out[n++] = (uint32_t)t;
+        const float u = rng_unit(rng);
+        t += poisson ? -mean * logf(u) : mean * (1.0f - spread + 2.0f * spread * u);
+    }
+    return n;
+}
+
+static uint16_t gen_variable(const plan_params_t* p, PlanRng* rng, uint32_t* out, uint16_t cap) {
+    return gen_gaps(p, rng, out, cap, false);
+}
+
+static uint16_t gen_poisson(const plan_params_t* p, PlanRng* rng, uint32_t* out, uint16_t cap) {
+    return gen_gaps(p, rng, out, cap, true);
+}
+
+static const PlanDist g_dists[PLAN_DIST_COUNT] = {
+    { "mixed",    mixed_capacity,   gen_mixed },
+    { "fixed",    exact_capacity,   gen_fixed },
+    { "variable", process_capacity, gen_variable },
+    { "poisson",  process_capacity, gen_poisson },
+};
+
+// ---------------------------
+// Planner
+// ---------------------------
+void schedule_plan_free(schedule_plan_t* plan) {
+    if (!plan) return;
+    free(plan->at_s);
+    memset(plan, 0, sizeof(*plan));
+}
+
+bool schedule_plan_build(const plan_params_t* params, schedule_plan_t* plan) {
+    if (!params || !plan) return false;
+    schedule_plan_free(plan);
+    if (params->dist >= PLAN_DIST_COUNT || params->treats_per_hour == 0 || params->hours == 0) return false;
+
+    const PlanDist* d = &g_dists[params->dist];
+    uint32_t cap = d->capacity(params);
+    if (cap > PLAN_MAX_TREATS) cap = PLAN_MAX_TREATS;
+    if (cap == 0) return false;
+
+    uint32_t* at = (uint32_t*)malloc(sizeof(uint32_t) * cap);
+    if (!at) return false;
+
+    const uint32_t seed = params->seed ? params->seed : (esp_random() | 1);
+    PlanRng rng;
+    rng_seed(&rng, seed);
+
+    uint16_t n = d->generate(params, &rng, at, (uint16_t)cap);
+    if (n == 0) {
+        free(at);
+        return false;
+    }
+
+    // Opener at 0, then enforce spacing in one pass; anything pushed past the end is dropped
+    const uint32_t duration = (uint32_t)params->hours * SECONDS_PER_HOUR;
+    at[0] = 0;
+    uint16_t kept = 1;
+    for (uint16_t i = 1; i < n; i++) {
+        uint32_t t = at[i];
+        const uint32_t earliest = at[kept - 1] + params->min_gap_s;
+        if (t < earliest) t = earliest;
+        if (t >= duration) break;
+        at[kept++] = t;
+    }
+
+    if (kept < cap) {
+        uint32_t* shrunk = (uint32_t*)realloc(at, sizeof(uint32_t) * kept);
+        if (shrunk) {
+            at = shrunk;
+            cap = kept;
+        }
+    }
+
+    plan->at_s = at;
+    plan->count = kept;
+    plan->capacity = (uint16_t)cap;
+    plan->seed = seed;
+    plan->duration_s = duration;
+    plan->dist = params->dist;
+    return true;
+}
+
+const char* schedule_plan_dist_name(plan_dist_t dist) {
+    return dist < PLAN_DIST_COUNT ? g_dists[dist].name : "?";
+}
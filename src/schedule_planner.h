@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Treat schedule planning: when, in seconds from schedule start, each treat is due.
+//
+// Plans are built in O(n), since every distribution emits ascending times, into a
+// heap buffer sized for the request and capped at PLAN_MAX_TREATS.
+// at_s[0] is always 0: the opener treat dispensed as the schedule starts.
+// Every plan records the seed it was drawn from; building again with that seed
+// reproduces it exactly.
+
+#ifndef PLAN_MAX_TREATS
+#define PLAN_MAX_TREATS 1024
+#endif
+
+typedef enum {
+    PLAN_DIST_MIXED = 0,  // half evenly spaced, half jittered within each hour (original behaviour)
+    PLAN_DIST_FIXED,      // fixed interval, 3600 / treats_per_hour
+    PLAN_DIST_VARIABLE,   // variable interval: gaps uniform in mean +/- PLAN_VI_SPREAD_PCT
+    PLAN_DIST_POISSON,    // exponential gaps at treats_per_hour
+    PLAN_DIST_COUNT
+} plan_dist_t;
+
+typedef struct {
+    plan_dist_t dist;
+    uint16_t treats_per_hour;
+    uint16_t hours;
+    uint32_t min_gap_s;   // later treats are pushed back to keep at least this spacing
+    uint32_t seed;        // 0 = draw a fresh one
+} plan_params_t;
+
+typedef struct {
+    uint32_t* at_s;       // ascending
+    uint16_t count;
+    uint16_t capacity;
+    uint32_t seed;        // seed actually used
+    uint32_t duration_s;
+    plan_dist_t dist;
+} schedule_plan_t;
+
+// Replace *plan with a new plan. Returns false (plan left empty) on bad params or OOM.
+bool schedule_plan_build(const plan_params_t* params, schedule_plan_t* plan);
+void schedule_plan_free(schedule_plan_t* plan);
+
+const char* schedule_plan_dist_name(plan_dist_t dist);
+
+#ifdef __cplusplus
+}
+#endif
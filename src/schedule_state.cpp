@@ -0,0 +1,55 @@
+#include "schedule_state.h"
+#include <stdio.h>
+
+// Defaults match the rollers' initial selection
+#define SCHEDULE_DEFAULT_TREATS 1
+#define SCHEDULE_DEFAULT_HOURS  2
+
+schedule_state_t schedule_state;
+
+void schedule_state_init(void) {
+    static bool done = false;
+    if (done) return;
+    done = true;
+
+    lv_subject_init_int(&schedule_state.selected_treats, SCHEDULE_DEFAULT_TREATS);
+    lv_subject_init_int(&schedule_state.selected_hours, SCHEDULE_DEFAULT_HOURS);
+    lv_subject_init_int(&schedule_state.treats_dispensed, 0);
+    lv_subject_init_int(&schedule_state.remaining_minutes, 0);
+    lv_subject_init_int(&schedule_state.running, 0);
+    lv_subject_init_int(&schedule_state.paused, 0);
+}
+
+void schedule_state_set(lv_subject_t* subject, int32_t value) {
+    // lv_subject_set_int() notifies even when nothing changed
+    if (lv_subject_get_int(subject) == value) return;
+    lv_subject_set_int(subject, value);
+}
+
+// ---------------------------
+// Label bindings
+// ---------------------------
+// "h:mm" left while running, else the selected run length as "h:00"
+static void time_left_observer_cb(lv_observer_t* observer, lv_subject_t* subject) {
+    (void)subject;
+    lv_obj_t* label = lv_observer_get_target_obj(observer);
+    char time_str[16];  // "%d:%02d" for any int, no -Wformat-truncation
+    if (schedule_running()) {
+        const int remaining = schedule_remaining_minutes();
+        snprintf(time_str, sizeof(time_str), "%d:%02d", remaining / 60, remaining % 60);
+    } else {
+        snprintf(time_str, sizeof(time_str), "%d:00", schedule_selected_hours());
+    }
+    lv_label_set_text(label, time_str);
+}
+
+void schedule_state_bind_labels(lv_obj_t* treats_per_hour, lv_obj_t* treats_dispensed,
+                                lv_obj_t* time_left) {
+    if (treats_per_hour) lv_label_bind_text(treats_per_hour, &schedule_state.selected_treats, "%d");
+    if (treats_dispensed) lv_label_bind_text(treats_dispensed, &schedule_state.treats_dispensed, "%d");
+    if (time_left) {
+        lv_subject_add_observer_obj(&schedule_state.remaining_minutes, time_left_observer_cb, time_left, NULL);
+        lv_subject_add_observer_obj(&schedule_state.running, time_left_observer_cb, time_left, NULL);
+        lv_subject_add_observer_obj(&schedule_state.selected_hours, time_left_observer_cb, time_left, NULL);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Schedule state shown on the UI, held as LVGL subjects (LV_USE_OBSERVER).
+// Widgets bind to these once when their screen is built and are redrawn only when a
+// value actually changes; the setters below drop writes of the current value.
+// LVGL thread only (actions, LVGL timers, actions_poll_events()).
+typedef struct {
+    lv_subject_t selected_treats;    // treats per hour picked on schedule_1 (1..12)
+    lv_subject_t selected_hours;     // run length picked on schedule_2 (1..8)
+    lv_subject_t treats_dispensed;   // this run
+    lv_subject_t remaining_minutes;  // this run; 0 when stopped
+    lv_subject_t running;            // 0/1
+    lv_subject_t paused;             // 0/1
+} schedule_state_t;
+
+extern schedule_state_t schedule_state;
+
+// Call once after lv_init(), before any screen is built.
+void schedule_state_init(void);
+
+// Set and notify observers, unless the value is unchanged.
+void schedule_state_set(lv_subject_t* subject, int32_t value);
+
+// Bind the schedule_3 labels (any may be NULL). Observers go away with the widgets.
+void schedule_state_bind_labels(lv_obj_t* treats_per_hour, lv_obj_t* treats_dispensed,
+                                lv_obj_t* time_left);
+
+static inline int schedule_selected_treats(void) { return lv_subject_get_int(&schedule_state.selected_treats); }
+static inline int schedule_selected_hours(void) { return lv_subject_get_int(&schedule_state.selected_hours); }
+static inline int schedule_treats_dispensed(void) { return lv_subject_get_int(&schedule_state.treats_dispensed); }
+static inline int schedule_remaining_minutes(void) { return lv_subject_get_int(&schedule_state.remaining_minutes); }
+static inline bool schedule_running(void) { return lv_subject_get_int(&schedule_state.running) != 0; }
+static inline bool schedule_paused(void) { return lv_subject_get_int(&schedule_state.paused) != 0; }
+
+static inline void schedule_set_selected_treats(int v) { schedule_state_set(&schedule_state.selected_treats, v); }
+static inline void schedule_set_selected_hours(int v) { schedule_state_set(&schedule_state.selected_hours, v); }
+static inline void schedule_set_treats_dispensed(int v) { schedule_state_set(&schedule_state.treats_dispensed, v); }
+static inline void schedule_set_remaining_minutes(int v) { schedule_state_set(&schedule_state.remaining_minutes, v); }
+static inline void schedule_set_running(bool on) { schedule_state_set(&schedule_state.running, on ? 1 : 0); }
+static inline void schedule_set_paused(bool on) { schedule_state_set(&schedule_state.paused, on ? 1 : 0); }
+
+#ifdef __cplusplus
+}
+#endif
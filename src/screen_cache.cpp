@@ -0,0 +1,151 @@
+#include "screen_cache.h"
+#include <Arduino.h>
+#include "ui.h"
+#include "log.h"
+
+// -----------------------------
+// Configuration
+// -----------------------------
+// Screens kept alive at once, the active one included
+#ifndef SCREEN_CACHE_MAX_RESIDENT
+#define SCREEN_CACHE_MAX_RESIDENT 3
+#endif
+
+// Bit (id - 1) set: never evicted once built. Manual is the hub every tab returns to.
+#ifndef SCREEN_CACHE_PINNED_MASK
+#define SCREEN_CACHE_PINNED_MASK (1U << (SCREEN_ID_MANUAL - 1))
+#endif
+
+#define SCREEN_COUNT 7
+
+// Same order as ScreensEnum (and the first fields of objects_t, which the flow indexes)
+static lv_obj_t** const g_roots[SCREEN_COUNT] = {
+    &objects.main, &objects.manual, &objects.train,
+    &objects.schedule_1, &objects.schedule_2, &objects.schedule_3, &objects.settings,
+};
+static void (*const g_create[SCREEN_COUNT])() = {
+    create_screen_main, create_screen_manual, create_screen_train,
+    create_screen_schedule_1, create_screen_schedule_2, create_screen_schedule_3, create_screen_settings,
+};
+static const char* const g_names[SCREEN_COUNT] = {
+    "main", "manual", "train", "schedule_1", "schedule_2", "schedule_3", "settings",
+};
+
+static uint32_t g_last_used[SCREEN_COUNT];   // 0 = never shown
+static uint32_t g_use_clock = 0;
+static bool g_trim_pending = false;
+
+static inline bool valid_index(int i) { return i >= 0 && i < SCREEN_COUNT; }
+
+// -----------------------------
+// Create / delete
+// -----------------------------
+static void trim_async(void* arg);
+
+static void on_screen_loaded(lv_event_t* e) {
+    const int i = (int)(lv_uintptr_t)lv_event_get_user_data(e);
+    if (!valid_index(i)) return;
+    g_last_used[i] = ++g_use_clock;
+
+    // Never delete from inside the event chain that loaded us: the old screen may be
+    // the one whose button handler is still running.
+    if (!g_trim_pending) {
+        g_trim_pending = true;
+        lv_async_call(trim_async, NULL);
+    }
+}
+
+static void create_by_index(int i) {
+    if (!valid_index(i) || *g_roots[i]) return;
+    const uint32_t t0 = millis();
+    g_create[i]();
+    if (!*g_roots[i]) return;
+    lv_obj_add_event_cb(*g_roots[i], on_screen_loaded, LV_EVENT_SCREEN_LOADED, (void*)(lv_uintptr_t)i);
+    LOGI(UI, "Screen %s built in %lu ms", g_names[i], (unsigned long)(millis() - t0));
+}
+
+static void delete_by_index(int i) {
+    if (!valid_index(i)) return;
+    lv_obj_t* root = *g_roots[i];
+    if (!root) return;
+
+    // Clear every objects field that lives on this screen before the widgets go away.
+    // The page's flow state is kept: it is small, and event user_data on a rebuilt
+    // screen gets the same pointer back from getFlowState().
+    lv_obj_t** fields = (lv_obj_t**)&objects;
+    const size_t n = sizeof(objects) / sizeof(lv_obj_t*);
+    for (size_t k = 0; k < n; k++) {
+        if (fields[k] && lv_obj_get_screen(fields[k]) == root) fields[k] = NULL;
+    }
+
+    lv_obj_delete(root);
+    g_last_used[i] = 0;
+}
+
+// -----------------------------
+// Eviction
+// -----------------------------
+static bool evictable(int i) {
+    lv_obj_t* root = *g_roots[i];
+    if (!root) return false;
+    if (SCREEN_CACHE_PINNED_MASK & (1U << i)) return false;
+    lv_display_t* disp = lv_obj_get_display(root);
+    return root != lv_display_get_screen_active(disp) && root != lv_display_get_screen_prev(disp);
+}
+
+static void trim(uint8_t keep) {
+    while (screen_cache_resident_count() > keep) {
+        int victim = -1;
+        for (int i = 0; i < SCREEN_COUNT; i++) {
+            if (evictable(i) && (victim < 0 || g_last_used[i] < g_last_used[victim])) victim = i;
+        }
+        if (victim < 0) return;
+        delete_by_index(victim);
+        LOGI(UI, "Screen %s evicted (%u resident, heap %u)",
+                 g_names[victim], screen_cache_resident_count(), (unsigned)ESP.getFreeHeap());
+    }
+}
+
+static void trim_async(void* arg) {
+    (void)arg;
+    g_trim_pending = false;
+    trim(SCREEN_CACHE_MAX_RESIDENT);
+}
+
+// -----------------------------
+// API
+// -----------------------------
+void screen_cache_init(void) {
+    eez_flow_set_create_screen_func(create_by_index);
+    eez_flow_set_delete_screen_func(delete_by_index);
+}
+
+void screen_cache_load(enum ScreensEnum id) {
+    if (!valid_index(id - 1)) return;
+    // Goes through the flow so g_currentScreen (and tick_screen) follows the UI
+    eez_flow_set_screen(id, LV_SCR_LOAD_ANIM_NONE, 0, 0);
+}
+
+lv_obj_t* screen_cache_get(enum ScreensEnum id) {
+    const int i = id - 1;
+    if (!valid_index(i)) return NULL;
+    create_by_index(i);
+    return *g_roots[i];
+}
+
+bool screen_cache_is_resident(enum ScreensEnum id) {
+    const int i = id - 1;
+    return valid_index(i) && *g_roots[i] != NULL;
+}
+
+uint8_t screen_cache_resident_count(void) {
+    uint8_t n = 0;
+    for (int i = 0; i < SCREEN_COUNT; i++) {
+        if (*g_roots[i]) n++;
+    }
+    return n;
+}
+
+void screen_cache_trim_all(void) {
+    trim(0);
+}
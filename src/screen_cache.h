@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+#include "screens.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// On-demand screen construction with LRU eviction.
+//
+// Screens are built the first time they are shown (through eez_flow_set_screen /
+// the flow's create-screen hook) instead of all at boot. Once more than
+// SCREEN_CACHE_MAX_RESIDENT screens exist, the least recently shown ones that are
+// neither active, animating out, nor pinned are deleted after the next load settles.
+//
+// objects.* stays valid-or-null: deleting a screen clears every objects field that
+// points into it, so code that checks `if (objects.x)` before touching a widget is
+// safe whether or not its screen is resident.
+
+// Register the create/delete hooks with the EEZ flow. Called from create_screens().
+void screen_cache_init(void);
+
+// Show a screen, building it first if needed (no animation).
+void screen_cache_load(enum ScreensEnum id);
+
+// Build a screen without showing it. Returns its root object (NULL on bad id).
+lv_obj_t* screen_cache_get(enum ScreensEnum id);
+
+bool screen_cache_is_resident(enum ScreensEnum id);
+uint8_t screen_cache_resident_count(void);
+
+// Delete every evictable screen now, regardless of the resident limit.
+void screen_cache_trim_all(void);
+
+#ifdef __cplusplus
+}
+#endif
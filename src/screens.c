@@ -16,6 +16,7 @@ namespace flow {
 #include "vars.h"
 #include "styles.h"
 #include "ui.h"
+#include "screen_cache.h"
 #include <string.h>
 
 extern volatile bool train_dispense_stop_requested;
@@ -30,7 +31,7 @@ static void event_handler_cb_manual_manual_train_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 3, 0, e);
-        lv_scr_load(objects.train); // Force switch to Train screen        
+        screen_cache_load(SCREEN_ID_TRAIN); // Force switch to Train screen        
 
     }
 }
@@ -42,7 +43,7 @@ static void event_handler_cb_manual_manual_schedule_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 5, 0, e);
-        lv_scr_load(objects.schedule_1);
+        screen_cache_load(SCREEN_ID_SCHEDULE_1);
     }
 }
 
@@ -53,7 +54,7 @@ static void event_handler_cb_manual_manual_settings_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 7, 0, e);
-        lv_scr_load(objects.settings);
+        screen_cache_load(SCREEN_ID_SETTINGS);
     }
 }
 
@@ -76,7 +77,7 @@ static void event_handler_cb_train_train_manual_button(lv_event_t *e) {
         e->user_data = (void *)0;
         train_dispense_stop_requested = true;
         flowPropagateValueLVGLEvent(flowState, 0, 0, e);
-        lv_scr_load(objects.manual);
+        screen_cache_load(SCREEN_ID_MANUAL);
     }
 }
 
@@ -88,7 +89,7 @@ static void event_handler_cb_train_train_schedule_button(lv_event_t *e) {
         e->user_data = (void *)0;
         train_dispense_stop_requested = true;
         flowPropagateValueLVGLEvent(flowState, 5, 0, e);
-        lv_scr_load(objects.schedule_1);
+        screen_cache_load(SCREEN_ID_SCHEDULE_1);
     }
 }
 
@@ -100,7 +101,7 @@ static void event_handler_cb_train_train_settings_button(lv_event_t *e) {
         e->user_data = (void *)0;
         train_dispense_stop_requested = true;
         flowPropagateValueLVGLEvent(flowState, 7, 0, e);
-        lv_scr_load(objects.settings);
+        screen_cache_load(SCREEN_ID_SETTINGS);
     }
 }
 
@@ -135,7 +136,7 @@ static void event_handler_cb_schedule_1_schedule_1_manual_button(lv_event_t *e)
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 0, 0, e);
-        lv_scr_load(objects.manual);
+        screen_cache_load(SCREEN_ID_MANUAL);
     }
 }
 
@@ -146,7 +147,7 @@ static void event_handler_cb_schedule_1_schedule_1_train_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 3, 0, e);
-        lv_scr_load(objects.train);
+        screen_cache_load(SCREEN_ID_TRAIN);
     }
 }
 
@@ -157,7 +158,7 @@ static void event_handler_cb_schedule_1_schedule_1_settings_button(lv_event_t *e
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 7, 0, e);
-        lv_scr_load(objects.settings);
+        screen_cache_load(SCREEN_ID_SETTINGS);
     }
 }
 
@@ -168,7 +169,7 @@ static void event_handler_cb_schedule_1_schedule_1_next_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         action_schedule_add_treat_num(e);
-        lv_scr_load(objects.schedule_2);
+        screen_cache_load(SCREEN_ID_SCHEDULE_2);
     }
 }
 
@@ -179,7 +180,7 @@ static void event_handler_cb_schedule_2_schedule_2_manual_button(lv_event_t *e)
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 0, 0, e);
-        lv_scr_load(objects.manual);
+        screen_cache_load(SCREEN_ID_MANUAL);
     }
 }
 
@@ -190,7 +191,7 @@ static void event_handler_cb_schedule_2_schedule_2_train_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 3, 0, e);
-        lv_scr_load(objects.train);
+        screen_cache_load(SCREEN_ID_TRAIN);
     }
 }
 
@@ -201,7 +202,7 @@ static void event_handler_cb_schedule_2_schedule_2_settings_button(lv_event_t *e
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 7, 0, e);
-        lv_scr_load(objects.settings);
+        screen_cache_load(SCREEN_ID_SETTINGS);
     }
 }
 
@@ -212,7 +213,7 @@ static void event_handler_cb_schedule_2_schedule_2_hours_to_dispense_button(lv_e
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         action_schedule_add_hours(e);
-        lv_scr_load(objects.schedule_3);
+        screen_cache_load(SCREEN_ID_SCHEDULE_3);
     }
 }
 
@@ -223,7 +224,7 @@ static void event_handler_cb_schedule_3_schedule_3_manual_button(lv_event_t *e)
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 0, 0, e);
-        lv_scr_load(objects.manual);
+        screen_cache_load(SCREEN_ID_MANUAL);
     }
 }
 
@@ -234,7 +235,7 @@ static void event_handler_cb_schedule_3_bottom_train_tab(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 3, 0, e);
-        lv_scr_load(objects.train);
+        screen_cache_load(SCREEN_ID_TRAIN);
     }
 }
 
@@ -245,7 +246,7 @@ static void event_handler_cb_schedule_3_schedule_3_settings_button(lv_event_t *e
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 7, 0, e);
-        lv_scr_load(objects.settings);
+        screen_cache_load(SCREEN_ID_SETTINGS);
     }
 }
 
@@ -286,7 +287,7 @@ static void event_handler_cb_settings_settings_manual_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 0, 0, e);
-        lv_scr_load(objects.manual);
+        screen_cache_load(SCREEN_ID_MANUAL);
     }
 }
 
@@ -297,7 +298,7 @@ static void event_handler_cb_settings_settings_train_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 3, 0, e);
-        lv_scr_load(objects.train);
+        screen_cache_load(SCREEN_ID_TRAIN);
     }
 }
 
@@ -308,7 +309,7 @@ static void event_handler_cb_settings_settings_schedule_button(lv_event_t *e) {
     if (event == LV_EVENT_RELEASED) {
         e->user_data = (void *)0;
         flowPropagateValueLVGLEvent(flowState, 5, 0, e);
-        lv_scr_load(objects.schedule_1);
+        screen_cache_load(SCREEN_ID_SCHEDULE_1);
     }
 }
 
@@ -787,6 +788,7 @@ void create_screen_schedule_1() {
             lv_obj_set_pos(obj, 28, 91);
             lv_obj_set_size(obj, 120, 57);
             lv_roller_set_options(obj, "1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12", LV_ROLLER_MODE_INFINITE);
+            lv_roller_set_selected(obj, schedule_selected_treats() - 1, LV_ANIM_OFF); // Restore after a rebuild
             lv_obj_clear_flag(obj, LV_OBJ_FLAG_GESTURE_BUBBLE|LV_OBJ_FLAG_PRESS_LOCK|LV_OBJ_FLAG_SCROLL_CHAIN_HOR|LV_OBJ_FLAG_SCROLL_ELASTIC|LV_OBJ_FLAG_SCROLL_MOMENTUM|LV_OBJ_FLAG_SCROLL_WITH_ARROW|LV_OBJ_FLAG_SNAPPABLE);
             lv_obj_set_style_bg_color(obj, lv_color_hex(0xffffffff), LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_obj_set_style_border_color(obj, lv_color_hex(0xff000000), LV_PART_MAIN | LV_STATE_DEFAULT);
@@ -952,7 +954,7 @@ void create_screen_schedule_2() {
             lv_obj_set_pos(obj, 50, 92);
             lv_obj_set_size(obj, 95, 57);
             lv_roller_set_options(obj, "1\n2\n3\n4\n5\n6\n7\n8", LV_ROLLER_MODE_INFINITE);
-            lv_roller_set_selected(obj, 1, LV_ANIM_OFF); // Default to 2 hours (index 1)
+            lv_roller_set_selected(obj, schedule_selected_hours() - 1, LV_ANIM_OFF); // Default 2 hours; restored after a rebuild
             lv_obj_clear_flag(obj, LV_OBJ_FLAG_GESTURE_BUBBLE|LV_OBJ_FLAG_PRESS_LOCK|LV_OBJ_FLAG_SCROLL_CHAIN_HOR|LV_OBJ_FLAG_SCROLL_ELASTIC|LV_OBJ_FLAG_SCROLL_MOMENTUM|LV_OBJ_FLAG_SCROLL_WITH_ARROW|LV_OBJ_FLAG_SNAPPABLE);
             lv_obj_set_style_bg_color(obj, lv_color_hex(0xffffffff), LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_obj_set_style_border_color(obj, lv_color_hex(0xff000000), LV_PART_MAIN | LV_STATE_DEFAULT);
@@ -1198,7 +1200,7 @@ void create_screen_schedule_3() {
             lv_obj_set_pos(obj, 234, 164);
             lv_obj_set_size(obj, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
             
-            // Start with placeholder - will be updated by tick function
+            // Placeholder until schedule_state_bind_labels() fills it in
             lv_label_set_text(obj, "--:--");
             
             lv_obj_set_style_text_color(obj, lv_color_hex(0xffffffff), LV_PART_MAIN | LV_STATE_DEFAULT);
@@ -1229,7 +1231,7 @@ void create_screen_schedule_3() {
             lv_obj_set_pos(obj, 151, 163);
             lv_obj_set_size(obj, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
             
-            // Start with placeholder - will be updated by tick function
+            // Placeholder until schedule_state_bind_labels() fills it in
             lv_label_set_text(obj, "--");
             
             lv_obj_set_style_text_color(obj, lv_color_hex(0xffffffff), LV_PART_MAIN | LV_STATE_DEFAULT);
@@ -1238,59 +1240,14 @@ void create_screen_schedule_3() {
         
     }
     
-    tick_screen_schedule_3();
-    
-    // Force immediate update of dynamic values
+    // Labels follow schedule_state from here on; binding fills them in now
+    schedule_state_bind_labels(objects.treats_per_hour, objects.treats_dispensed, objects.schedule_time_left);
+
     tick_screen_schedule_3();
 }
 
 void tick_screen_schedule_3() {
     void *flowState = getFlowState(0, 5);
-    
-    // Update display values from global variables
-    extern int selected_treats_number;
-    extern int selected_hours_to_dispense;
-    extern int schedule_treats_dispensed;
-    extern int schedule_remaining_minutes;
-    extern bool schedule_is_running;
-    
-    // Always update treats per hour display with current selection
-    if (objects.treats_per_hour) {
-        char treats_str[10];
-        snprintf(treats_str, sizeof(treats_str), "%d", selected_treats_number);
-        const char* current_text = lv_label_get_text(objects.treats_per_hour);
-        if (strcmp(current_text, treats_str) != 0) {
-            lv_label_set_text(objects.treats_per_hour, treats_str);
-        }
-    }
-    
-    // Update treats dispensed counter
-    if (objects.treats_dispensed) {
-        char dispensed_str[10];
-        snprintf(dispensed_str, sizeof(dispensed_str), "%d", schedule_treats_dispensed);
-        const char* current_text = lv_label_get_text(objects.treats_dispensed);
-        if (strcmp(current_text, dispensed_str) != 0) {
-            lv_label_set_text(objects.treats_dispensed, dispensed_str);
-        }
-    }
-    
-    // Always update countdown timer with current selection
-    if (objects.schedule_time_left) {
-        char time_str[10];
-        if (schedule_is_running) {
-            // Show actual countdown when running
-            int hours = schedule_remaining_minutes / 60;
-            int minutes = schedule_remaining_minutes % 60;
-            snprintf(time_str, sizeof(time_str), "%d:%02d", hours, minutes);
-        } else {
-            // Show initial time when not running (use current user selection)
-            snprintf(time_str, sizeof(time_str), "%d:00", selected_hours_to_dispense);
-        }
-        const char* current_text = lv_label_get_text(objects.schedule_time_left);
-        if (strcmp(current_text, time_str) != 0) {
-            lv_label_set_text(objects.schedule_time_left, time_str);
-        }
-    }
 }
 
 void create_screen_settings() {
@@ -1485,11 +1442,6 @@ void create_screens() {
     lv_theme_t *theme = lv_theme_default_init(dispp, lv_palette_main(LV_PALETTE_BLUE), lv_palette_main(LV_PALETTE_RED), false, LV_FONT_DEFAULT);
     lv_disp_set_theme(dispp, theme);
     
-    create_screen_main();
-    create_screen_manual();
-    create_screen_train();
-    create_screen_schedule_1();
-    create_screen_schedule_2();
-    create_screen_schedule_3();
-    create_screen_settings();
+    // Screens are built on first use and evicted LRU (screen_cache.cpp)
+    screen_cache_init();
 }
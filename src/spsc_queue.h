@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Lock-free single-producer / single-consumer ring.
+// Exactly one task may push and exactly one task may pop. N must be a power of two;
+// one slot is never used so full/empty can be told apart without a shared count.
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // Producer side. Returns false (item dropped) when full.
+    bool push(const T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) & (N - 1);
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        buf_[head] = item;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        out = buf_[tail];
+        tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+private:
+    T buf_[N];
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+};
@@ -0,0 +1,391 @@
+#include "touch_input.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <TFT_eSPI.h>
+#include "main.h"
+#include "log.h"
+
+// -----------------------------
+// Configuration
+// -----------------------------
+// Bit-banged: VSPI is the SD card's bus, so the touch controller gets its own pins
+// instead of re-routing VSPI (which steals MISO from the card).
+#ifndef XPT2046_IRQ
+#define XPT2046_IRQ 36
+#endif
+#ifndef XPT2046_MOSI
+#define XPT2046_MOSI 32
+#endif
+#ifndef XPT2046_MISO
+#define XPT2046_MISO 39
+#endif
+#ifndef XPT2046_CLK
+#define XPT2046_CLK 25
+#endif
+#ifndef XPT2046_CS
+#define XPT2046_CS 33
+#endif
+
+// Raw X/Y pairs per read; odd, <= 15
+#ifndef TOUCH_FILTER_SAMPLES
+#define TOUCH_FILTER_SAMPLES 7
+#endif
+
+// Minimum pressure (Z1 + 4095 - Z2) for a valid contact
+#ifndef TOUCH_Z_THRESHOLD
+#define TOUCH_Z_THRESHOLD 300
+#endif
+
+// Pixels from the edge for calibration targets
+#ifndef TOUCH_CAL_MARGIN
+#define TOUCH_CAL_MARGIN 20
+#endif
+
+// Previous fixed raw range, used until a calibration is stored
+#ifndef TOUCH_DEFAULT_RAW_MIN_X
+#define TOUCH_DEFAULT_RAW_MIN_X 200
+#endif
+#ifndef TOUCH_DEFAULT_RAW_MAX_X
+#define TOUCH_DEFAULT_RAW_MAX_X 3700
+#endif
+#ifndef TOUCH_DEFAULT_RAW_MIN_Y
+#define TOUCH_DEFAULT_RAW_MIN_Y 240
+#endif
+#ifndef TOUCH_DEFAULT_RAW_MAX_Y
+#define TOUCH_DEFAULT_RAW_MAX_Y 3800
+#endif
+
+static_assert((TOUCH_FILTER_SAMPLES & 1) && TOUCH_FILTER_SAMPLES >= 3 && TOUCH_FILTER_SAMPLES <= 15,
+              "TOUCH_FILTER_SAMPLES must be odd, 3..15");
+
+// XPT2046 control bytes (12-bit, differential). Low bits 01 keep the ADC powered
+// (PENIRQ off) between conversions; 00 powers down and re-enables PENIRQ.
+static const uint8_t CMD_Z1 = 0xB1;
+static const uint8_t CMD_Z2 = 0xC1;
+static const uint8_t CMD_X  = 0x91;   // axis names as in XPT2046_Touchscreen, so the
+static const uint8_t CMD_Y  = 0xD1;   // default calibration matches the old raw range
+static const uint8_t CMD_PD = 0xD0;
+
+static const uint32_t CAL_MAGIC = 0x54434131UL;  // "TCA1"
+
+// screen = (a*rx + b*ry + c, d*rx + e*ry + f)
+struct TouchCal {
+    uint32_t magic;
+    float a, b, c;
+    float d, e, f;
+};
+
+static TouchCal g_cal;
+static bool g_cal_stored = false;
+static uint16_t g_width = 320;
+static uint16_t g_height = 240;
+static volatile bool g_pen_irq = false;
+
+// ---------------------------
+// IRQ
+// ---------------------------
+static void IRAM_ATTR touch_irq_isr() {
+    g_pen_irq = true;
+    ui_loop_wake_from_isr();
+}
+
+// ---------------------------
+// Bit-banged XPT2046 (SPI mode 0, ~500 kHz)
+// ---------------------------
+static uint16_t xpt_xfer(uint8_t cmd_next) {
+    // Clocks out the next command while shifting in the previous conversion
+    uint16_t in = 0;
+    for (int i = 15; i >= 0; i--) {
+        const bool bit = (i >= 8) ? ((cmd_next >> (i - 8)) & 1) : false;
+        digitalWrite(XPT2046_MOSI, bit ? HIGH : LOW);
+        delayMicroseconds(1);
+        digitalWrite(XPT2046_CLK, HIGH);
+        in = (uint16_t)((in << 1) | (digitalRead(XPT2046_MISO) ? 1 : 0));
+        delayMicroseconds(1);
+        digitalWrite(XPT2046_CLK, LOW);
+    }
+    return (uint16_t)((in >> 3) & 0x0FFF);
+}
+
+static void xpt_cmd(uint8_t cmd) {
+    for (int i = 7; i >= 0; i--) {
+        digitalWrite(XPT2046_MOSI, ((cmd >> i) & 1) ? HIGH : LOW);
+        delayMicroseconds(1);
+        digitalWrite(XPT2046_CLK, HIGH);
+        delayMicroseconds(1);
+        digitalWrite(XPT2046_CLK, LOW);
+    }
+}
+
+static void sort_u16(uint16_t* v, int n) {
+    for (int i = 1; i < n; i++) {
+        const uint16_t x = v[i];
+        int j = i;
+        while (j > 0 && v[j - 1] > x) { v[j] = v[j - 1]; j--; }
+        v[j] = x;
+    }
+}
+
+// Mean of the middle three of n sorted values
+static uint16_t trimmed_mean(uint16_t* v, int n) {
+    sort_u16(v, n);
+    const int m = n / 2;
+    if (n < 3) return v[m];
+    return (uint16_t)(((uint32_t)v[m - 1] + v[m] + v[m + 1]) / 3);
+}
+
+// One filtered raw reading. Returns false if the pen is up (too little pressure).
+static bool read_raw_filtered(uint16_t* rx, uint16_t* ry) {
+    uint16_t xs[TOUCH_FILTER_SAMPLES];
+    uint16_t ys[TOUCH_FILTER_SAMPLES];
+
+    digitalWrite(XPT2046_CS, LOW);
+
+    xpt_cmd(CMD_Z1);
+    const int32_t z1 = xpt_xfer(CMD_Z2);
+    const int32_t z2 = xpt_xfer(CMD_X);
+    const int32_t z = z1 + 4095 - z2;
+
+    bool down = (z >= TOUCH_Z_THRESHOLD);
+    if (down) {
+        xpt_xfer(CMD_X);   // first X after the pressure read settles; discard
+        for (int i = 0; i < TOUCH_FILTER_SAMPLES; i++) {
+            xs[i] = xpt_xfer(CMD_Y);
+            ys[i] = xpt_xfer((i + 1 < TOUCH_FILTER_SAMPLES) ? CMD_X : CMD_Z1);
+        }
+        // Pressure again: a lift during the burst would skew the tail samples
+        const int32_t z1b = xpt_xfer(CMD_Z2);
+        const int32_t z2b = xpt_xfer(CMD_PD);
+        down = (z1b + 4095 - z2b) >= TOUCH_Z_THRESHOLD;
+    } else {
+        xpt_xfer(CMD_PD);
+    }
+    xpt_xfer(0);   // clock out the last conversion; controller powered down, PENIRQ on
+
+    digitalWrite(XPT2046_CS, HIGH);
+
+    if (!down) return false;
+    *rx = trimmed_mean(xs, TOUCH_FILTER_SAMPLES);
+    *ry = trimmed_mean(ys, TOUCH_FILTER_SAMPLES);
+    return true;
+}
+
+// ---------------------------
+// Calibration
+// ---------------------------
+static void set_default_calibration() {
+    g_cal.magic = CAL_MAGIC;
+    g_cal.a = (float)(g_width - 1) / (float)(TOUCH_DEFAULT_RAW_MAX_X - TOUCH_DEFAULT_RAW_MIN_X);
+    g_cal.b = 0.0f;
+    g_cal.c = -(float)TOUCH_DEFAULT_RAW_MIN_X * g_cal.a;
+    g_cal.d = 0.0f;
+    g_cal.e = (float)(g_height - 1) / (float)(TOUCH_DEFAULT_RAW_MAX_Y - TOUCH_DEFAULT_RAW_MIN_Y);
+    g_cal.f = -(float)TOUCH_DEFAULT_RAW_MIN_Y * g_cal.e;
+}
+
+static bool load_calibration() {
+    Preferences prefs;
+    if (!prefs.begin("touch", true)) return false;
+    TouchCal cal;
+    const size_t n = prefs.getBytes("cal", &cal, sizeof(cal));
+    prefs.end();
+    if (n != sizeof(cal) || cal.magic != CAL_MAGIC) return false;
+    g_cal = cal;
+    return true;
+}
+
+static bool save_calibration() {
+    Preferences prefs;
+    if (!prefs.begin("touch", false)) return false;
+    const size_t n = prefs.putBytes("cal", &g_cal, sizeof(g_cal));
+    prefs.end();
+    return n == sizeof(g_cal);
+}
+
+// Solve screen = M * [rx ry 1] exactly through three reference points.
+static bool solve_affine(const int32_t sx[3], const int32_t sy[3],
+                         const int32_t rx[3], const int32_t ry[3], TouchCal* out) {
+    const float det = (float)rx[0] * (ry[1] - ry[2]) +
+                      (float)rx[1] * (ry[2] - ry[0]) +
+                      (float)rx[2] * (ry[0] - ry[1]);
+    // Near-collinear raw points (e.g. the same spot pressed twice)
+    if (fabsf(det) < 1000.0f) return false;
+
+    const float c0 = (float)rx[1] * ry[2] - (float)rx[2] * ry[1];
+    const float c1 = (float)rx[2] * ry[0] - (float)rx[0] * ry[2];
+    const float c2 = (float)rx[0] * ry[1] - (float)rx[1] * ry[0];
+
+    out->magic = CAL_MAGIC;
+    out->a = (sx[0] * (float)(ry[1] - ry[2]) + sx[1] * (float)(ry[2] - ry[0]) + sx[2] * (float)(ry[0] - ry[1])) / det;
+    out->b = (sx[0] * (float)(rx[2] - rx[1]) + sx[1] * (float)(rx[0] - rx[2]) + sx[2] * (float)(rx[1] - rx[0])) / det;
+    out->c = (sx[0] * c0 + sx[1] * c1 + sx[2] * c2) / det;
+    out->d = (sy[0] * (float)(ry[1] - ry[2]) + sy[1] * (float)(ry[2] - ry[0]) + sy[2] * (float)(ry[0] - ry[1])) / det;
+    out->e = (sy[0] * (float)(rx[2] - rx[1]) + sy[1] * (float)(rx[0] - rx[2]) + sy[2] * (float)(rx[1] - rx[0])) / det;
+    out->f = (sy[0] * c0 + sy[1] * c1 + sy[2] * c2) / det;
+    return true;
+}
+
+static void apply_calibration(uint16_t rx, uint16_t ry, touch_point_t* out) {
+    int32_t x = (int32_t)lroundf(g_cal.a * rx + g_cal.b * ry + g_cal.c);
+    int32_t y = (int32_t)lroundf(g_cal.d * rx + g_cal.e * ry + g_cal.f);
+    out->x = (int16_t)constrain(x, 0, (int32_t)g_width - 1);
+    out->y = (int16_t)constrain(y, 0, (int32_t)g_height - 1);
+}
+
+// ---------------------------
+// API
+// ---------------------------
+bool touch_input_begin(uint16_t width, uint16_t height) {
+    g_width = width;
+    g_height = height;
+
+    pinMode(XPT2046_CS, OUTPUT);
+    digitalWrite(XPT2046_CS, HIGH);
+    pinMode(XPT2046_CLK, OUTPUT);
+    digitalWrite(XPT2046_CLK, LOW);
+    pinMode(XPT2046_MOSI, OUTPUT);
+    pinMode(XPT2046_MISO, INPUT);
+    pinMode(XPT2046_IRQ, INPUT);   // GPIO36: input-only, board has the pull-up
+
+    // Power down with PENIRQ enabled so the first touch raises the IRQ
+    digitalWrite(XPT2046_CS, LOW);
+    xpt_cmd(CMD_PD);
+    xpt_xfer(0);
+    digitalWrite(XPT2046_CS, HIGH);
+
+    g_cal_stored = load_calibration();
+    if (!g_cal_stored) set_default_calibration();
+
+    attachInterrupt(digitalPinToInterrupt(XPT2046_IRQ), touch_irq_isr, FALLING);
+    g_pen_irq = (digitalRead(XPT2046_IRQ) == LOW);
+
+    LOGI(TOUCH, "Touch: IRQ on GPIO%d, %d-sample filter, %s calibration",
+                (int)XPT2046_IRQ, (int)TOUCH_FILTER_SAMPLES,
+                g_cal_stored ? "stored" : "default");
+    return true;
+}
+
+bool touch_input_pending(void) {
+    return g_pen_irq;
+}
+
+bool touch_input_read(touch_point_t* out) {
+    if (!g_pen_irq) return false;
+
+    uint16_t rx, ry;
+    if (!read_raw_filtered(&rx, &ry)) {
+        // Lifted. A new press re-arms through the IRQ.
+        g_pen_irq = false;
+        return false;
+    }
+    if (out) apply_calibration(rx, ry, out);
+    return true;
+}
+
+bool touch_input_held(uint32_t hold_ms) {
+    const uint32_t start = millis();
+    uint16_t rx, ry;
+    while (millis() - start < hold_ms) {
+        if (!read_raw_filtered(&rx, &ry)) return false;
+        delay(20);
+    }
+    return true;
+}
+
+static void draw_target(TFT_eSPI& tft, int16_t x, int16_t y, uint16_t color) {
+    tft.drawFastHLine(x - 10, y, 21, color);
+    tft.drawFastVLine(x, y - 10, 21, color);
+    tft.drawCircle(x, y, 6, color);
+}
+
+// Average raw position of one press; waits for press and release.
+static bool capture_point(uint16_t* rx, uint16_t* ry) {
+    const uint32_t timeout_ms = 30000UL;
+    const uint32_t start = millis();
+    uint16_t x, y;
+
+    // Wait for release of any previous press, then a press
+    while (read_raw_filtered(&x, &y)) {
+        if (millis() - start > timeout_ms) return false;
+        delay(10);
+    }
+    while (!read_raw_filtered(&x, &y)) {
+        if (millis() - start > timeout_ms) return false;
+        delay(10);
+    }
+
+    // Average while held (skip the first contact bounce)
+    delay(50);
+    uint32_t sx = 0, sy = 0, n = 0;
+    while (n < 16 && read_raw_filtered(&x, &y)) {
+        sx += x;
+        sy += y;
+        n++;
+        delay(10);
+    }
+    if (n < 4) return false;
+
+    *rx = (uint16_t)(sx / n);
+    *ry = (uint16_t)(sy / n);
+    return true;
+}
+
+bool touch_input_calibrate(TFT_eSPI& tft) {
+    const int32_t sx[3] = { TOUCH_CAL_MARGIN, (int32_t)g_width - 1 - TOUCH_CAL_MARGIN, (int32_t)g_width / 2 };
+    const int32_t sy[3] = { TOUCH_CAL_MARGIN, (int32_t)g_height / 2, (int32_t)g_height - 1 - TOUCH_CAL_MARGIN };
+    int32_t rx[3], ry[3];
+
+    LOGI(TOUCH, "Touch calibration: tap each target.");
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    tft.setTextDatum(MC_DATUM);
+    tft.drawString("Touch calibration: tap each cross", g_width / 2, g_height / 2 - 30);
+
+    for (int i = 0; i < 3; i++) {
+        draw_target(tft, sx[i], sy[i], TFT_RED);
+        uint16_t x, y;
+        if (!capture_point(&x, &y)) {
+            LOGW(TOUCH, "Touch calibration: timed out; keeping previous calibration.");
+            tft.fillScreen(TFT_BLACK);
+            return false;
+        }
+        rx[i] = x;
+        ry[i] = y;
+        draw_target(tft, sx[i], sy[i], TFT_GREEN);
+        LOGI(TOUCH, "  target %d (%ld,%ld) <- raw (%u,%u)",
+                    i, (long)sx[i], (long)sy[i], (unsigned)x, (unsigned)y);
+    }
+
+    // Wait for the last release so it is not seen as a UI tap
+    uint16_t x, y;
+    while (read_raw_filtered(&x, &y)) delay(10);
+    tft.fillScreen(TFT_BLACK);
+
+    TouchCal cal;
+    if (!solve_affine(sx, sy, rx, ry, &cal)) {
+        LOGW(TOUCH, "Touch calibration: points degenerate; keeping previous calibration.");
+        return false;
+    }
+
+    g_cal = cal;
+    g_cal_stored = save_calibration();
+    g_pen_irq = false;
+    LOGI(TOUCH, "Touch calibration: x=%.4f*rx%+.4f*ry%+.1f y=%.4f*rx%+.4f*ry%+.1f (%s)",
+                g_cal.a, g_cal.b, g_cal.c, g_cal.d, g_cal.e, g_cal.f,
+                g_cal_stored ? "saved" : "NOT saved");
+    return true;
+}
+
+bool touch_input_has_calibration(void) {
+    return g_cal_stored;
+}
+
+void touch_input_clear_calibration(void) {
+    Preferences prefs;
+    if (prefs.begin("touch", false)) {
+        prefs.remove("cal");
+        prefs.end();
+    }
+    g_cal_stored = false;
+    set_default_calibration();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+class TFT_eSPI;
+
+// XPT2046 resistive touch, IRQ-gated.
+// PENIRQ (falling edge) arms sampling and wakes the UI loop; the controller is only
+// clocked while the pen is down. Each read takes TOUCH_FILTER_SAMPLES raw X/Y pairs,
+// drops pressure-invalid ones and returns the trimmed mean around the median, mapped
+// to screen pixels by a 3-point affine calibration persisted in NVS.
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+} touch_point_t;
+
+// Pins, IRQ and stored calibration (defaults if none).
+bool touch_input_begin(uint16_t width, uint16_t height);
+
+// True once PENIRQ fired and until a read sees the pen lifted.
+bool touch_input_pending(void);
+
+// Filtered, calibrated point. Returns false (no bus traffic) while the pen is up.
+bool touch_input_read(touch_point_t* out);
+
+// True if the pen stays down for hold_ms (used as a boot-time calibration request).
+bool touch_input_held(uint32_t hold_ms);
+
+// Interactive 3-point calibration drawn straight to the panel; saves to NVS on success.
+// Must run before the display is handed to LVGL/DMA.
+bool touch_input_calibrate(TFT_eSPI& tft);
+
+bool touch_input_has_calibration(void);   // stored (vs default) calibration in use
+void touch_input_clear_calibration(void);
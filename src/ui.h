@@ -14,14 +14,14 @@ extern "C" {
 
 // Add the structure definition here
 typedef struct _objects_t {
-    // Screen objects
+    // Screen objects (ScreensEnum order: the flow looks screens up by index)
     lv_obj_t* main;
     lv_obj_t* manual;
     lv_obj_t* train;
-    lv_obj_t* settings;
     lv_obj_t* schedule_1;
     lv_obj_t* schedule_2;
     lv_obj_t* schedule_3;
+    lv_obj_t* settings;
     lv_obj_t* splashed;
 
     // Manual screen objects
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "schedule_state.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,18 +22,8 @@ enum FlowGlobalVariables {
 #define DISPENSER_PIN 26  // GPIO connected to the treat dispenser
 #define SD_CS 5
 
-#ifndef SCHEDULE_SELECTION_VARS_H
-#define SCHEDULE_SELECTION_VARS_H
-extern int selected_treats_number;
-extern int selected_hours_to_dispense;
-
-// Schedule state variables
-extern int schedule_treats_dispensed;
-extern int schedule_remaining_minutes;
-extern bool schedule_is_running;
-extern bool schedule_is_paused;
+// Schedule selections and run state: see schedule_state.h
 extern void* schedule_timer; // Store the schedule timer reference
-#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,597 @@
+"""Used-glyph font subsetting.
+
+Scans the UI sources for the Montserrat sizes they reference and the text each size
+actually renders, then writes subset copies of LVGL's built-in fonts to src/generated/
+with only those glyphs. The subsets keep the built-in symbol names
+(lv_font_montserrat_N), so the EEZ-generated UI code is unchanged; lv_conf.h turns the
+built-in fonts off and declares the subsets through LV_FONT_CUSTOM_DECLARE.
+
+Text is attributed per widget in screens.c: an object's font is its own
+lv_obj_set_style_text_font() or the nearest ancestor's, else LV_FONT_DEFAULT.
+Label/roller literals count directly; labels filled at run time
+(lv_label_set_text(objects.X, buf)) count the characters their snprintf() formats can
+produce. Text areas and keyboards get full printable ASCII. Anything unresolvable
+also falls back to full ASCII for that font, with a warning.
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:tools/font_subset.py).
+Options (platformio.ini):
+  custom_font_sources  files to scan (default: src/screens.c src/actions.cpp)
+  custom_font_extra    extra characters to add to every subset
+
+If lv_conf.h is out of step with the fonts in use the build stops; fix it with
+    python tools/font_subset.py --update-conf
+which rewrites the font switches in include/lv_conf.h and src/lv_conf.h.
+"""
+
+import hashlib
+import os
+import re
+import sys
+
+OUT_DIR = os.path.join("src", "generated")
+LV_CONF_FILES = [os.path.join("include", "lv_conf.h"), os.path.join("src", "lv_conf.h")]
+DEFAULT_SOURCES = "src/screens.c src/actions.cpp"
+ALL_SIZES = list(range(8, 50, 2))
+
+PRINTABLE_ASCII = "".join(chr(c) for c in range(0x20, 0x7F))
+DIGITS = "0123456789"
+
+FONT_REF_RE = re.compile(r"lv_font_montserrat_(\d+)\b")
+C_STRING_RE = r'"(?:[^"\\\n]|\\.)*"'
+TEXT_SETTERS = ("lv_label_set_text", "lv_label_set_text_static", "lv_roller_set_options",
+                "lv_dropdown_set_options", "lv_textarea_set_text",
+                "lv_textarea_set_placeholder_text", "lv_checkbox_set_text")
+FULL_ASCII_WIDGETS = ("lv_textarea_create", "lv_keyboard_create", "lv_spinbox_create")
+
+
+# ---------------------------
+# C source helpers
+# ---------------------------
+def strip_comments(text):
+    # Keep string literals intact; blank out comments (preserving offsets)
+    out = []
+    i, n = 0, len(text)
+    while i < n:
+        c = text[i]
+        if c == '"' or c == "'":
+            j = i + 1
+            while j < n and text[j] != c:
+                j += 2 if text[j] == "\\" else 1
+            out.append(text[i:j + 1])
+            i = j + 1
+        elif text.startswith("//", i):
+            j = text.find("\n", i)
+            j = n if j < 0 else j
+            out.append(" " * (j - i))
+            i = j
+        elif text.startswith("/*", i):
+            j = text.find("*/", i + 2)
+            j = n if j < 0 else j + 2
+            out.append(re.sub(r"[^\n]", " ", text[i:j]))
+            i = j
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out)
+
+
+def decode_c_string(lit):
+    """C string literal (with quotes) -> text. \\xNN runs are UTF-8 bytes."""
+    body = lit[1:-1]
+    out = bytearray()
+    i = 0
+    while i < len(body):
+        c = body[i]
+        if c != "\\":
+            out += c.encode("utf-8")
+            i += 1
+            continue
+        e = body[i + 1]
+        if e == "x":
+            m = re.match(r"[0-9a-fA-F]{1,2}", body[i + 2:])
+            out.append(int(m.group(0), 16))
+            i += 2 + len(m.group(0))
+        elif e in "01234567":
+            m = re.match(r"[0-7]{1,3}", body[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        else:
+            out += {"n": b"\n", "t": b"\t", "r": b"\r", "0": b"\0"}.get(e, e.encode("utf-8"))
+            i += 2
+    return out.decode("utf-8", errors="ignore")
+
+
+def string_expr_text(expr, symbols):
+    """Text of a string expression: adjacent literals and LV_SYMBOL_* macros, else None."""
+    parts = re.findall(r'%s|LV_SYMBOL_\w+|\S+' % C_STRING_RE, expr.strip())
+    text = ""
+    for p in parts:
+        if p.startswith('"'):
+            text += decode_c_string(p)
+        elif p in symbols:
+            text += symbols[p]
+        else:
+            return None
+    return text
+
+
+def format_chars(fmt):
+    """Characters snprintf(fmt, ...) can produce; None if unbounded (%s)."""
+    chars = set()
+    i = 0
+    while i < len(fmt):
+        c = fmt[i]
+        if c != "%":
+            chars.add(c)
+            i += 1
+            continue
+        m = re.match(r"%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?([diuxXfFeEgGcs%])", fmt[i:])
+        if not m:
+            return None
+        conv = m.group(1)
+        if conv == "%":
+            chars.add("%")
+        elif conv in "diu":
+            chars.update(DIGITS + "-")
+        elif conv in "xX":
+            chars.update(DIGITS + ("abcdef" if conv == "x" else "ABCDEF"))
+        elif conv in "fFeEgG":
+            chars.update(DIGITS + "-.eE+")
+        else:
+            return None
+        i += len(m.group(0))
+    return chars
+
+
+def call_args(text, pos):
+    """Split the argument list of the call whose '(' is at pos."""
+    depth, args, cur = 0, [], []
+    i = pos
+    while i < len(text):
+        c = text[i]
+        if c == '"':
+            m = re.match(C_STRING_RE, text[i:])
+            cur.append(m.group(0))
+            i += len(m.group(0))
+            continue
+        if c == "(":
+            depth += 1
+            if depth == 1:
+                i += 1
+                continue
+        elif c == ")":
+            depth -= 1
+            if depth == 0:
+                args.append("".join(cur).strip())
+                return args
+        elif c == "," and depth == 1:
+            args.append("".join(cur).strip())
+            cur = []
+            i += 1
+            continue
+        cur.append(c)
+        i += 1
+    return args
+
+
+def find_calls(text, names):
+    for m in re.finditer(r"\b(%s)\s*\(" % "|".join(names), text):
+        yield m.group(1), m.start(), call_args(text, m.end() - 1)
+
+
+# ---------------------------
+# Analysis
+# ---------------------------
+class ObjBlock(object):
+    def __init__(self, start, end, parent):
+        self.start, self.end, self.parent = start, end, parent
+        self.font = None          # LV_PART_MAIN font, inherited by children
+        self.part_fonts = set()   # other parts/states (roller selection, pressed, ...)
+        self.names = []
+        self.texts = []
+        self.full_ascii = False
+
+
+def brace_blocks(text):
+    blocks, stack = [], []
+    for i, c in enumerate(text):
+        if c == "{":
+            stack.append(i)
+        elif c == "}" and stack:
+            s = stack.pop()
+            blocks.append((s, i, len(stack)))
+    return blocks
+
+
+def top_level(text, start, end, inner):
+    """Text of [start, end) with nested blocks blanked out."""
+    chunk = list(text[start:end])
+    for s, e in inner:
+        for k in range(s - start, e - start + 1):
+            chunk[k] = " "
+    return "".join(chunk)
+
+
+def analyze(project_dir, sources, default_size, symbols, warn):
+    """Returns {size: set(chars)}."""
+    texts = {}
+    ascii_sizes = set()
+
+    def add(size, chars):
+        texts.setdefault(size, set()).update(chars)
+
+    name_font = {}
+    var_formats = {}
+    dynamic = []   # (object name, value expression, is_format)
+
+    for rel in sources:
+        with open(os.path.join(project_dir, rel), "r", encoding="utf-8", errors="replace") as f:
+            text = strip_comments(f.read())
+
+        for m in FONT_REF_RE.finditer(text):
+            texts.setdefault(int(m.group(1)), set())
+
+        for _, _, args in find_calls(text, ["snprintf", "sprintf"]):
+            fmt_i = 2 if len(args) >= 3 and args[2].startswith('"') else 1
+            if len(args) > fmt_i and args[fmt_i].startswith('"'):
+                var_formats.setdefault(args[0], []).append(decode_c_string(args[fmt_i]))
+
+        # Object blocks: braces whose own level declares `lv_obj_t *obj = ...`
+        spans = sorted(brace_blocks(text))
+        objs = []
+        for s, e, _ in spans:
+            inner = [(a, b) for a, b, _ in spans if s < a and b < e]
+            # only direct children matter for blanking; nested ones are inside them
+            own = top_level(text, s + 1, e, inner)
+            if not re.search(r"lv_obj_t\s*\*\s*obj\s*=", own):
+                continue
+            parent = None
+            for o in reversed(objs):
+                if o.start < s and e < o.end:
+                    parent = o
+                    break
+            ob = ObjBlock(s, e, parent)
+            for size, selector in re.findall(
+                    r"lv_obj_set_style_text_font\(\s*obj\s*,\s*&lv_font_montserrat_(\d+)\s*,([^;]*)\)\s*;", own):
+                if ob.font is None and re.fullmatch(r"\s*(LV_PART_MAIN\s*\|\s*)?LV_STATE_DEFAULT\s*|\s*0\s*", selector):
+                    ob.font = int(size)
+                else:
+                    ob.part_fonts.add(int(size))
+            ob.names = re.findall(r"objects\.(\w+)\s*=\s*obj\s*;", own)
+            ob.full_ascii = any(w in own for w in FULL_ASCII_WIDGETS)
+            for _, _, args in find_calls(own, TEXT_SETTERS):
+                if len(args) >= 2 and args[0] == "obj":
+                    t = string_expr_text(args[1], symbols)
+                    if t is None:
+                        ob.full_ascii = True
+                        warn("%s: text '%s' not resolvable; full ASCII" % (rel, args[1]))
+                    else:
+                        ob.texts.append(t)
+            objs.append(ob)
+
+        for ob in objs:
+            size, p = ob.font, ob.parent
+            while size is None and p is not None:
+                size, p = p.font, p.parent
+            size = default_size if size is None else size
+            for s in set([size]) | ob.part_fonts:
+                for t in ob.texts:
+                    add(s, t)
+                if ob.full_ascii:
+                    ascii_sizes.add(s)
+            for n in ob.names:
+                name_font[n] = size
+
+        for fn, _, args in find_calls(text, TEXT_SETTERS + ("lv_label_set_text_fmt",)):
+            if len(args) >= 2 and args[0].startswith("objects."):
+                dynamic.append((args[0][len("objects."):], args[1], fn == "lv_label_set_text_fmt"))
+
+    for name, expr, is_fmt in dynamic:
+        size = name_font.get(name, default_size)
+        lit = string_expr_text(expr, symbols)
+        if lit is not None:
+            chars = format_chars(lit) if is_fmt else set(lit)
+            if chars is None:
+                ascii_sizes.add(size)
+            else:
+                add(size, chars)
+        elif expr in var_formats:
+            for fmt in var_formats[expr]:
+                chars = format_chars(fmt)
+                if chars is None:
+                    warn("objects.%s: format '%s' is unbounded; full ASCII" % (name, fmt))
+                    ascii_sizes.add(size)
+                else:
+                    add(size, chars)
+        else:
+            warn("objects.%s = %s: unknown text; full ASCII for size %d" % (name, expr, size))
+            ascii_sizes.add(size)
+
+    texts.setdefault(default_size, set())
+    for size in ascii_sizes:
+        add(size, PRINTABLE_ASCII)
+    for size in texts:
+        texts[size] = set(c for c in texts[size] if ord(c) >= 0x20)
+    return texts
+
+
+# ---------------------------
+# LVGL font parsing / emitting
+# ---------------------------
+def c_array(text, name):
+    m = re.search(r"\b%s\[\]\s*=\s*\{(.*?)\};" % re.escape(name), text, re.S)
+    if not m:
+        return None
+    body = strip_comments(m.group(1))
+    return [int(v, 0) for v in re.findall(r"-?(?:0x[0-9a-fA-F]+|\d+)", body)]
+
+
+def prop(text, name, default=None):
+    m = re.search(r"\.%s\s*=\s*([-\w]+)" % name, text)
+    return m.group(1) if m else default
+
+
+def load_font(path):
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        raw = f.read()
+    text = strip_comments(raw)
+
+    bitmap = c_array(text, "glyph_bitmap")
+    glyphs = [tuple(int(v) for v in g) for g in re.findall(
+        r"\{\s*\.bitmap_index\s*=\s*(\d+)\s*,\s*\.adv_w\s*=\s*(\d+)\s*,\s*\.box_w\s*=\s*(\d+)\s*,"
+        r"\s*\.box_h\s*=\s*(\d+)\s*,\s*\.ofs_x\s*=\s*(-?\d+)\s*,\s*\.ofs_y\s*=\s*(-?\d+)\s*\}", text)]
+    if bitmap is None or not glyphs:
+        raise ValueError("%s: not an lv_font_conv font" % path)
+
+    # codepoint -> glyph id, from the cmaps
+    cmap_m = re.search(r"cmaps\[\]\s*=\s*\{(.*)\};", text[:text.find("font_dsc")], re.S)
+    cp_to_gid = {}
+    for entry in re.findall(r"\{([^{}]*\.type\s*=[^{}]*)\}", cmap_m.group(1)):
+        rs = int(prop(entry, "range_start"), 0)
+        rl = int(prop(entry, "range_length"), 0)
+        gs = int(prop(entry, "glyph_id_start"), 0)
+        ul = prop(entry, "unicode_list")
+        ol = prop(entry, "glyph_id_ofs_list")
+        typ = prop(entry, "type")
+        ulist = c_array(text, ul) if ul and ul != "NULL" else None
+        olist = c_array(text, ol) if ol and ol != "NULL" else None
+        if typ.endswith("FORMAT0_TINY"):
+            for i in range(rl):
+                cp_to_gid[rs + i] = gs + i
+        elif typ.endswith("FORMAT0_FULL"):
+            for i in range(rl):
+                if olist[i]:
+                    cp_to_gid[rs + i] = gs + olist[i]
+        elif typ.endswith("SPARSE_TINY"):
+            for i, ofs in enumerate(ulist):
+                cp_to_gid[rs + ofs] = gs + i
+        elif typ.endswith("SPARSE_FULL"):
+            for i, ofs in enumerate(ulist):
+                cp_to_gid[rs + ofs] = gs + olist[i]
+        else:
+            raise ValueError("%s: unknown cmap type %s" % (path, typ))
+
+    kern = None
+    if prop(text, "kern_classes") == "1":
+        kern = dict(left=c_array(text, "kern_left_class_mapping"),
+                    right=c_array(text, "kern_right_class_mapping"),
+                    values=c_array(text, "kern_class_values"),
+                    lcnt=int(prop(text, "left_class_cnt")),
+                    rcnt=int(prop(text, "right_class_cnt")))
+
+    lv = text[text.rfind("lv_font_t"):]
+    return dict(bitmap=bitmap, glyphs=glyphs, cp_to_gid=cp_to_gid, kern=kern,
+                kern_scale=int(prop(text, "kern_scale", "16")),
+                bpp=int(prop(text, "bpp")),
+                bitmap_format=int(prop(text, "bitmap_format", "0")),
+                line_height=int(prop(lv, "line_height")),
+                base_line=int(prop(lv, "base_line")),
+                subpx=prop(lv, "subpx", "LV_FONT_SUBPX_NONE"),
+                underline_position=int(prop(lv, "underline_position", "0")),
+                underline_thickness=int(prop(lv, "underline_thickness", "0")))
+
+
+def fmt_list(values, per_line=16, hexa=False):
+    f = (lambda v: "0x%x" % v) if hexa else str
+    return ",\n".join("    " + ", ".join(f(v) for v in values[i:i + per_line])
+                      for i in range(0, len(values), per_line))
+
+
+def subset_font(font, chars, symbol, source_name):
+    cps = sorted(set(ord(c) for c in chars) & set(font["cp_to_gid"]))
+    missing = sorted(set(ord(c) for c in chars) - set(font["cp_to_gid"]))
+    old_ids = [font["cp_to_gid"][cp] for cp in cps]
+    glyphs, bitmap = font["glyphs"], font["bitmap"]
+
+    new_bitmap, new_glyphs = [], [(0, 0, 0, 0, 0, 0)]
+    for gid in old_ids:
+        start = glyphs[gid][0]
+        end = glyphs[gid + 1][0] if gid + 1 < len(glyphs) else len(bitmap)
+        # Empty glyphs (space) share their start with the next one
+        g = glyphs[gid]
+        new_glyphs.append((len(new_bitmap),) + g[1:])
+        new_bitmap.extend(bitmap[start:end])
+
+    out = []
+    out.append("// Generated by tools/font_subset.py from lvgl/src/font/%s. Do not edit." % source_name)
+    out.append("// %d of %d glyphs: %s" % (len(cps), len(glyphs) - 1,
+               "".join(chr(c) if c < 0x7F else "\\u%04X" % c for c in cps).replace("*/", "* /")))
+    out.append('#include "lvgl.h"\n')
+    out.append("static LV_ATTRIBUTE_LARGE_CONST const uint8_t glyph_bitmap[] = {")
+    out.append(fmt_list(new_bitmap or [0], 16, hexa=True))
+    out.append("};\n")
+    out.append("static const lv_font_fmt_txt_glyph_dsc_t glyph_dsc[] = {")
+    out.append(",\n".join("    {.bitmap_index = %d, .adv_w = %d, .box_w = %d, .box_h = %d, .ofs_x = %d, .ofs_y = %d}"
+                          % g for g in new_glyphs))
+    out.append("};\n")
+
+    if cps:
+        out.append("static const uint16_t unicode_list[] = {")
+        out.append(fmt_list([cp - cps[0] for cp in cps], 12, hexa=True))
+        out.append("};\n")
+        out.append("static const lv_font_fmt_txt_cmap_t cmaps[] = {")
+        out.append("    {\n        .range_start = %d, .range_length = %d, .glyph_id_start = 1,\n"
+                   "        .unicode_list = unicode_list, .glyph_id_ofs_list = NULL, .list_length = %d,\n"
+                   "        .type = LV_FONT_FMT_TXT_CMAP_SPARSE_TINY\n    }"
+                   % (cps[0], cps[-1] - cps[0] + 1, len(cps)))
+        out.append("};\n")
+
+    kern = font["kern"]
+    has_kern = False
+    if kern and cps:
+        lmap = [kern["left"][g] for g in old_ids]
+        rmap = [kern["right"][g] for g in old_ids]
+        lused = sorted(set(c for c in lmap if c))
+        rused = sorted(set(c for c in rmap if c))
+        if lused and rused:
+            has_kern = True
+            lidx = dict((c, i + 1) for i, c in enumerate(lused))
+            ridx = dict((c, i + 1) for i, c in enumerate(rused))
+            values = [kern["values"][(lc - 1) * kern["rcnt"] + (rc - 1)] for lc in lused for rc in rused]
+            out.append("static const uint8_t kern_left_class_mapping[] = {")
+            out.append(fmt_list([0] + [lidx.get(c, 0) for c in lmap]))
+            out.append("};\n")
+            out.append("static const uint8_t kern_right_class_mapping[] = {")
+            out.append(fmt_list([0] + [ridx.get(c, 0) for c in rmap]))
+            out.append("};\n")
+            out.append("static const int8_t kern_class_values[] = {")
+            out.append(fmt_list(values))
+            out.append("};\n")
+            out.append("static const lv_font_fmt_txt_kern_classes_t kern_classes = {\n"
+                       "    .class_pair_values = kern_class_values,\n"
+                       "    .left_class_mapping = kern_left_class_mapping,\n"
+                       "    .right_class_mapping = kern_right_class_mapping,\n"
+                       "    .left_class_cnt = %d,\n    .right_class_cnt = %d,\n};\n"
+                       % (len(lused), len(rused)))
+
+    out.append("static const lv_font_fmt_txt_dsc_t font_dsc = {")
+    out.append("    .glyph_bitmap = glyph_bitmap,")
+    out.append("    .glyph_dsc = glyph_dsc,")
+    out.append("    .cmaps = %s," % ("cmaps" if cps else "NULL"))
+    out.append("    .kern_dsc = %s," % ("&kern_classes" if has_kern else "NULL"))
+    out.append("    .kern_scale = %d," % font["kern_scale"])
+    out.append("    .cmap_num = %d," % (1 if cps else 0))
+    out.append("    .bpp = %d," % font["bpp"])
+    out.append("    .kern_classes = %d," % (1 if has_kern else 0))
+    out.append("    .bitmap_format = %d," % font["bitmap_format"])
+    out.append("};\n")
+    out.append("const lv_font_t %s = {" % symbol)
+    out.append("    .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,")
+    out.append("    .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,")
+    out.append("    .line_height = %d," % font["line_height"])
+    out.append("    .base_line = %d," % font["base_line"])
+    out.append("    .subpx = %s," % font["subpx"])
+    out.append("    .underline_position = %d," % font["underline_position"])
+    out.append("    .underline_thickness = %d," % font["underline_thickness"])
+    out.append("    .dsc = &font_dsc,")
+    out.append("    .fallback = NULL,")
+    out.append("    .user_data = NULL,")
+    out.append("};")
+    return "\n".join(out) + "\n", len(cps), len(glyphs) - 1, len(new_bitmap), len(bitmap), missing
+
+
+# ---------------------------
+# lv_conf.h
+# ---------------------------
+def conf_state(path):
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+    enabled = set(int(n) for n in re.findall(r"^#define LV_FONT_MONTSERRAT_(\d+)\s+1\b", text, re.M))
+    m = re.search(r"^#define LV_FONT_CUSTOM_DECLARE\b(.*)$", text, re.M)
+    declared = set(int(n) for n in FONT_REF_RE.findall(m.group(1))) if m else set()
+    d = re.search(r"^#define LV_FONT_DEFAULT\s+&lv_font_montserrat_(\d+)", text, re.M)
+    return text, enabled, declared, (int(d.group(1)) if d else 14)
+
+
+def update_conf(path, sizes):
+    text, _, _, _ = conf_state(path)
+    text = re.sub(r"^(#define LV_FONT_MONTSERRAT_\d+)(\s+)1\b", r"\g<1>\g<2>0", text, flags=re.M)
+    decl = " ".join("LV_FONT_DECLARE(lv_font_montserrat_%d)" % s for s in sorted(sizes))
+    text = re.sub(r"^#define LV_FONT_CUSTOM_DECLARE\b.*$",
+                  lambda _: "#define LV_FONT_CUSTOM_DECLARE " + decl, text, flags=re.M)
+    with open(path, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+
+
+def load_symbols(font_dir):
+    path = os.path.join(os.path.dirname(font_dir), "font", "lv_symbol_def.h")
+    symbols = {}
+    if os.path.exists(path):
+        with open(path, "r", encoding="utf-8", errors="replace") as f:
+            for name, lit in re.findall(r'#define\s+(LV_SYMBOL_\w+)\s+("(?:\\x[0-9A-Fa-f]{2})+")', f.read()):
+                symbols[name] = decode_c_string(lit)
+    return symbols
+
+
+# ---------------------------
+# Driver
+# ---------------------------
+def run(project_dir, font_dir, sources, extra, update=False):
+    conf_path = os.path.join(project_dir, LV_CONF_FILES[0])
+    _, enabled, declared, default_size = conf_state(conf_path)
+    symbols = load_symbols(font_dir)
+    warn = lambda msg: print("font_subset: warning: " + msg)
+
+    texts = analyze(project_dir, sources, default_size, symbols, warn)
+    sizes = set(texts)
+
+    if update:
+        for rel in LV_CONF_FILES:
+            update_conf(os.path.join(project_dir, rel), sizes)
+        print("font_subset: lv_conf.h now declares sizes %s" % sorted(sizes))
+        return
+
+    stale = (sizes & enabled) or (sizes - declared)
+    if stale:
+        raise SystemExit("font_subset: lv_conf.h does not match the UI (sizes %s, built-in on %s, "
+                         "declared %s). Run: python tools/font_subset.py --update-conf"
+                         % (sorted(sizes), sorted(enabled), sorted(declared)))
+    if enabled - sizes:
+        warn("unused built-in fonts still enabled in lv_conf.h: %s" % sorted(enabled - sizes))
+
+    out_dir = os.path.join(project_dir, OUT_DIR)
+    os.makedirs(out_dir, exist_ok=True)
+    for size in sorted(sizes):
+        chars = texts[size] | set(extra)
+        src = os.path.join(font_dir, "lv_font_montserrat_%d.c" % size)
+        out_path = os.path.join(out_dir, "lv_font_montserrat_%d.c" % size)
+
+        h = hashlib.sha1("".join(sorted(chars)).encode("utf-8"))
+        with open(src, "rb") as f:
+            h.update(f.read())
+        with open(os.path.abspath(__file__), "rb") as f:
+            h.update(f.read())
+        stamp = out_path + ".stamp"
+        if os.path.exists(out_path) and os.path.exists(stamp):
+            with open(stamp) as f:
+                if f.read().strip() == h.hexdigest():
+                    continue
+
+        c_text, n, total, nbytes, total_bytes, missing = subset_font(
+            load_font(src), chars, "lv_font_montserrat_%d" % size, os.path.basename(src))
+        with open(out_path, "w", encoding="utf-8", newline="\n") as f:
+            f.write(c_text)
+        with open(stamp, "w") as f:
+            f.write(h.hexdigest() + "\n")
+        print("font_subset: montserrat_%d: %d/%d glyphs, %d/%d bitmap bytes" % (size, n, total, nbytes, total_bytes))
+        if missing:
+            warn("montserrat_%d lacks %s" % (size, " ".join("U+%04X" % c for c in missing)))
+
+
+try:
+    Import("env")  # noqa: F821  (PlatformIO/SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    _project = env.subst("$PROJECT_DIR")
+    _font_dir = os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"), "lvgl", "src", "font")
+    run(_project, _font_dir,
+        env.GetProjectOption("custom_font_sources", DEFAULT_SOURCES).split(),
+        env.GetProjectOption("custom_font_extra", ""))
+elif __name__ == "__main__":
+    _project = os.getcwd()
+    _update = "--update-conf" in sys.argv
+    _args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    _font_dir = _args[0] if _args else os.path.join(_project, ".pio", "libdeps", "esp32dev", "lvgl", "src", "font")
+    run(_project, _font_dir, DEFAULT_SOURCES.split(), "", update=_update)
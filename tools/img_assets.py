@@ -0,0 +1,289 @@
+"""Image asset pipeline.
+
+Converts UI images to the panel's native RGB565 at their on-screen size, optionally
+RLE-compressed for the streaming decoder in src/img_rle.cpp, and writes them as C
+sources under src/generated/.
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:tools/img_assets.py) and
+reads the asset list from the `custom_img_assets` option, one asset per line:
+
+    <source> <symbol> <WxH[+X+Y]> <raw|rle>
+
+  source  LVGL C-array export (as written by EEZ Studio) or a PNG (needs Pillow)
+  symbol  lv_image_dsc_t name to define (same name the UI code already references)
+  WxH+X+Y crop window in source pixels; W/H alone crops from the top-left
+  raw     LV_COLOR_FORMAT_RGB565, drawn by LVGL straight from flash
+  rle     per-row RLE, decoded band by band while drawing
+
+Outputs are rebuilt only when the source, options or this script change.
+Standalone: python tools/img_assets.py [project_dir]
+"""
+
+import hashlib
+import os
+import re
+import struct
+import sys
+
+OUT_DIR = os.path.join("src", "generated")
+
+RLE_MAGIC = 0x36454C52  # "RLE6" little-endian; must match IMG_RLE_MAGIC
+RLE_MAX_RUN = 128
+RLE_MIN_RUN = 3
+
+
+# ---------------------------
+# Sources
+# ---------------------------
+def load_lvgl_c_array(path):
+    """Returns (w, h, rows of (r, g, b, a)) from an LVGL 9 C-array image."""
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        text = f.read()
+
+    def field(name):
+        m = re.search(r"\.header\.%s\s*=\s*([A-Za-z0-9_]+)" % name, text)
+        if not m:
+            raise ValueError("%s: missing .header.%s" % (path, name))
+        return m.group(1)
+
+    w = int(field("w"))
+    h = int(field("h"))
+    cf = field("cf")
+    stride_m = re.search(r"\.header\.stride\s*=\s*(\d+)", text)
+
+    start = text.index("{", text.index("_map[]"))
+    end = text.index("};", start)
+    data = bytes(int(x, 16) for x in re.findall(r"0x([0-9a-fA-F]{2})", text[start:end]))
+
+    bpp = {"LV_COLOR_FORMAT_ARGB8888": 4, "LV_COLOR_FORMAT_XRGB8888": 4,
+           "LV_COLOR_FORMAT_RGB888": 3, "LV_COLOR_FORMAT_RGB565": 2}.get(cf)
+    if bpp is None:
+        raise ValueError("%s: unsupported color format %s" % (path, cf))
+    stride = int(stride_m.group(1)) if stride_m else w * bpp
+    if len(data) < stride * h:
+        raise ValueError("%s: %d bytes, expected %d" % (path, len(data), stride * h))
+
+    rows = []
+    for y in range(h):
+        row = []
+        base = y * stride
+        for x in range(w):
+            p = base + x * bpp
+            if bpp == 4:      # B, G, R, A in memory
+                b, g, r, a = data[p], data[p + 1], data[p + 2], data[p + 3]
+                if cf == "LV_COLOR_FORMAT_XRGB8888":
+                    a = 255
+            elif bpp == 3:
+                b, g, r, a = data[p], data[p + 1], data[p + 2], 255
+            else:
+                v = data[p] | (data[p + 1] << 8)
+                r, g, b, a = ((v >> 11) & 0x1F) << 3, ((v >> 5) & 0x3F) << 2, (v & 0x1F) << 3, 255
+            row.append((r, g, b, a))
+        rows.append(row)
+    return w, h, rows
+
+
+def load_png(path):
+    try:
+        from PIL import Image
+    except ImportError:
+        raise ValueError("%s: PNG input needs Pillow (pip install pillow)" % path)
+    img = Image.open(path).convert("RGBA")
+    w, h = img.size
+    px = list(img.getdata())
+    return w, h, [px[y * w:(y + 1) * w] for y in range(h)]
+
+
+def load_source(path):
+    if path.lower().endswith(".c"):
+        return load_lvgl_c_array(path)
+    return load_png(path)
+
+
+# ---------------------------
+# Conversion
+# ---------------------------
+def parse_geometry(spec, src_w, src_h):
+    m = re.match(r"^(\d+)x(\d+)(?:\+(\d+)\+(\d+))?$", spec)
+    if not m:
+        raise ValueError("bad geometry '%s' (want WxH or WxH+X+Y)" % spec)
+    w, h = int(m.group(1)), int(m.group(2))
+    x0 = int(m.group(3) or 0)
+    y0 = int(m.group(4) or 0)
+    if x0 + w > src_w or y0 + h > src_h:
+        raise ValueError("crop %s exceeds source %dx%d" % (spec, src_w, src_h))
+    return w, h, x0, y0
+
+
+def to_rgb565(rows, w, h, x0, y0, bg=(255, 255, 255)):
+    """Crop, flatten alpha over bg, quantize to RGB565 (list of rows of uint16)."""
+    out = []
+    for y in range(y0, y0 + h):
+        line = []
+        for x in range(x0, x0 + w):
+            r, g, b, a = rows[y][x]
+            if a != 255:
+                r = (r * a + bg[0] * (255 - a) + 127) // 255
+                g = (g * a + bg[1] * (255 - a) + 127) // 255
+                b = (b * a + bg[2] * (255 - a) + 127) // 255
+            line.append(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+        out.append(line)
+    return out
+
+
+def rle_encode_row(row):
+    """Packets: ctl & 0x80 -> run of (ctl & 0x7F) + 1 copies of one pixel,
+    else (ctl + 1) literal pixels. Packets never cross rows."""
+    out = bytearray()
+    i, n = 0, len(row)
+    lit = []
+
+    def flush_literals():
+        while lit:
+            chunk = lit[:RLE_MAX_RUN]
+            del lit[:RLE_MAX_RUN]
+            out.append(len(chunk) - 1)
+            for v in chunk:
+                out.extend(struct.pack("<H", v))
+
+    while i < n:
+        run = 1
+        while i + run < n and run < RLE_MAX_RUN and row[i + run] == row[i]:
+            run += 1
+        if run >= RLE_MIN_RUN:
+            flush_literals()
+            out.append(0x80 | (run - 1))
+            out += struct.pack("<H", row[i])
+            i += run
+        else:
+            lit.append(row[i])
+            i += 1
+    flush_literals()
+    return bytes(out)
+
+
+def rle_container(pixels, w, h):
+    # Header (16 bytes) + per-row offsets (from container start) + packets
+    header_size = 16 + 4 * h
+    rows = [rle_encode_row(r) for r in pixels]
+    offsets, pos = [], header_size
+    for r in rows:
+        offsets.append(pos)
+        pos += len(r)
+    blob = struct.pack("<IHHII", RLE_MAGIC, w, h, 0, 0)
+    blob += b"".join(struct.pack("<I", o) for o in offsets)
+    blob += b"".join(rows)
+    return blob
+
+
+# ---------------------------
+# Output
+# ---------------------------
+def c_bytes(blob, per_line=24):
+    lines = []
+    for i in range(0, len(blob), per_line):
+        lines.append("    " + ",".join("0x%02x" % b for b in blob[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def write_c(out_path, symbol, source, mode, w, h, blob):
+    guard = "LV_ATTRIBUTE_IMG_" + symbol.upper()
+    if mode == "raw":
+        cf, stride = "LV_COLOR_FORMAT_RGB565", w * 2
+    else:
+        cf, stride = "LV_COLOR_FORMAT_RAW", 0
+    text = """// Generated by tools/img_assets.py from %(source)s (%(mode)s, %(w)dx%(h)d). Do not edit.
+#include "lvgl.h"
+
+#ifndef LV_ATTRIBUTE_MEM_ALIGN
+#define LV_ATTRIBUTE_MEM_ALIGN
+#endif
+
+#ifndef %(guard)s
+#define %(guard)s
+#endif
+
+static const
+LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST %(guard)s
+uint8_t %(symbol)s_map[] = {
+%(data)s
+};
+
+const lv_image_dsc_t %(symbol)s = {
+  .header.magic = LV_IMAGE_HEADER_MAGIC,
+  .header.cf = %(cf)s,
+  .header.flags = 0,
+  .header.w = %(w)d,
+  .header.h = %(h)d,
+  .header.stride = %(stride)d,
+  .data_size = sizeof(%(symbol)s_map),
+  .data = %(symbol)s_map,
+};
+""" % dict(source=source.replace("\\", "/"), mode=mode, w=w, h=h, guard=guard,
+           symbol=symbol, data=c_bytes(blob), cf=cf, stride=stride)
+    with open(out_path, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+
+
+def build_asset(project_dir, line):
+    parts = line.split()
+    if len(parts) != 4:
+        raise ValueError("asset line '%s': want <source> <symbol> <WxH[+X+Y]> <raw|rle>" % line)
+    source, symbol, geometry, mode = parts
+    if mode not in ("raw", "rle"):
+        raise ValueError("asset %s: mode must be raw or rle" % symbol)
+
+    src_path = os.path.join(project_dir, source)
+    out_path = os.path.join(project_dir, OUT_DIR, "%s.c" % symbol)
+    stamp_path = out_path + ".stamp"
+
+    h = hashlib.sha1()
+    h.update(line.encode())
+    with open(src_path, "rb") as f:
+        h.update(f.read())
+    with open(os.path.abspath(__file__), "rb") as f:
+        h.update(f.read())
+    digest = h.hexdigest()
+
+    if os.path.exists(out_path) and os.path.exists(stamp_path):
+        with open(stamp_path) as f:
+            if f.read().strip() == digest:
+                return
+
+    src_w, src_h, rows = load_source(src_path)
+    w, hh, x0, y0 = parse_geometry(geometry, src_w, src_h)
+    pixels = to_rgb565(rows, w, hh, x0, y0)
+
+    if mode == "raw":
+        blob = b"".join(struct.pack("<%dH" % w, *r) for r in pixels)
+    else:
+        blob = rle_container(pixels, w, hh)
+
+    os.makedirs(os.path.dirname(out_path), exist_ok=True)
+    write_c(out_path, symbol, source, mode, w, hh, blob)
+    with open(stamp_path, "w") as f:
+        f.write(digest + "\n")
+
+    src_bytes = os.path.getsize(src_path)
+    print("img_assets: %s -> %s (%s %dx%d, %d bytes; source array %dx%d)" %
+          (source, os.path.relpath(out_path, project_dir), mode, w, hh, len(blob), src_w, src_h))
+
+
+def run(project_dir, spec):
+    for raw in spec.splitlines():
+        line = raw.split(";")[0].strip()
+        if line:
+            build_asset(project_dir, line)
+
+
+DEFAULT_ASSETS = "src/ui_image_splashy.c img_splashy 340x240 rle"
+
+try:
+    Import("env")  # noqa: F821  (PlatformIO/SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    run(env.subst("$PROJECT_DIR"), env.GetProjectOption("custom_img_assets", DEFAULT_ASSETS))
+elif __name__ == "__main__":
+    run(sys.argv[1] if len(sys.argv) > 1 else os.getcwd(), DEFAULT_ASSETS)
@@ -0,0 +1,201 @@
+"""Binary log decoder.
+
+Reads a raw serial capture from firmware built with -D LOG_SERIAL_BINARY=1 (src/log.cpp)
+and prints one line per record. Records carry the address of their format string, not
+the text, so the firmware ELF the capture came from is needed to look the strings up.
+
+Each frame is A5 5A, a u16 payload length, the payload and a CRC-16/CCITT-FALSE of the
+payload (all little-endian). Frames failing their CRC are counted and skipped. Text
+between frames (boot messages printed before logging starts) is passed through.
+
+Usage: python tools/log_decode.py firmware.elf capture.bin [> log.txt]
+"""
+
+import re
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+MAX_PAYLOAD = 4096
+
+# LOG_LEVEL_* and LOG_MODULES in src/log.h
+LEVELS = ["NONE", "ERROR", "WARN", "INFO", "DEBUG"]
+MODULES = ["SYS", "MOTOR", "JAM", "PCF", "SCHED", "TRAIN", "AUDIO", "UI", "RUNLOG", "TOUCH", "ADC", "TRACE"]
+
+# LOG_ARG_* tag -> struct format of the value (STR is length-prefixed)
+ARG_I32, ARG_U32, ARG_I64, ARG_U64, ARG_F64, ARG_STR, ARG_PTR = range(1, 8)
+ARG_FORMATS = {
+    ARG_I32: "<i", ARG_U32: "<I", ARG_I64: "<q", ARG_U64: "<Q",
+    ARG_F64: "<d", ARG_PTR: "<I",
+}
+
+# Payload: fmt address, t_us, level<<4 | module, argument count
+RECORD = struct.Struct("<IIBB")
+
+SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d*))?(?:hh|h|ll|l|L|q|j|z|t)?([diouxXeEfFgGaAcsp%])")
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as on the device."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+class Elf:
+    """Loaded sections of a 32-bit little-endian ELF, for reading strings by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError(f"{path}: not a 32-bit little-endian ELF")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _name, sh_type, flags, addr, offset, size = struct.unpack_from(
+                "<IIIIII", self.data, shoff + i * shentsize)
+            # SHT_PROGBITS and SHF_ALLOC: bytes that are in the image at addr
+            if sh_type == 1 and flags & 0x2 and addr:
+                self.sections.append((addr, size, offset))
+        self.cache = {}
+
+    def string(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        s = None
+        for base, size, offset in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.find(b"\0", start, offset + size)
+                s = self.data[start:end if end >= 0 else offset + size].decode("utf-8", "replace")
+                break
+        self.cache[addr] = s
+        return s
+
+
+def parse_args(payload, pos, count):
+    args = []
+    for _ in range(count):
+        tag = payload[pos]
+        pos += 1
+        if tag == ARG_STR:
+            n = payload[pos]
+            args.append((tag, payload[pos + 1:pos + 1 + n].decode("utf-8", "replace")))
+            pos += 1 + n
+        elif tag in ARG_FORMATS:
+            fmt = ARG_FORMATS[tag]
+            args.append((tag, struct.unpack_from(fmt, payload, pos)[0]))
+            pos += struct.calcsize(fmt)
+        else:
+            raise ValueError(f"bad argument tag {tag}")
+    return args
+
+
+def render(fmt, args):
+    """printf-style formatting with the stored argument types, like log_task does."""
+    it = iter(args)
+
+    def one(m):
+        flags, width, prec, conv = m.groups()
+        if conv == "%":
+            return "%"
+        try:
+            tag, v = next(it)
+        except StopIteration:
+            return "?"
+        if conv == "p":
+            return f"0x{v:x}"
+        if conv == "s":
+            return ("%" + flags + width + ("." + prec if prec is not None else "") + "s") % v
+        if conv == "a" or conv == "A":
+            return float(v).hex()
+        if conv in "eEfFgG":
+            v = float(v)
+        elif tag == ARG_F64:
+            return "?"
+        elif conv in "di" and tag in (ARG_U32, ARG_U64):
+            v = v - (1 << 32) if tag == ARG_U32 and v >= 1 << 31 else v
+        elif conv not in "di" and v < 0:
+            v &= (1 << 64) - 1 if tag == ARG_I64 else (1 << 32) - 1
+        py = "d" if conv in "iu" else conv
+        return ("%" + flags + width + ("." + prec if prec is not None else "") + py) % v
+
+    return SPEC.sub(one, fmt)
+
+
+def passthrough(raw):
+    """Prints the text lines in raw; anything else is a damaged frame."""
+    for line in raw.replace(b"\r", b"").split(b"\n"):
+        if line.strip() and all(0x20 <= b < 0x7F or b == 0x09 for b in line):
+            print(line.decode("ascii"))
+
+
+def decode(elf, data, stats):
+    i = 0
+    text_from = 0
+    last_t = None
+    wraps = 0
+    while True:
+        j = data.find(SYNC, i)
+        if j < 0 or j + 4 > len(data):
+            break
+        n, = struct.unpack_from("<H", data, j + 2)
+        end = j + 4 + n + 2
+        if n < RECORD.size or n > MAX_PAYLOAD or end > len(data):
+            i = j + 1
+            continue
+        payload = data[j + 4:j + 4 + n]
+        crc, = struct.unpack_from("<H", data, j + 4 + n)
+        if crc != crc16(payload):
+            stats["bad_frames"] += 1
+            i = j + 1
+            continue
+
+        passthrough(data[text_from:j])
+        i = text_from = end
+
+        fmt_addr, t_us, tag, count = RECORD.unpack_from(payload, 0)
+        if last_t is not None and t_us < last_t:
+            wraps += 1   # t_us is the low 32 bits of esp_timer: wraps every ~71.6 min
+        last_t = t_us
+        t = (wraps * (1 << 32) + t_us) / 1e6
+        level = LEVELS[tag >> 4] if tag >> 4 < len(LEVELS) else str(tag >> 4)
+        module = MODULES[tag & 0x0F] if tag & 0x0F < len(MODULES) else str(tag & 0x0F)
+
+        fmt = elf.string(fmt_addr)
+        try:
+            args = parse_args(payload, RECORD.size, count)
+        except (ValueError, IndexError, struct.error):
+            stats["bad_frames"] += 1
+            continue
+        if fmt is None:
+            stats["unknown_formats"] += 1
+            msg = f"<fmt 0x{fmt_addr:08x}> " + " ".join(str(v) for _, v in args)
+        else:
+            msg = render(fmt, args)
+        print(f"[{t:12.6f}] {level:<5} {module:<6} {msg}")
+        stats["records"] += 1
+    passthrough(data[text_from:])
+
+
+def main(argv):
+    if len(argv) != 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+    elf = Elf(argv[0])
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    stats = {"records": 0, "bad_frames": 0, "unknown_formats": 0}
+    decode(elf, data, stats)
+    print(f"{stats['records']} records, {stats['bad_frames']} bad frames, "
+          f"{stats['unknown_formats']} unknown formats", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,113 @@
+"""Run log decoder.
+
+Reads the binary motor-run log written by src/run_log.cpp (/runlog/NNNNN.bin on the SD
+card or the LittleFS partition) and prints one CSV row per run, oldest first.
+
+Each file is a sequence of 32-byte slots: a header in slot 0, then run records. Slots
+of 0xFF are page padding; slots failing their CRC are counted and skipped.
+
+Usage: python tools/run_log_decode.py <file or directory>... [> runs.csv]
+"""
+
+import csv
+import os
+import struct
+import sys
+
+SLOT_BYTES = 32
+RECORD_MAGIC = 0xA5
+HEADER_MAGIC = b"NPRL"
+VERSION = 1
+
+# Must match run_log_header_t / run_log_record_t (packed, little-endian)
+HEADER = struct.Struct("<4sBBHIIH12sH")
+RECORD = struct.Struct("<BBBBIIIHHHHHHHH")
+
+FLAG_TREAT = 0x01
+FLAG_SAW_MOTION = 0x02
+
+# MotorStopReason in src/actions.cpp
+REASONS = ["timeout", "treat_next_high", "no_treat_3_transitions", "jam", "external_request"]
+
+COLUMNS = [
+    "file", "boot", "seq", "uptime_ms", "reason", "retries", "treat", "saw_motion",
+    "transitions", "run_ms", "reverse_ms", "no_motion_ms",
+    "peak_a", "filtered_a", "rms_a", "max_slope_a", "zero_v",
+]
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as on the device."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def decode_file(path, writer, stats):
+    with open(path, "rb") as f:
+        data = f.read()
+    name = os.path.basename(path)
+
+    if len(data) < SLOT_BYTES:
+        stats["bad_files"] += 1
+        return
+    magic, version, slot_bytes, boot, _first_seq, _uptime, zero_mv, _res, crc = HEADER.unpack_from(data, 0)
+    if magic != HEADER_MAGIC or crc != crc16(data[:SLOT_BYTES - 2]):
+        print(f"{name}: bad header, skipped", file=sys.stderr)
+        stats["bad_files"] += 1
+        return
+    if version != VERSION or slot_bytes != SLOT_BYTES:
+        print(f"{name}: version {version} / slot {slot_bytes} not supported, skipped", file=sys.stderr)
+        stats["bad_files"] += 1
+        return
+
+    for off in range(SLOT_BYTES, len(data) - SLOT_BYTES + 1, SLOT_BYTES):
+        slot = data[off:off + SLOT_BYTES]
+        if slot[0] == 0xFF:
+            continue
+        (rmagic, reason, retries, flags, seq, uptime_ms, run_ms, reverse_ms, no_motion_ms,
+         transitions, peak, filtered, rms, slope, rcrc) = RECORD.unpack(slot)
+        if rmagic != RECORD_MAGIC or rcrc != crc16(slot[:SLOT_BYTES - 2]):
+            stats["bad_records"] += 1
+            continue
+        writer.writerow([
+            name, boot, seq, uptime_ms,
+            REASONS[reason] if reason < len(REASONS) else reason,
+            retries, int(bool(flags & FLAG_TREAT)), int(bool(flags & FLAG_SAW_MOTION)),
+            transitions, run_ms, reverse_ms, no_motion_ms,
+            f"{peak / 1000:.3f}", f"{filtered / 1000:.3f}", f"{rms / 1000:.3f}",
+            f"{slope / 1000:.3f}", f"{zero_mv / 1000:.3f}",
+        ])
+        stats["records"] += 1
+
+
+def collect(paths):
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            files += [os.path.join(p, n) for n in os.listdir(p) if n.endswith(".bin")]
+        else:
+            files.append(p)
+    # NNNNN.bin: numeric order is write order
+    return sorted(files, key=lambda f: (os.path.basename(f).split(".")[0].zfill(10), f))
+
+
+def main(argv):
+    if not argv:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+    stats = {"records": 0, "bad_records": 0, "bad_files": 0}
+    writer = csv.writer(sys.stdout, lineterminator="\n")
+    writer.writerow(COLUMNS)
+    for path in collect(argv):
+        decode_file(path, writer, stats)
+    print(f"{stats['records']} runs, {stats['bad_records']} bad records, "
+          f"{stats['bad_files']} bad files", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
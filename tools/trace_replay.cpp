@@ -0,0 +1,197 @@
+// Host replay of motor traces (src/motor_trace.h) through the firmware's jam detector.
+//
+// Every trace is fed sample by sample and tick by tick through the same JamDetector
+// (src/jam_detect.h) motor_task runs, with the thresholds this tool was built with.
+// Control flow follows the recording: unjam reverses happen where the device did
+// them, so a detection the device did not make is reported as the first one in its
+// forward segment, not acted on.
+//
+// Thresholds are compile-time, exactly as on the device:
+//   g++ -O2 -std=c++11 -I src tools/trace_replay.cpp -o trace_replay
+//   g++ -O2 -std=c++11 -I src -D JAM_FILTERED_THRESHOLD_AMPS=0.95f tools/trace_replay.cpp -o replay_095
+// Run:
+//   ./trace_replay traces/*.trc > replay.csv
+// One CSV row per trace on stdout; agreement with the recorded runs on stderr.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "motor_trace.h"
+#include "jam_detect.h"
+
+static const char* const REASONS[] = {
+    "timeout", "treat_next_high", "no_treat_3_transitions", "jam", "external_request",
+};
+
+static const char* reason_name(uint8_t r) {
+    return r < sizeof(REASONS) / sizeof(REASONS[0]) ? REASONS[r] : "?";
+}
+
+static const char* verdict_name(int v) {
+    switch (v) {
+    case JAM_NO_MOTION:        return "no_motion";
+    case JAM_FILTERED_CURRENT: return "filtered";
+    default:                   return "";
+    }
+}
+
+struct Jam {
+    int count = 0;
+    int first = JAM_NONE;
+    uint32_t first_ms = 0;   // since job start
+
+    void add(int verdict, uint32_t ms) {
+        if (count++ == 0) {
+            first = verdict;
+            first_ms = ms;
+        }
+    }
+};
+
+struct Totals {
+    int runs = 0, bad = 0;
+    int both = 0, neither = 0, replay_only = 0, recorded_only = 0;
+};
+
+static bool replay_file(const char* path, Totals* totals) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    motor_trace_header_t hdr;
+    std::vector<uint8_t> buf;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+              memcmp(hdr.magic, "NPTR", 4) == 0 &&
+              hdr.version == MOTOR_TRACE_VERSION && hdr.entry_bytes == 8;
+    if (ok) {
+        buf.resize((size_t)hdr.entry_count * 8);
+        ok = buf.empty() || fread(buf.data(), buf.size(), 1, f) == 1;
+    }
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "%s: not a version %d trace\n", path, MOTOR_TRACE_VERSION);
+        return false;
+    }
+
+    const uint32_t start_ms = (uint32_t)(hdr.start_us / 1000ULL);
+    auto ms_at = [&](uint32_t t_us) { return (uint32_t)((hdr.start_us + t_us) / 1000ULL); };
+
+    JamDetector det;
+    det.begin(start_ms, hdr.zero_counts);
+
+    Jam recorded, replayed;
+    bool treat = false;
+    bool segment_flagged = false;   // replay already fired in this forward segment
+    int32_t max_level = 0;
+    uint32_t last_ms = start_ms;
+
+    bool tick_pending = false;
+    motor_trace_entry_t tick;
+
+    // The device checks after a tick's samples, before anything else it logs
+    auto finish_tick = [&]() {
+        if (!tick_pending) return;
+        tick_pending = false;
+        if (!(tick.code & TRACE_F_CHECKED)) return;
+        const uint32_t now = ms_at(tick.t_us);
+        if (tick.code & TRACE_F_MOTION) det.motion(now);
+        if (segment_flagged) return;
+        const JamVerdict v = det.check(now, treat);
+        if (v != JAM_NONE) {
+            replayed.add(v, now - start_ms);
+            segment_flagged = true;
+        }
+    };
+
+    for (size_t off = 0; off < buf.size(); off += 8) {
+        const uint8_t* p = &buf[off];
+        if (p[0] == TRACE_SAMPLES) {
+            motor_trace_samples_t e;
+            memcpy(&e, p, sizeof(e));
+            uint64_t bits = 0;
+            for (int b = 0; b < 6; b++) bits |= (uint64_t)e.packed[b] << (8 * b);
+            for (uint8_t i = 0; i < e.count && i < 4; i++) {
+                det.step((int32_t)((bits >> (12 * i)) & 0x0FFF));
+                if (det.level_counts > max_level) max_level = det.level_counts;
+            }
+            continue;
+        }
+
+        finish_tick();
+        motor_trace_entry_t e;
+        memcpy(&e, p, sizeof(e));
+        const uint32_t now = ms_at(e.t_us);
+        last_ms = now;
+
+        if (e.kind == TRACE_TICK) {
+            tick = e;
+            tick_pending = true;
+            continue;
+        }
+        if (e.kind != TRACE_EVENT) continue;
+
+        switch (e.code) {
+        case TRACE_EV_JAM_NO_MOTION:
+            recorded.add(JAM_NO_MOTION, now - start_ms);
+            det.reversing(now);
+            break;
+        case TRACE_EV_JAM_FILTERED:
+            recorded.add(JAM_FILTERED_CURRENT, now - start_ms);
+            det.reversing(now);
+            break;
+        case TRACE_EV_REVERSE_END:
+            det.resume(now, hdr.zero_counts);
+            segment_flagged = false;
+            break;
+        case TRACE_EV_TREAT:
+            treat = true;
+            break;
+        default:
+            break;
+        }
+    }
+    finish_tick();
+
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    printf("%s,%u,%s,%u,%d,%u,%d,%s,%u,%d,%s,%u,%.3f,%.3f\n",
+           base, (unsigned)hdr.run_seq, reason_name(hdr.reason), (unsigned)hdr.truncated,
+           treat ? 1 : 0, (unsigned)(last_ms - start_ms),
+           recorded.count, verdict_name(recorded.first), (unsigned)recorded.first_ms,
+           replayed.count, verdict_name(replayed.first), (unsigned)replayed.first_ms,
+           counts_to_amps(max_level), counts_to_amps(det.max_slope_counts));
+
+    totals->runs++;
+    if (recorded.count && replayed.count) totals->both++;
+    else if (recorded.count) totals->recorded_only++;
+    else if (replayed.count) totals->replay_only++;
+    else totals->neither++;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace.trc>...\n", argv[0]);
+        return 2;
+    }
+
+    fprintf(stderr, "Detector: on=%.2fA off=%.2fA confirm=%lums noMotion=%lums startup=%lums rearm=%lums\n",
+            (double)JAM_FILTERED_THRESHOLD_AMPS, (double)JAM_FILTERED_RELEASE_AMPS,
+            (unsigned long)JAM_FILTERED_CONFIRM_MS, (unsigned long)JAM_NO_MOTION_TIMEOUT_MS,
+            (unsigned long)JAM_NO_MOTION_STARTUP_MS, (unsigned long)MOTOR_JAM_REARM_MS);
+
+    printf("file,run_seq,reason,truncated,treat,run_ms,"
+           "rec_jams,rec_first,rec_first_ms,replay_jams,replay_first,replay_first_ms,"
+           "max_level_a,max_slope_a\n");
+
+    Totals t;
+    for (int i = 1; i < argc; i++) {
+        if (!replay_file(argv[i], &t)) t.bad++;
+    }
+
+    fprintf(stderr, "%d runs (%d unreadable): jam in both %d, neither %d, replay only %d, recorded only %d\n",
+            t.runs, t.bad, t.both, t.neither, t.replay_only, t.recorded_only);
+    return 0;
+}